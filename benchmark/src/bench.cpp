@@ -0,0 +1,309 @@
+// Benchmark driver: loads a graph once and runs the OpenMP implementations
+// and the pthreads engine on the same sources, reporting per-trial times and
+// a statistical summary (mean, median, standard deviation, geometric mean and
+// GTEPS) per engine, optionally written to a JSON or CSV file.
+#include "bfs.h"
+#include "config.h"
+#include "generators.hpp"
+#include "graph.hpp"
+#include "sources.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <omp.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "cli_parser.h"
+}
+
+// The pthreads engine behind the BFS_Impl interface. The engine is a set of
+// globals, so only one instance can exist at a time.
+class Pthreads_BFS : public BFS_Impl {
+private:
+  mmio_csr_u32_f32_t view;
+
+public:
+  Pthreads_BFS(const CSR_local<uint32_t, float> *graph, bool parents,
+               bool reorder, bool pipeline)
+      : BFS_Impl(graph) {
+    // Same arrays, seen through the C interface of distributed_mmio
+    view.nrows = graph->nrows;
+    view.ncols = graph->ncols;
+    view.nnz = graph->nnz;
+    view.row_ptr = graph->row_ptr;
+    view.col_idx = graph->col_idx;
+    view.val = graph->val;
+    compute_parents = parents;
+    reorder_frontier = reorder;
+    pipeline_levels = pipeline;
+    initialize_bfs(&view);
+  }
+  ~Pthreads_BFS() { destroy_bfs(); }
+  void BFS(vertex source, uint32_t *result) override {
+    distances = result;
+    bfs(source);
+  }
+  bool check_result(vertex source, uint32_t *result) override {
+    return compute_parents ? check_parents(source, result)
+                           : check_distances(source, result);
+  }
+};
+
+struct Summary {
+  double mean, median, stddev, geomean, min, max;
+  double gteps; // Harmonic mean of the GTEPS of the trials (as in Graph500)
+};
+
+struct EngineResult {
+  std::string engine;
+  int threads;
+  std::vector<uint32_t> sources;
+  std::vector<uint64_t> edges;
+  std::vector<double> times;
+  Summary summary;
+};
+
+// Number of directed edges scanned by a BFS: the degrees of the reached
+// vertices (distances and parents are both UINT32_MAX for the others)
+static uint64_t traversed_edges(const CSR_local<uint32_t, float> *graph,
+                                const uint32_t *result) {
+  uint64_t edges = 0;
+  for (uint32_t i = 0; i < graph->nrows; i++) {
+    if (result[i] != UINT32_MAX) {
+      edges += graph->row_ptr[i + 1] - graph->row_ptr[i];
+    }
+  }
+  return edges;
+}
+
+static Summary summarize(const std::vector<double> &times,
+                         const std::vector<uint64_t> &edges) {
+  Summary s;
+  size_t n = times.size();
+  std::vector<double> sorted(times);
+  std::sort(sorted.begin(), sorted.end());
+  s.min = sorted.front();
+  s.max = sorted.back();
+  s.median = n % 2 == 1 ? sorted[n / 2]
+                        : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+  double sum = 0, log_sum = 0, inverse_teps = 0;
+  for (size_t i = 0; i < n; i++) {
+    sum += times[i];
+    log_sum += std::log(times[i]);
+    inverse_teps += times[i] / edges[i];
+  }
+  s.mean = sum / n;
+  s.geomean = std::exp(log_sum / n);
+  double squares = 0;
+  for (double t : times) {
+    squares += (t - s.mean) * (t - s.mean);
+  }
+  // Sample standard deviation, as statistics.stdev in collect_data.py
+  s.stddev = n > 1 ? std::sqrt(squares / (n - 1)) : 0;
+  s.gteps = n / inverse_teps * 1e-9;
+  return s;
+}
+
+static BFS_Impl *create_engine(const std::string &name,
+                               const CSR_local<uint32_t, float> *graph,
+                               bool reorder, bool pipeline) {
+  if (name == "reference") {
+    return new Reference(graph);
+  } else if (name == "merged_csr_distances") {
+    return new MergedCSR_Distances(graph);
+  } else if (name == "merged_csr_parents") {
+    return new MergedCSR_Parents(graph);
+  } else if (name == "pthreads") {
+    return new Pthreads_BFS(graph, false, reorder, pipeline);
+  } else if (name == "pthreads_parents") {
+    return new Pthreads_BFS(graph, true, reorder, false);
+  }
+  return nullptr;
+}
+
+static void write_json(FILE *f, const char *name,
+                       const CSR_local<uint32_t, float> *graph, int warmup,
+                       const std::vector<EngineResult> &results) {
+  fprintf(f, "{\n  \"graph\": \"%s\",\n  \"vertices\": %u,\n  \"edges\": %u,\n",
+          name, graph->nrows, graph->nnz);
+  fprintf(f, "  \"warmup\": %d,\n  \"engines\": [", warmup);
+  for (size_t e = 0; e < results.size(); e++) {
+    const EngineResult &r = results[e];
+    fprintf(f, "%s\n    {\"engine\": \"%s\", \"threads\": %d, \"trials\": [",
+            e == 0 ? "" : ",", r.engine.c_str(), r.threads);
+    for (size_t i = 0; i < r.times.size(); i++) {
+      fprintf(f, "%s{\"source\": %u, \"edges\": %lu, \"time\": %.6f}",
+              i == 0 ? "" : ", ", r.sources[i], r.edges[i], r.times[i]);
+    }
+    const Summary &s = r.summary;
+    fprintf(f,
+            "],\n     \"mean\": %.6f, \"median\": %.6f, \"stddev\": %.6f, "
+            "\"geomean\": %.6f, \"min\": %.6f, \"max\": %.6f, \"gteps\": %.6f}",
+            s.mean, s.median, s.stddev, s.geomean, s.min, s.max, s.gteps);
+  }
+  fprintf(f, "\n  ]\n}\n");
+}
+
+static void write_csv(FILE *f, const char *name,
+                      const std::vector<EngineResult> &results) {
+  fprintf(f, "graph,engine,threads,trials,mean,median,stddev,geomean,min,max,"
+             "gteps\n");
+  for (const EngineResult &r : results) {
+    const Summary &s = r.summary;
+    // Quoted, since generator specs contain commas
+    fprintf(f, "\"%s\",%s,%d,%zu,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n",
+            name, r.engine.c_str(), r.threads, r.times.size(), s.mean, s.median,
+            s.stddev, s.geomean, s.min, s.max, s.gteps);
+  }
+}
+
+int main(int argc, char **argv) {
+  char *filename = nullptr;
+  char *generator = nullptr;
+  char *engines = nullptr;
+  char *output = nullptr;
+  int trials = 10;
+  int warmup = 2;
+  int source = -1;
+  bool check = false;
+  bool reorder = false;
+  bool pipeline = false;
+  const CliOption options[] = {
+      {'f', "file", "Load graph from file", ARG_TYPE_STRING, &filename, false},
+      {'G', "generate",
+       "Generate the graph instead of loading it (e.g. kron:scale=20,ef=16, "
+       "see the README for the generators)",
+       ARG_TYPE_STRING, &generator, false},
+      {'e', "engines",
+       "Comma-separated engines: reference, merged_csr_distances, "
+       "merged_csr_parents, pthreads, pthreads_parents (reference, "
+       "merged_csr_distances and pthreads by default)",
+       ARG_TYPE_STRING, &engines, false},
+      {'n', "trials", "Number of timed trials per engine (10 by default)",
+       ARG_TYPE_INT, &trials, false},
+      {'w', "warmup", "Untimed BFSs before the trials (2 by default)",
+       ARG_TYPE_INT, &warmup, false},
+      {'s', "source", "ID of source vertex", ARG_TYPE_INT, &source, false},
+      {'o', "output", "Write the results to a CSV file (JSON if it ends in .json)",
+       ARG_TYPE_STRING, &output, false},
+      {'c', "check", "Checks the result of every trial", ARG_TYPE_BOOL, &check,
+       false},
+      {'r', "reorder", "Locality-sorted frontiers in the pthreads engine",
+       ARG_TYPE_BOOL, &reorder, false},
+      {'l', "pipeline", "Pipelined levels in the pthreads engine",
+       ARG_TYPE_BOOL, &pipeline, false}};
+  int num_options = sizeof(options) / sizeof(options[0]);
+  int parse_result = cli_parse(argc, argv, options, num_options,
+                               "Runs the BFS engines on the same sources.");
+  if (parse_result != 0) {
+    free(filename);
+    free(generator);
+    return (parse_result == 1) ? 0 : 1;
+  }
+  if ((filename == nullptr) == (generator == nullptr)) {
+    printf("Exactly one of --file and --generate is needed\n");
+    return 1;
+  }
+  if (trials < 1 || warmup < 0) {
+    printf("At least one trial is needed and the warmup must be non-negative\n");
+    return 1;
+  }
+
+  std::vector<std::string> engine_names;
+  std::stringstream engine_list(
+      engines != nullptr ? engines
+                         : "reference,merged_csr_distances,pthreads");
+  std::string name;
+  while (std::getline(engine_list, name, ',')) {
+    engine_names.push_back(name);
+  }
+
+  CSR_local<uint32_t, float> *graph;
+  if (generator != nullptr) {
+    graph = generate_graph(generator);
+    if (graph == nullptr) {
+      return 1;
+    }
+  } else {
+    graph = Distr_MMIO_CSR_local_read<uint32_t, float>(filename, false);
+    if (graph == nullptr) {
+      printf("Failed to import graph from file [%s]\n", filename);
+      return 1;
+    }
+  }
+  // Results are labelled with the file name or the generator spec
+  const char *graph_name = generator != nullptr ? generator : filename;
+  std::vector<uint32_t> sources;
+  if (source >= 0) {
+    sources.insert(sources.end(), trials, source);
+  } else {
+    generate_random_sources(graph, trials, sources);
+  }
+
+  uint32_t *result = new uint32_t[graph->nrows];
+  std::vector<EngineResult> results;
+  for (const std::string &engine : engine_names) {
+    BFS_Impl *impl = create_engine(engine, graph, reorder, pipeline);
+    if (impl == nullptr) {
+      printf("Unknown engine [%s]\n", engine.c_str());
+      continue;
+    }
+    EngineResult r;
+    r.engine = engine;
+    r.threads = engine.compare(0, 8, "pthreads") == 0 ? MAX_THREADS
+                : engine == "reference"               ? 1
+                                                      : omp_get_max_threads();
+    for (int i = 0; i < warmup; i++) {
+      impl->BFS(sources[i % trials], result);
+    }
+    for (int i = 0; i < trials; i++) {
+      double t_start = omp_get_wtime();
+      impl->BFS(sources[i], result);
+      double elapsed = omp_get_wtime() - t_start;
+      uint64_t edges = traversed_edges(graph, result);
+      printf("run_id=%d,engine=%s,threads=%d,source=%u,edges=%lu,%.4f\n", i,
+             engine.c_str(), r.threads, sources[i], edges, elapsed);
+      if (check && !impl->check_result(sources[i], result)) {
+        printf("Check failed for source %u\n", sources[i]);
+      }
+      r.sources.push_back(sources[i]);
+      r.edges.push_back(edges);
+      r.times.push_back(elapsed);
+    }
+    delete impl;
+    r.summary = summarize(r.times, r.edges);
+    const Summary &s = r.summary;
+    printf("engine=%s,threads=%d,trials=%d,mean=%.4f,median=%.4f,"
+           "stddev=%.4f,geomean=%.4f,min=%.4f,max=%.4f,gteps=%.4f\n",
+           engine.c_str(), r.threads, trials, s.mean, s.median, s.stddev,
+           s.geomean, s.min, s.max, s.gteps);
+    results.push_back(r);
+  }
+
+  if (output != nullptr) {
+    FILE *f = fopen(output, "w");
+    if (f == nullptr) {
+      printf("Failed to open output file [%s]\n", output);
+    } else {
+      size_t length = strlen(output);
+      if (length >= 5 && strcmp(output + length - 5, ".json") == 0) {
+        write_json(f, graph_name, graph, warmup, results);
+      } else {
+        write_csv(f, graph_name, results);
+      }
+      fclose(f);
+    }
+  }
+  delete[] result;
+  delete graph;
+  free(filename);
+  free(generator);
+  free(engines);
+  free(output);
+  return 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "graph.hpp"
+#include <string>
+
+// Embeddable interface over the BFS implementations, for services that link
+// the library instead of running bin/bfs. `make lib` builds bin/libbfs.a and
+// bin/libbfs.so from every source but main.cpp; programs linking the static
+// one also need -ldistributed_mmio -fopenmp. A query is BFS_Impl::BFS, which
+// writes one entry per vertex into a caller-provided buffer, and results can
+// be validated with BFS_Impl::check_result. Queries on the same BFS_Impl must
+// not run concurrently; they use the threads of the OpenMP runtime.
+
+// Loads a graph from a file read by distributed_mmio or from a generator spec
+// (see generators.hpp). Returns nullptr, after printing why, on failure.
+CSR_local<uint32_t, float> *load_graph(const std::string &dataset);
+
+// Builds the implementation named `implementation` ("merged_csr_distances",
+// "merged_csr_parents" or "reference") over `graph`, which must outlive it:
+// the merged CSR implementations only read it to validate results and for
+// its number of vertices. Returns nullptr, after printing why, if the name is
+// unknown.
+BFS_Impl *prepare_bfs(const CSR_local<uint32_t, float> *graph,
+                      const std::string &implementation);
+
+// Runs a BFS from `source`, writing to `result` the distances (the parents
+// for merged_csr_parents) of all vertices. Returns false, after printing why,
+// if the source is out of range.
+bool query_bfs(BFS_Impl *bfs, vertex source, uint32_t *result);
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Energy readings from the Linux powercap (RAPL) interface: the sum of the
+// increments of the energy_uj counters of the package and DRAM zones under a
+// configurable root (/sys/class/powercap, or a directory with fake zones).
+// Counters that wrap around are corrected with max_energy_range_uj.
+class EnergyMeter {
+private:
+  struct Zone {
+    std::string energy_file;
+    uint64_t max_range;
+    uint64_t start;
+  };
+  std::vector<Zone> zones;
+
+public:
+  // Returns nullptr, after printing why, if no zone under `root` can be read
+  static EnergyMeter *open(const std::string &root);
+  void start();
+  // Joules consumed since the last start()
+  double stop();
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include "mmio.h"
+#include <cstdint>
+
+// Synthetic graphs generated in parallel directly in CSR form. A spec is
+// `name:key=value,...` with name kron (Graph500 Kronecker, scale and ef),
+// uniform (uniform random, scale and ef), grid (2D or 3D lattice with x, y, z
+// and the probability `drop` of removing each edge) or rgg (random geometric
+// graph of 2^scale points within radius r), plus an optional seed. The graphs
+// are undirected, without self-loops or duplicate edges, and identical to the
+// ones the pthreads engine generates from the same spec (see generators.h
+// there for the defaults).
+
+// Whether `dataset` names a generator rather than a file
+bool is_generator_spec(const char *dataset);
+
+// Returns nullptr, after printing why, if the spec is malformed or the graph
+// has more than 2^32 - 1 edges
+CSR_local<uint32_t, float> *generate_graph(const char *spec);
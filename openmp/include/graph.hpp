@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <vector>
+#include "memory_report.hpp"
 #include "mmio.h"
 
 typedef uint32_t vertex;
@@ -31,6 +32,8 @@ public:
   virtual bool check_result(vertex source, uint32_t *distances) = 0;
   bool check_distances(vertex source, const uint32_t *distances) const;
   bool check_parents(vertex source, const uint32_t *parents) const;
+  // Structures built from the graph, beside the CSR itself
+  virtual std::vector<MemoryUsage> memory_usage() const { return {}; }
   virtual ~BFS_Impl() = default;
 
 protected:
@@ -53,6 +56,7 @@ public:
   ~MergedCSR_Distances();
   void BFS(vertex source, uint32_t *distances) override;
   bool check_result(vertex source, uint32_t *distances) override;
+  std::vector<MemoryUsage> memory_usage() const override;
 };
 
 // BFS implementation using the MergedCSR graph representation (returning
@@ -71,6 +75,30 @@ public:
   ~MergedCSR_Parents();
   void BFS(vertex source, uint32_t *distances) override;
   bool check_result(vertex source, uint32_t *distances) override;
+  std::vector<MemoryUsage> memory_usage() const override;
+};
+
+// Connected components (Afforest) using the MergedCSR graph representation.
+// The distance slot of each vertex holds the merged offset of the
+// representative of its component. Assumes a symmetric graph.
+class MergedCSR_Components {
+private:
+  const CSR_local<uint32_t, float> *graph;
+  edge *merged_rowptr;
+  edge *merged_csr;
+
+  void link(edge u, edge v);
+  void compress();
+  edge sample_frequent_component() const;
+  void create_merged_csr();
+
+public:
+  MergedCSR_Components(const CSR_local<uint32_t, float> *graph);
+  ~MergedCSR_Components();
+  // Writes the ID of the representative of each vertex's component and
+  // returns the number of components
+  uint32_t connected_components(uint32_t *components);
+  bool check_result(const uint32_t *components, uint32_t num_components) const;
 };
 
 // Single-threaded BFS implementation using classic CSR
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Memory footprint of the prepared structures, computed from their allocation
+// sizes (without allocator overhead) and printed as `memory_structure=` lines
+// with bytes and bytes per (directed) edge, like -M of the Pthreads
+// implementation. The per-level frontiers are allocated and freed by each
+// BFS, so they only show up in the peak resident set size.
+struct MemoryUsage {
+  std::string name;
+  uint64_t bytes;
+};
+
+// Prints the items (skipping the empty ones), their total, the current and
+// the peak resident set size of the process
+void print_memory_report(const std::vector<MemoryUsage> &items,
+                         uint64_t edges);
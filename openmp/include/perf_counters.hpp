@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Hardware counters of each OpenMP thread, read with perf_event_open. Each
+// thread opens its own counters the first time it enters a phase and
+// accumulates the counts between begin() and end(); events missing on the
+// CPU are printed as n/a.
+enum PerfEvent {
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_LLC_MISSES,
+  PERF_DTLB_MISSES,
+  PERF_STALLED_CYCLES,
+  PERF_NUM_EVENTS
+};
+
+enum PerfPhase { PERF_BUILD, PERF_TRAVERSAL, PERF_FINALIZE, PERF_NUM_PHASES };
+
+class PerfCounters {
+private:
+  struct Reading {
+    uint64_t value;
+    uint64_t enabled;
+    uint64_t running;
+  };
+
+  struct ThreadCounters {
+    int fds[PERF_NUM_EVENTS];
+    bool opened = false;
+    bool active[PERF_NUM_PHASES] = {};
+    Reading start[PERF_NUM_EVENTS];
+    double counts[PERF_NUM_PHASES][PERF_NUM_EVENTS] = {};
+  };
+
+  std::vector<ThreadCounters> threads;
+  bool finalizing = false;
+
+  static int open_counters(ThreadCounters &t);
+  static void read_counters(const ThreadCounters &t, Reading *readings);
+  void print_counts(int run_id, PerfPhase phase, const char *thread,
+                    const double *counts, const bool *available) const;
+
+public:
+  // Returns nullptr, after printing why, if no counter can be opened
+  static PerfCounters *open();
+  ~PerfCounters();
+  // Called by every thread that takes part in the phase
+  void begin(PerfPhase phase);
+  void end(PerfPhase phase);
+  // Phases of a BFS, on all threads of a parallel region: the traversal is
+  // started before the BFS, switched to the write-back of the result by the
+  // implementation (if it has one) and stopped after the BFS
+  void start_traversal();
+  void start_finalize();
+  void stop();
+  void reset();
+  // One line per thread that took part in the phase, and one with the total
+  void print(int run_id, PerfPhase phase) const;
+};
+
+// Set by main when the counters are enabled (PERF_COUNTERS=1), so that the
+// implementations can mark the end of the traversal
+extern PerfCounters *perf_counters;
+
+// Ends the traversal and begins the write-back of the result on all threads
+void perf_counters_finalize();
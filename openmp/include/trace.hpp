@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Timeline of the OpenMP regions of a BFS, written as Chrome trace JSON (to
+// be opened in Perfetto or chrome://tracing). Events are recorded by the
+// thread that runs the BFS, between parallel regions, into a ring buffer of
+// kBufferEvents entries whose oldest events are overwritten; the work of the
+// single OpenMP threads inside a region is not recorded.
+enum TraceType { TRACE_TOP_DOWN, TRACE_FINALIZE, TRACE_RUN, TRACE_NUM_TYPES };
+
+class Tracer {
+private:
+  struct Event {
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint32_t level;
+    uint32_t arg; // Frontier vertices, or the run
+    TraceType type;
+  };
+
+  std::vector<Event> events;
+  uint64_t count = 0;
+  uint64_t epoch;
+
+public:
+  static const uint64_t kBufferEvents = 1 << 18;
+
+  Tracer();
+  // Monotonic clock in nanoseconds
+  static uint64_t now();
+  // Records an event from `start_ns` to now
+  void record(TraceType type, uint32_t level, uint32_t arg, uint64_t start_ns);
+  // Returns false, after printing why, if `path` cannot be written
+  bool write(const std::string &path) const;
+};
+
+// Set by main when the timeline is enabled (TRACE_FILE=<path>)
+extern Tracer *tracer;
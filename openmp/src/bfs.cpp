@@ -1,78 +1,149 @@
 #include "graph.hpp"
 #include <iostream>
+#include <string>
+#include <vector>
 
-bool BFS_Impl::check_distances(vertex source,
-                               const uint32_t *distances) const {
-  Reference ref_input(graph);
-  uint32_t *ref_distances = new uint32_t[graph->nrows];
-  ref_input.BFS(source, ref_distances);
-  bool is_correct = true;
-  for (int64_t i = 0; i < graph->nrows; i++) {
-    if (distances[i] != ref_distances[i]) {
-      std::cout << "Incorrect value for vertex " << i
-                << ", expected distance " << std::to_string(ref_distances[i]) <<
-                       ", but got " << std::to_string(distances[i]) + "\n";
-      is_correct = false;
-    }
+// Results are validated in parallel with the Graph500 checks: the source is
+// the only vertex at depth 0, the BFS tree is rooted at the source (depths of
+// the tree are computed by pointer jumping, so cycles are detected), every
+// edge connects vertices at most one level apart, no edge leaves the reached
+// component, and every reached vertex is joined to its parent (or, for
+// distances, to a neighbor one level closer). Every check is local to a
+// vertex and its edges, so no reference BFS is needed.
+
+static const unsigned kMaxReportedErrors = 10;
+
+static void report(unsigned &errors, const std::string &message) {
+  unsigned error;
+#pragma omp atomic capture
+  error = errors++;
+  if (error < kMaxReportedErrors) {
+#pragma omp critical(validation_report)
+    std::cout << "Error: " << message << std::endl;
   }
-  delete[] ref_distances;
-  return is_correct;
 }
 
-bool BFS_Impl::check_parents(vertex source, const uint32_t *parents) const {
-  bool correct = true;
-  std::vector<vertex> depth(graph->nrows, -1);
-  std::vector<vertex> to_visit;
-  depth[source] = 0;
-  to_visit.push_back(source);
-  to_visit.reserve(graph->nrows);
-  // Run BFS to compute depth of each vertex
-  for (auto it = to_visit.begin(); it != to_visit.end(); it++) {
-    vertex i = *it;
-    for (int64_t v = graph->row_ptr[i]; v < graph->row_ptr[i + 1]; v++) {
-      if (depth[graph->col_idx[v]] == -1.0) {
-        depth[graph->col_idx[v]] = depth[i] + 1;
-        to_visit.push_back(graph->col_idx[v]);
-      }
+// Edge checks for the depths `depth` (distances, or depths of the BFS tree in
+// `parents` if not null); returns the number of errors
+static unsigned check_edges(const CSR_local<uint32_t, float> *graph,
+                            vertex source, const uint32_t *depth,
+                            const uint32_t *parents) {
+  unsigned errors = 0;
+  int64_t n = graph->nrows;
+#pragma omp parallel for schedule(dynamic, 1024)
+  for (int64_t u = 0; u < n; u++) {
+    uint32_t depth_u = depth[u];
+    if ((u == source) != (depth_u == 0)) {
+      report(errors, "Vertex " + std::to_string(u) + " has depth " +
+                         std::to_string(depth_u) + " (source " +
+                         std::to_string(source) + ")");
     }
-  }
-  for (int64_t i = 0; i < graph->nrows; i++) {
-    // Check if vertex is part of the BFS tree
-    if (depth[i] != -1.0 && parents[i] != -1.0) {
-      // Check if parent is correct
-      if (i == source) {
-        if (!((parents[i] == i) && (depth[i] == 0))) {
-          std::cout << "Source wrong";
-          correct = false;
+    bool found_predecessor = false;
+    for (edge i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+      vertex v = graph->col_idx[i];
+      uint32_t depth_v = depth[v];
+      if (depth_u == UINT32_MAX) {
+        if (depth_v != UINT32_MAX) {
+          report(errors, "Vertex " + std::to_string(u) +
+                             " is unreached, but has a reached neighbor " +
+                             std::to_string(v));
         }
         continue;
       }
-      bool parent_found = false;
-      for (int64_t j = graph->row_ptr[i]; j < graph->row_ptr[i + 1]; j++) {
-        if (graph->col_idx[j] == parents[i]) {
-          vertex parent = graph->col_idx[j];
-          // Check if parent has correct depth
-          if (depth[parent] != depth[i] - 1) {
-            std::cout << "Wrong depth of child " + std::to_string(i) +
-                             " (parent " + std::to_string(parent) +
-                             " with depth " + std::to_string(depth[parent])
-                      << ")" << std::endl;
-            correct = false;
-          }
-          parent_found = true;
-          break;
-        }
+      // Also catches a reached vertex with an unreached neighbor
+      if (depth_v > depth_u + 1) {
+        report(errors, "Edge {" + std::to_string(u) + ", " +
+                           std::to_string(v) + "} connects depths " +
+                           std::to_string(depth_u) + " and " +
+                           std::to_string(depth_v));
+      }
+      if (parents != nullptr ? v == parents[u]
+                             : depth_u > 0 && depth_v == depth_u - 1) {
+        found_predecessor = true;
+      }
+    }
+    if (depth_u != UINT32_MAX && u != source && !found_predecessor) {
+      report(errors, parents != nullptr
+                         ? "Couldn't find edge from " +
+                               std::to_string(parents[u]) + " to " +
+                               std::to_string(u)
+                         : "Vertex " + std::to_string(u) +
+                               " has no neighbor at depth " +
+                               std::to_string(depth_u - 1));
+    }
+  }
+  return errors;
+}
+
+bool BFS_Impl::check_distances(vertex source,
+                               const uint32_t *distances) const {
+  return check_edges(graph, source, distances, nullptr) == 0;
+}
+
+bool BFS_Impl::check_parents(vertex source, const uint32_t *parents) const {
+  int64_t n = graph->nrows;
+  unsigned errors = 0;
+  // After round k, ancestor[v] is the 2^k-th ancestor of v (or the source)
+  // and hops[v] its distance from v
+  std::vector<uint32_t> ancestor(n), hops(n), next_ancestor(n), next_hops(n);
+#pragma omp parallel for schedule(static)
+  for (int64_t v = 0; v < n; v++) {
+    uint32_t parent = parents[v];
+    ancestor[v] = UINT32_MAX;
+    hops[v] = UINT32_MAX;
+    if (v == source) {
+      if (parent != source) {
+        report(errors, "Source wrong (parent " + std::to_string(parent) + ")");
       }
-      if (!parent_found) {
-        std::cout << "Couldn't find edge from " << parents[i] << " to "
-                  << std::to_string(i) << std::endl;
-        correct = false;
+      ancestor[v] = source;
+      hops[v] = 0;
+    } else if (parent == UINT32_MAX) {
+      continue;
+    } else if (parent >= n || parents[parent] == UINT32_MAX) {
+      report(errors, "Parent " + std::to_string(parent) + " of vertex " +
+                         std::to_string(v) + " is not in the BFS tree");
+    } else {
+      ancestor[v] = parent;
+      hops[v] = 1;
+    }
+  }
+  if (errors > 0) {
+    return false;
+  }
+
+  // A path of length L reaches the source in ceil(log2(L)) rounds, vertices
+  // on a cycle never do
+  int max_rounds = 1;
+  while ((1LL << max_rounds) < n) {
+    max_rounds++;
+  }
+  bool changed = true;
+  for (int round = 0; round <= max_rounds && changed; round++) {
+    changed = false;
+#pragma omp parallel for schedule(static) reduction(|| : changed)
+    for (int64_t v = 0; v < n; v++) {
+      uint32_t a = ancestor[v];
+      if (a == UINT32_MAX || a == source) {
+        next_ancestor[v] = a;
+        next_hops[v] = hops[v];
+      } else {
+        next_ancestor[v] = ancestor[a];
+        next_hops[v] = hops[v] + hops[a];
+        changed = true;
       }
-      // Check if parent = -1 and parent = -1
-    } else if (depth[i] != parents[i]) {
-      std::cout << "Reachability mismatch" << std::endl;
-      correct = false;
     }
+    ancestor.swap(next_ancestor);
+    hops.swap(next_hops);
   }
-  return correct;
-}
\ No newline at end of file
+#pragma omp parallel for schedule(static)
+  for (int64_t v = 0; v < n; v++) {
+    if (ancestor[v] != UINT32_MAX && ancestor[v] != source) {
+      report(errors, "Vertex " + std::to_string(v) +
+                         " does not reach the source (cycle in the BFS tree)");
+    }
+  }
+  if (errors > 0) {
+    return false;
+  }
+  return check_edges(graph, source, hops.data(), parents) == 0;
+}
@@ -0,0 +1,38 @@
+#include "bfs_api.hpp"
+#include "generators.hpp"
+#include <cstdio>
+
+CSR_local<uint32_t, float> *load_graph(const std::string &dataset) {
+  if (is_generator_spec(dataset.c_str())) {
+    return generate_graph(dataset.c_str());
+  }
+  CSR_local<uint32_t, float> *graph =
+      Distr_MMIO_CSR_local_read<uint32_t, float>(dataset.c_str(), false);
+  if (graph == nullptr) {
+    printf("Failed to import graph from file [%s]\n", dataset.c_str());
+  }
+  return graph;
+}
+
+BFS_Impl *prepare_bfs(const CSR_local<uint32_t, float> *graph,
+                      const std::string &implementation) {
+  if (implementation == "merged_csr_distances") {
+    return new MergedCSR_Distances(graph);
+  } else if (implementation == "merged_csr_parents") {
+    return new MergedCSR_Parents(graph);
+  } else if (implementation == "reference") {
+    return new Reference(graph);
+  }
+  printf("Unknown implementation [%s]\n", implementation.c_str());
+  return nullptr;
+}
+
+bool query_bfs(BFS_Impl *bfs, vertex source, uint32_t *result) {
+  if (source >= bfs->graph->nrows) {
+    printf("Source vertex %u is out of bounds (num_vertices=%u)\n", source,
+           bfs->graph->nrows);
+    return false;
+  }
+  bfs->BFS(source, result);
+  return true;
+}
@@ -0,0 +1,78 @@
+#include "energy.hpp"
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+
+static bool read_value(const std::string &path, uint64_t &value) {
+  std::ifstream file(path);
+  return static_cast<bool>(file >> value);
+}
+
+// Recent Intel CPUs expose the package counter a second time through the
+// MMIO interface (intel-rapl-mmio:0, also named package-0): only the MSR zones
+// are summed, or the package energy would be counted twice
+static const std::string RAPL_MMIO_ZONE = "intel-rapl-mmio";
+
+static bool is_measured_zone(const std::string &root, const std::string &zone) {
+  if (zone.compare(0, RAPL_MMIO_ZONE.size(), RAPL_MMIO_ZONE) == 0) {
+    return false;
+  }
+  std::ifstream file(root + "/" + zone + "/name");
+  std::string name;
+  if (!(file >> name)) {
+    return false;
+  }
+  return name.compare(0, 7, "package") == 0 || name.compare(0, 4, "dram") == 0;
+}
+
+EnergyMeter *EnergyMeter::open(const std::string &root) {
+  DIR *dir = opendir(root.c_str());
+  if (dir == nullptr) {
+    printf("Cannot open powercap root [%s], energy is not measured\n",
+           root.c_str());
+    return nullptr;
+  }
+  EnergyMeter *meter = new EnergyMeter();
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    std::string zone = root + "/" + entry->d_name;
+    Zone z;
+    z.energy_file = zone + "/energy_uj";
+    // Reading energy_uj needs root on recent kernels
+    if (entry->d_name[0] == '.' || !is_measured_zone(root, entry->d_name) ||
+        !read_value(zone + "/max_energy_range_uj", z.max_range) ||
+        !read_value(z.energy_file, z.start)) {
+      continue;
+    }
+    meter->zones.push_back(z);
+  }
+  closedir(dir);
+  if (meter->zones.empty()) {
+    printf("No readable package or dram zone under [%s], energy is not "
+           "measured\n",
+           root.c_str());
+    delete meter;
+    return nullptr;
+  }
+  return meter;
+}
+
+void EnergyMeter::start() {
+  for (Zone &z : zones) {
+    if (!read_value(z.energy_file, z.start)) {
+      z.start = 0;
+    }
+  }
+}
+
+double EnergyMeter::stop() {
+  uint64_t total = 0;
+  for (const Zone &z : zones) {
+    uint64_t end;
+    if (!read_value(z.energy_file, end)) {
+      continue;
+    }
+    total += end >= z.start ? end - z.start : z.max_range - z.start + end;
+  }
+  return total * 1e-6;
+}
@@ -0,0 +1,388 @@
+#include "generators.hpp"
+#include "sources.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <omp.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Graph500 Kronecker initiator probabilities (D = 1 - A - B - C)
+static const double kKronA = 0.57;
+static const double kKronB = 0.19;
+static const double kKronC = 0.19;
+
+// Marks an edge slot that holds no edge (e.g. a dropped grid edge)
+static const uint32_t kNoVertex = UINT32_MAX;
+
+struct GraphSpec {
+  std::string name;
+  uint64_t scale = 16, ef = 16, x = 1024, y = 1024, z = 1, seed = kRandSeed;
+  double drop = 0;
+  double radius = 0; // 0 selects the default radius
+};
+
+// The random streams match generators.c in the pthreads engine, so that both
+// engines generate the same graph from a spec
+
+// SplitMix64 finalizer
+static inline uint64_t mix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// Independent stream of random numbers for each edge (or vertex) index
+static inline uint64_t stream_start(uint64_t seed, uint64_t index) {
+  return mix64(seed ^ mix64(index));
+}
+
+static inline uint64_t next_random(uint64_t &state) {
+  state += 0x9e3779b97f4a7c15ULL;
+  return mix64(state);
+}
+
+// Uniform double in [0, 1)
+static inline double unit(uint64_t r) {
+  return (r >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static bool is_generator_name(const std::string &name) {
+  return name == "kron" || name == "uniform" || name == "grid" ||
+         name == "rgg";
+}
+
+bool is_generator_spec(const char *dataset) {
+  const char *colon = strchr(dataset, ':');
+  return is_generator_name(colon != nullptr ? std::string(dataset, colon)
+                                            : std::string(dataset));
+}
+
+static bool parse_value(const std::string &key, const std::string &value,
+                        GraphSpec &spec) {
+  char *end;
+  if (value.empty()) {
+    return false;
+  }
+  if (key == "drop" || key == "r") {
+    (key == "drop" ? spec.drop : spec.radius) = strtod(value.c_str(), &end);
+    return *end == '\0';
+  }
+  uint64_t *dest = key == "scale"  ? &spec.scale
+                   : key == "ef"   ? &spec.ef
+                   : key == "x"    ? &spec.x
+                   : key == "y"    ? &spec.y
+                   : key == "z"    ? &spec.z
+                   : key == "seed" ? &spec.seed
+                                   : nullptr;
+  if (dest == nullptr || value[0] == '-') {
+    return false;
+  }
+  *dest = strtoull(value.c_str(), &end, 10);
+  return *end == '\0';
+}
+
+static bool parse_spec(const char *text, GraphSpec &spec) {
+  const char *colon = strchr(text, ':');
+  spec.name = colon != nullptr ? std::string(text, colon) : std::string(text);
+  if (!is_generator_name(spec.name)) {
+    printf("Unknown graph generator [%s], expected kron, uniform, grid or "
+           "rgg\n",
+           spec.name.c_str());
+    return false;
+  }
+  if (colon != nullptr) {
+    std::stringstream params(colon + 1);
+    std::string param;
+    while (std::getline(params, param, ',')) {
+      size_t equals = param.find('=');
+      if (equals == std::string::npos ||
+          !parse_value(param.substr(0, equals), param.substr(equals + 1),
+                       spec)) {
+        printf("Invalid generator parameter [%s] in [%s]\n",
+               param.substr(0, equals).c_str(), text);
+        return false;
+      }
+    }
+  }
+  if (spec.name == "grid") {
+    if (spec.x == 0 || spec.y == 0 || spec.z == 0 ||
+        spec.x * spec.y * spec.z >= kNoVertex) {
+      printf("The grid needs between 1 and 2^32 - 1 vertices\n");
+      return false;
+    }
+  } else if (spec.scale == 0 || spec.scale > 31) {
+    printf("The scale must be between 1 and 31\n");
+    return false;
+  }
+  if (spec.drop < 0 || spec.drop > 1 || spec.radius < 0) {
+    printf("The drop probability must be in [0, 1] and the radius "
+           "non-negative\n");
+    return false;
+  }
+  return true;
+}
+
+class Generator {
+private:
+  GraphSpec spec;
+  uint64_t n;
+  std::vector<uint32_t> src, dst;
+
+  // Bijection of [0, 2^scale) that spreads the high-degree vertices of the
+  // Kronecker graph, which would otherwise all have small IDs
+  uint32_t scramble(uint64_t v) const {
+    uint64_t mask = n - 1;
+    v = (v * (mix64(spec.seed + 1) | 1)) & mask;
+    v ^= v >> (spec.scale / 2 + 1);
+    v = (v * (mix64(spec.seed + 2) | 1) + spec.seed) & mask;
+    return (uint32_t)v;
+  }
+
+  void kron_edges() {
+    int64_t m = src.size();
+#pragma omp parallel for schedule(static)
+    for (int64_t e = 0; e < m; e++) {
+      uint64_t state = stream_start(spec.seed, e);
+      uint64_t u = 0, v = 0;
+      for (uint64_t level = 0; level < spec.scale; level++) {
+        double r = unit(next_random(state));
+        // Quadrants A, B, C and D are (0, 0), (0, 1), (1, 0) and (1, 1)
+        uint64_t bit_u = r >= kKronA + kKronB;
+        uint64_t bit_v = (r >= kKronA && r < kKronA + kKronB) ||
+                         r >= kKronA + kKronB + kKronC;
+        u = (u << 1) | bit_u;
+        v = (v << 1) | bit_v;
+      }
+      src[e] = scramble(u);
+      dst[e] = scramble(v);
+    }
+  }
+
+  void uniform_edges() {
+    int64_t m = src.size();
+#pragma omp parallel for schedule(static)
+    for (int64_t e = 0; e < m; e++) {
+      uint64_t state = stream_start(spec.seed, e);
+      src[e] = (uint32_t)(next_random(state) % n);
+      dst[e] = (uint32_t)(next_random(state) % n);
+    }
+  }
+
+  // Slot 3v + d holds the edge from v to its successor along dimension d
+  void grid_edges() {
+    int64_t m = src.size();
+    uint64_t x = spec.x, y = spec.y, z = spec.z;
+#pragma omp parallel for schedule(static)
+    for (int64_t slot = 0; slot < m; slot++) {
+      uint64_t v = slot / 3;
+      uint64_t i = v % x, j = v / x % y, k = v / (x * y);
+      uint64_t neighbor;
+      switch (slot % 3) {
+      case 0:
+        neighbor = i + 1 < x ? v + 1 : kNoVertex;
+        break;
+      case 1:
+        neighbor = j + 1 < y ? v + x : kNoVertex;
+        break;
+      default:
+        neighbor = k + 1 < z ? v + x * y : kNoVertex;
+        break;
+      }
+      uint64_t state = stream_start(spec.seed, slot);
+      bool keep =
+          neighbor != kNoVertex && unit(next_random(state)) >= spec.drop;
+      src[slot] = keep ? (uint32_t)v : kNoVertex;
+      dst[slot] = keep ? (uint32_t)neighbor : kNoVertex;
+    }
+  }
+
+  // Points are bucketed in cells at least as wide as the radius, so the
+  // neighbors of a point are in the 3x3 cells around its own
+  void rgg_edges() {
+    uint64_t side = (uint64_t)(1.0 / spec.radius);
+    uint64_t max_side = 2 * (uint64_t)std::ceil(std::sqrt((double)n));
+    side = side < 1 ? 1 : side > max_side ? max_side : side;
+    std::vector<double> px(n), py(n);
+    std::vector<uint32_t> cell_start(side * side + 1, 0), cell_points(n);
+    auto coordinate = [side](double c) {
+      uint64_t cell = (uint64_t)(c * side);
+      return cell < side ? cell : side - 1;
+    };
+    auto cell_of = [&](uint64_t v) {
+      return coordinate(py[v]) * side + coordinate(px[v]);
+    };
+
+#pragma omp parallel for schedule(static)
+    for (int64_t v = 0; v < (int64_t)n; v++) {
+      uint64_t state = stream_start(spec.seed, v);
+      px[v] = unit(next_random(state));
+      py[v] = unit(next_random(state));
+      uint64_t cell = cell_of(v);
+#pragma omp atomic
+      cell_start[cell + 1]++;
+    }
+    for (uint64_t c = 0; c < side * side; c++) {
+      cell_start[c + 1] += cell_start[c];
+    }
+    std::vector<uint32_t> cursor(cell_start.begin(), cell_start.end() - 1);
+#pragma omp parallel for schedule(static)
+    for (int64_t v = 0; v < (int64_t)n; v++) {
+      uint64_t cell = cell_of(v);
+      uint32_t pos;
+#pragma omp atomic capture
+      pos = cursor[cell]++;
+      cell_points[pos] = (uint32_t)v;
+    }
+
+    double r2 = spec.radius * spec.radius;
+    std::vector<uint64_t> offset(n + 1, 0);
+    // Neighbors with a larger ID, counted (fill = false) or written at
+    // offset[v] (fill = true)
+    auto neighbors = [&](uint64_t v, bool fill) {
+      uint64_t cx = coordinate(px[v]), cy = coordinate(py[v]);
+      uint64_t found = 0;
+      for (uint64_t y = cy > 0 ? cy - 1 : 0; y <= cy + 1 && y < side; y++) {
+        for (uint64_t x = cx > 0 ? cx - 1 : 0; x <= cx + 1 && x < side; x++) {
+          uint64_t cell = y * side + x;
+          for (uint32_t p = cell_start[cell]; p < cell_start[cell + 1]; p++) {
+            uint32_t u = cell_points[p];
+            double dx = px[u] - px[v], dy = py[u] - py[v];
+            if (u > v && dx * dx + dy * dy < r2) {
+              if (fill) {
+                src[offset[v] + found] = (uint32_t)v;
+                dst[offset[v] + found] = u;
+              }
+              found++;
+            }
+          }
+        }
+      }
+      return found;
+    };
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int64_t v = 0; v < (int64_t)n; v++) {
+      offset[v + 1] = neighbors(v, false);
+    }
+    for (uint64_t v = 0; v < n; v++) {
+      offset[v + 1] += offset[v];
+    }
+    src.resize(offset[n]);
+    dst.resize(offset[n]);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int64_t v = 0; v < (int64_t)n; v++) {
+      neighbors(v, true);
+    }
+  }
+
+  // Undirected CSR of the edge list, without self-loops and duplicate edges
+  CSR_local<uint32_t, float> *edges_to_csr() {
+    int64_t m = src.size();
+    std::vector<uint32_t> degrees(n, 0);
+#pragma omp parallel for schedule(static)
+    for (int64_t e = 0; e < m; e++) {
+      if (src[e] != kNoVertex && src[e] != dst[e]) {
+#pragma omp atomic
+        degrees[src[e]]++;
+#pragma omp atomic
+        degrees[dst[e]]++;
+      }
+    }
+    std::vector<uint64_t> row_ptr(n + 1, 0);
+    for (uint64_t v = 0; v < n; v++) {
+      row_ptr[v + 1] = row_ptr[v] + degrees[v];
+    }
+    if (row_ptr[n] > UINT32_MAX) {
+      printf("The generated graph has %lu directed edges, more than the "
+             "32-bit CSR can hold\n",
+             (unsigned long)row_ptr[n]);
+      return nullptr;
+    }
+    std::vector<uint32_t> col_idx(row_ptr[n]);
+    std::vector<uint64_t> cursor(row_ptr.begin(), row_ptr.end() - 1);
+#pragma omp parallel for schedule(static)
+    for (int64_t e = 0; e < m; e++) {
+      uint32_t u = src[e], v = dst[e];
+      if (u != kNoVertex && u != v) {
+        uint64_t pos_u, pos_v;
+#pragma omp atomic capture
+        pos_u = cursor[u]++;
+#pragma omp atomic capture
+        pos_v = cursor[v]++;
+        col_idx[pos_u] = v;
+        col_idx[pos_v] = u;
+      }
+    }
+    std::vector<uint32_t>().swap(src);
+    std::vector<uint32_t>().swap(dst);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int64_t v = 0; v < (int64_t)n; v++) {
+      uint32_t *begin = col_idx.data() + row_ptr[v];
+      uint32_t *end = col_idx.data() + row_ptr[v + 1];
+      std::sort(begin, end);
+      degrees[v] = std::unique(begin, end) - begin;
+    }
+
+    CSR_local<uint32_t, float> *graph = new CSR_local<uint32_t, float>();
+    graph->nrows = n;
+    graph->ncols = n;
+    // Allocated with malloc, as the arrays read by distributed_mmio
+    graph->row_ptr = (uint32_t *)malloc((n + 1) * sizeof(uint32_t));
+    graph->row_ptr[0] = 0;
+    for (uint64_t v = 0; v < n; v++) {
+      graph->row_ptr[v + 1] = graph->row_ptr[v] + degrees[v];
+    }
+    graph->nnz = graph->row_ptr[n];
+    graph->col_idx = (uint32_t *)malloc(graph->nnz * sizeof(uint32_t));
+    graph->val = nullptr;
+#pragma omp parallel for schedule(static)
+    for (int64_t v = 0; v < (int64_t)n; v++) {
+      std::copy(col_idx.begin() + row_ptr[v],
+                col_idx.begin() + row_ptr[v] + degrees[v],
+                graph->col_idx + graph->row_ptr[v]);
+    }
+    return graph;
+  }
+
+public:
+  explicit Generator(const GraphSpec &spec) : spec(spec) {}
+
+  CSR_local<uint32_t, float> *generate() {
+    if (spec.name == "grid") {
+      n = spec.x * spec.y * spec.z;
+    } else {
+      n = 1ULL << spec.scale;
+    }
+    if (spec.name == "rgg") {
+      if (spec.radius == 0) {
+        spec.radius = 0.55 * std::sqrt(std::log((double)n) / n);
+      }
+      rgg_edges();
+    } else {
+      uint64_t m = spec.name == "grid" ? 3 * n : spec.ef * n;
+      src.resize(m);
+      dst.resize(m);
+      if (spec.name == "kron") {
+        kron_edges();
+      } else if (spec.name == "uniform") {
+        uniform_edges();
+      } else {
+        grid_edges();
+      }
+    }
+    return edges_to_csr();
+  }
+};
+
+CSR_local<uint32_t, float> *generate_graph(const char *spec) {
+  GraphSpec parsed;
+  if (!parse_spec(spec, parsed)) {
+    return nullptr;
+  }
+  return Generator(parsed).generate();
+}
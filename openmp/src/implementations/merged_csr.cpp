@@ -1,4 +1,6 @@
 #include "graph.hpp"
+#include "perf_counters.hpp"
+#include "trace.hpp"
 #include <limits>
 
 #define DEGREE(vertex) merged_csr[vertex]
@@ -81,11 +83,28 @@ void MergedCSR_Distances::BFS(vertex source, uint32_t *distances) {
   while (!this_frontier.empty()) {
     frontier next_frontier;
     next_frontier.reserve(this_frontier.size());
+    uint64_t trace_start = tracer != nullptr ? Tracer::now() : 0;
     top_down_step(this_frontier, next_frontier, distance);
+    if (tracer != nullptr) {
+      tracer->record(TRACE_TOP_DOWN, distance - 1, this_frontier.size(),
+                     trace_start);
+    }
     distance++;
     this_frontier = std::move(next_frontier);
   }
+  perf_counters_finalize();
+  uint64_t trace_start = tracer != nullptr ? Tracer::now() : 0;
   compute_distances(distances);
+  if (tracer != nullptr) {
+    tracer->record(TRACE_FINALIZE, 0, 0, trace_start);
+  }
+}
+
+std::vector<MemoryUsage> MergedCSR_Distances::memory_usage() const {
+  return {{"merged_csr", static_cast<uint64_t>(graph->nnz + 2 * graph->nrows) *
+                             sizeof(edge)},
+          {"merged_row_ptr",
+           static_cast<uint64_t>(graph->nrows + 1) * sizeof(edge)}};
 }
 
 bool MergedCSR_Distances::check_result(vertex source, uint32_t *distances) {
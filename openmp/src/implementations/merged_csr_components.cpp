@@ -0,0 +1,199 @@
+#include "graph.hpp"
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+#define DEGREE(vertex) merged_csr[vertex]
+#define COMPONENT(vertex) merged_csr[vertex + 1]
+
+// Afforest parameters (see the pthreads config.h)
+#define NEIGHBOR_ROUNDS 2
+#define NUM_SAMPLES 1024
+
+MergedCSR_Components::MergedCSR_Components(
+    const CSR_local<uint32_t, float> *graph)
+    : graph(graph) {
+  create_merged_csr();
+}
+
+MergedCSR_Components::~MergedCSR_Components() {
+  delete[] merged_csr;
+  delete[] merged_rowptr;
+}
+
+// Create merged CSR from CSR
+void MergedCSR_Components::create_merged_csr() {
+  merged_csr = new edge[graph->nnz + 2 * graph->nrows];
+  merged_rowptr = new edge[graph->nrows + 1];
+  edge merged_index = 0;
+
+  for (vertex i = 0; i < graph->nrows; i++) {
+    edge start = graph->row_ptr[i];
+    // Add degree to start of neighbor list
+    merged_csr[merged_index++] = graph->row_ptr[i + 1] - graph->row_ptr[i];
+    // Component slot, initialized by connected_components
+    merged_csr[merged_index++] = 0;
+    // Copy neighbors
+    for (edge j = start; j < graph->row_ptr[i + 1]; j++) {
+      merged_csr[merged_index++] = graph->row_ptr[graph->col_idx[j]] + 2 * graph->col_idx[j];
+    }
+  }
+  for (vertex i = 0; i <= graph->nrows; i++) {
+    merged_rowptr[i] = graph->row_ptr[i] + 2 * i;
+  }
+}
+
+// Merges the trees of u and v, hooking the larger representative under the
+// smaller one
+void MergedCSR_Components::link(edge u, edge v) {
+  edge p1 = __atomic_load_n(&COMPONENT(u), __ATOMIC_RELAXED);
+  edge p2 = __atomic_load_n(&COMPONENT(v), __ATOMIC_RELAXED);
+  while (p1 != p2) {
+    edge high = std::max(p1, p2);
+    edge low = std::min(p1, p2);
+    edge p_high = __atomic_load_n(&COMPONENT(high), __ATOMIC_RELAXED);
+    if (p_high == low) {
+      break;
+    }
+    if (p_high == high &&
+        __atomic_compare_exchange_n(&COMPONENT(high), &p_high, low, false,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+      break;
+    }
+    p1 = __atomic_load_n(&COMPONENT(COMPONENT(high)), __ATOMIC_RELAXED);
+    p2 = __atomic_load_n(&COMPONENT(low), __ATOMIC_RELAXED);
+  }
+}
+
+// Points every vertex directly to its representative
+void MergedCSR_Components::compress() {
+#pragma omp parallel for schedule(dynamic, 16384)
+  for (vertex i = 0; i < graph->nrows; i++) {
+    edge v = merged_rowptr[i];
+    while (COMPONENT(v) != COMPONENT(COMPONENT(v))) {
+      COMPONENT(v) = COMPONENT(COMPONENT(v));
+    }
+  }
+}
+
+// Guesses the largest component as the most frequent representative of a
+// random sample of vertices
+edge MergedCSR_Components::sample_frequent_component() const {
+  std::mt19937 rng(27491095);
+  std::uniform_int_distribution<vertex> udist(0, graph->nrows - 1);
+  std::vector<edge> samples(NUM_SAMPLES);
+  for (auto &sample : samples) {
+    sample = COMPONENT(merged_rowptr[udist(rng)]);
+  }
+  std::sort(samples.begin(), samples.end());
+  edge most_frequent = samples[0];
+  size_t best_count = 0, count = 0;
+  for (size_t k = 0; k < samples.size(); k++) {
+    count = (k > 0 && samples[k] == samples[k - 1]) ? count + 1 : 1;
+    if (count > best_count) {
+      best_count = count;
+      most_frequent = samples[k];
+    }
+  }
+  return most_frequent;
+}
+
+uint32_t MergedCSR_Components::connected_components(uint32_t *components) {
+  if (graph->nrows == 0) {
+    return 0;
+  }
+#pragma omp parallel for schedule(static)
+  for (vertex i = 0; i < graph->nrows; i++) {
+    COMPONENT(merged_rowptr[i]) = merged_rowptr[i];
+  }
+
+  // Link each vertex to its first neighbors, one neighbor per round
+  for (edge r = 0; r < NEIGHBOR_ROUNDS; r++) {
+#pragma omp parallel for schedule(dynamic, 16384)
+    for (vertex i = 0; i < graph->nrows; i++) {
+      edge v = merged_rowptr[i];
+      if (DEGREE(v) > r) {
+        link(v, merged_csr[v + 2 + r]);
+      }
+    }
+    compress();
+  }
+
+  // Vertices in the largest component skip their remaining edges: the graph
+  // is symmetric, so the edges leaving it are linked from the other side
+  edge giant = sample_frequent_component();
+#pragma omp parallel for schedule(dynamic, 16384)
+  for (vertex i = 0; i < graph->nrows; i++) {
+    edge v = merged_rowptr[i];
+    if (COMPONENT(v) == giant) {
+      continue;
+    }
+    edge end = v + 2 + DEGREE(v);
+    for (edge j = v + 2 + NEIGHBOR_ROUNDS; j < end; j++) {
+      link(v, merged_csr[j]);
+    }
+  }
+  compress();
+
+  // Translate the offsets of the representatives into vertex IDs: the
+  // representatives store their own ID, which every vertex then reads
+  uint32_t num_components = 0;
+#pragma omp parallel for schedule(static)
+  for (vertex i = 0; i < graph->nrows; i++) {
+    components[i] = COMPONENT(merged_rowptr[i]);
+  }
+#pragma omp parallel for schedule(static) reduction(+ : num_components)
+  for (vertex i = 0; i < graph->nrows; i++) {
+    if (components[i] == merged_rowptr[i]) {
+      COMPONENT(merged_rowptr[i]) = i;
+      num_components++;
+    }
+  }
+#pragma omp parallel for schedule(static)
+  for (vertex i = 0; i < graph->nrows; i++) {
+    components[i] = COMPONENT(components[i]);
+  }
+  return num_components;
+}
+
+bool MergedCSR_Components::check_result(const uint32_t *components,
+                                        uint32_t num_components) const {
+  for (vertex u = 0; u < graph->nrows; u++) {
+    for (uint64_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+      if (components[u] != components[graph->col_idx[i]]) {
+        std::cout << "Vertices " << u << " and " << graph->col_idx[i]
+                  << " are adjacent but have different components" << std::endl;
+        return false;
+      }
+    }
+  }
+  // Count the components with a sequential BFS
+  std::vector<bool> visited(graph->nrows, false);
+  std::vector<vertex> queue;
+  queue.reserve(graph->nrows);
+  uint32_t expected = 0;
+  for (vertex s = 0; s < graph->nrows; s++) {
+    if (visited[s]) {
+      continue;
+    }
+    expected++;
+    queue.clear();
+    queue.push_back(s);
+    visited[s] = true;
+    for (size_t head = 0; head < queue.size(); head++) {
+      vertex u = queue[head];
+      for (uint64_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+        if (!visited[graph->col_idx[i]]) {
+          visited[graph->col_idx[i]] = true;
+          queue.push_back(graph->col_idx[i]);
+        }
+      }
+    }
+  }
+  if (num_components != expected) {
+    std::cout << "Found " << num_components << " components, expected "
+              << expected << std::endl;
+    return false;
+  }
+  return true;
+}
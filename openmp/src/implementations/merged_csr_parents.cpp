@@ -1,4 +1,7 @@
 #include <graph.hpp>
+#include <perf_counters.hpp>
+#include <trace.hpp>
+#include <limits>
 #include <omp.h>
 
 #define VERTEX_ID(vertex) merged_csr[vertex]
@@ -9,12 +12,15 @@ MergedCSR_Parents::MergedCSR_Parents(const CSR_local<uint32_t, float>* graph) :
   create_merged_csr();
 }
 
-MergedCSR_Parents::~MergedCSR_Parents() { delete[] merged_csr; }
+MergedCSR_Parents::~MergedCSR_Parents() {
+  delete[] merged_csr;
+  delete[] merged_rowptr;
+}
 
 // Create merged CSR from CSR
 void MergedCSR_Parents::create_merged_csr() {
   merged_csr = new edge[graph->nnz + 3 * graph->nrows];
-  merged_rowptr = new edge[graph->nnz];
+  merged_rowptr = new edge[graph->nrows + 1];
 
   vertex merged_index = 0;
   for (vertex i = 0; i < graph->nrows; i++) {
@@ -41,7 +47,9 @@ void MergedCSR_Parents::create_merged_csr() {
 void MergedCSR_Parents::compute_parents(uint32_t *parents) const {
 #pragma omp parallel for simd schedule(static)
   for (vertex i = 0; i < graph->nrows; i++) {
-    parents[i] = merged_csr[merged_rowptr[i] + 1];
+    parents[i] = PARENT_ID(merged_rowptr[i]);
+    // Reset parent for next BFS
+    PARENT_ID(merged_rowptr[i]) = std::numeric_limits<uint32_t>::max();
   }
 }
 
@@ -56,7 +64,7 @@ void MergedCSR_Parents::top_down_step(const frontier &this_frontier,
     vertex end = v + DEGREE(v) + 3;
     for (edge i = v + 3; i < end; i++) {
       edge neighbor = merged_csr[i];
-      if (PARENT_ID(neighbor) == -1.0) {
+      if (PARENT_ID(neighbor) == std::numeric_limits<uint32_t>::max()) {
         if (DEGREE(neighbor) != 1) {
           next_frontier.push_back(neighbor);
         }
@@ -72,13 +80,32 @@ void MergedCSR_Parents::BFS(vertex source, uint32_t *parents) {
 
   this_frontier.push_back(start);
   PARENT_ID(start) = source;
+  uint32_t level = 0;
   while (!this_frontier.empty()) {
     frontier next_frontier;
     next_frontier.reserve(this_frontier.size());
+    uint64_t trace_start = tracer != nullptr ? Tracer::now() : 0;
     top_down_step(this_frontier, next_frontier);
+    if (tracer != nullptr) {
+      tracer->record(TRACE_TOP_DOWN, level, this_frontier.size(),
+                     trace_start);
+    }
+    level++;
     this_frontier = std::move(next_frontier);
   }
+  perf_counters_finalize();
+  uint64_t trace_start = tracer != nullptr ? Tracer::now() : 0;
   compute_parents(parents);
+  if (tracer != nullptr) {
+    tracer->record(TRACE_FINALIZE, 0, 0, trace_start);
+  }
+}
+
+std::vector<MemoryUsage> MergedCSR_Parents::memory_usage() const {
+  return {{"merged_csr", static_cast<uint64_t>(graph->nnz + 3 * graph->nrows) *
+                             sizeof(edge)},
+          {"merged_row_ptr",
+           static_cast<uint64_t>(graph->nrows + 1) * sizeof(edge)}};
 }
 
 bool MergedCSR_Parents::check_result(vertex source, uint32_t *parents) {
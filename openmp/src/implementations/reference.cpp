@@ -1,5 +1,6 @@
 #include "mmio.h"
 #include <graph.hpp>
+#include <trace.hpp>
 #include <limits>
 
 Reference::Reference(const CSR_local<uint32_t, float> *graph) : BFS_Impl(graph) {}
@@ -12,6 +13,7 @@ void Reference::BFS(vertex source, uint32_t *distances) {
   std::vector<vertex> this_frontier = {};
   distances[source] = 0;
   this_frontier.push_back(source);
+  uint32_t level = 0;
   #ifdef FRONTIER_DEBUG
   int i = 0;
   #endif
@@ -20,6 +22,7 @@ void Reference::BFS(vertex source, uint32_t *distances) {
     std::printf("frontier: %d size: %zu\n", i++, this_frontier.size());
     #endif
     std::vector<vertex> next_frontier;
+    uint64_t trace_start = tracer != nullptr ? Tracer::now() : 0;
     for (const auto &src : this_frontier) {
       for (uint64_t i = graph->row_ptr[src]; i < graph->row_ptr[src + 1]; i++) {
         vertex dst = graph->col_idx[i];
@@ -29,6 +32,11 @@ void Reference::BFS(vertex source, uint32_t *distances) {
         }
       }
     }
+    if (tracer != nullptr) {
+      tracer->record(TRACE_TOP_DOWN, level, this_frontier.size(),
+                     trace_start);
+    }
+    level++;
     std::swap(this_frontier, next_frontier);
   }
 }
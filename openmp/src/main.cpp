@@ -1,6 +1,13 @@
+#include "bfs_api.hpp"
+#include "energy.hpp"
+#include "generators.hpp"
 #include "graph.hpp"
+#include "memory_report.hpp"
+#include "perf_counters.hpp"
+#include "sources.hpp"
+#include "trace.hpp"
+#include <cstdlib>
 #include <omp.h>
-#include <random>
 #include <sys/types.h>
 
 #ifdef USE_PAPI
@@ -16,64 +23,93 @@ void handle_error(int retval) {
 #define USAGE                                                                  \
   "Usage: %s <dataset> <runs> <implementation> <check> <source> \nRuns BFS "   \
   "implementations. \n\nMandatory arguments:\n  <dataset>\t path to dataset "  \
+  "(or a generator spec such as kron:scale=24,ef=16, see below) "            \
   "\n  <runs>\t\t : integer. Number of runs (1 by default) \n  <source>\t : "  \
-  "integer. Source vertex ID (64 randomly generated vertices by default) \n "  \
+  "integer. Source vertex ID, or 'giant' for random vertices in the largest " \
+  "connected component (random vertices by default) \n "                      \
   " <algorithm>\t : 'merged_csr_parents', 'merged_csr_distances', "            \
-  "'reference' ('reference' by default) \n  <check>\t : 'true', false'. "      \
-  "Checks correctness of the result ('false' by default)\n"
-
-// A constant seed for the random number generator, equal to kRandSeed in GAPBS.
-const int kRandSeed = 27491095;
-
-// UniDist is a utility class from the GAP Benchmark Suite for generating
-// uniformly distributed random numbers within a specific range.
-template <typename NodeID_, typename rng_t_,
-          typename uNodeID_ = typename std::make_unsigned<NodeID_>::type>
-class UniDist {
-public:
-  UniDist(NodeID_ max_value, rng_t_ &rng) : rng_(rng) {
-    uNodeID_ u_max_value = static_cast<uNodeID_>(max_value);
-    no_mod_ = (rng_.max() == u_max_value);
-    mod_ = u_max_value + 1;
-    uNodeID_ remainder_sub_1 = rng_.max() % mod_;
-    if (remainder_sub_1 == mod_ - 1)
-      cutoff_ = 0;
-    else
-      cutoff_ = rng_.max() - remainder_sub_1;
-  }
-
-  NodeID_ operator()() {
-    uNodeID_ rand_num = rng_();
-    if (no_mod_)
-      return rand_num;
-    if (cutoff_ != 0) {
-      while (rand_num >= cutoff_)
-        rand_num = rng_();
+  "'merged_csr_components', 'reference' ('reference' by default) \n  <check>\t : 'true', false'. "      \
+  "Checks correctness of the result ('false' by default)\n\nSet "              \
+  "PERF_COUNTERS=1 to print the hardware counters of each thread per phase, "   \
+  "POWERCAP_ROOT=/sys/class/powercap to measure the energy of each run and "   \
+  "TRACE_FILE=<path> to write a Chrome trace of the levels of each run. "     \
+  "MEMORY_REPORT=1 prints the bytes of each structure after the runs and "     \
+  "FREE_CSR=1 frees the source CSR once the merged CSR is built\n"            \
+  "\nGenerators: kron:scale=S,ef=E, uniform:scale=S,ef=E, "                    \
+  "grid:x=X,y=Y,z=Z,drop=P, rgg:scale=S,r=R, each with an optional seed=N\n"
+
+// Returns the label of the largest connected component of the graph, writing
+// the component of each vertex to `components`.
+uint32_t giant_component(const CSR_local<uint32_t, float> *graph,
+                         uint32_t *components) {
+  MergedCSR_Components cc(graph);
+  cc.connected_components(components);
+  std::vector<uint32_t> sizes(graph->nrows, 0);
+  uint32_t giant = 0;
+  for (uint32_t i = 0; i < graph->nrows; i++) {
+    if (++sizes[components[i]] > sizes[giant]) {
+      giant = components[i];
     }
-    return rand_num % mod_;
-  }
-
-private:
-  rng_t_ &rng_;
-  bool no_mod_;
-  uNodeID_ mod_;
-  uNodeID_ cutoff_;
-};
-
-// Generates a vector of random source vertices for a given graph.
-// It ensures that selected vertices have an out-degree greater than zero.
-void generate_random_sources(const CSR_local<uint32_t, float> *graph,
-                        size_t num_sources, std::vector<uint32_t>& sources) {
-  std::mt19937_64 rng(kRandSeed);
-  UniDist<uint32_t, std::mt19937_64> udist(graph->nrows - 1, rng);
-
-  while (sources.size() < num_sources) {
-    uint32_t source = udist();
-    // Ensure the source has outgoing edges
-    if ((graph->row_ptr[source + 1] - graph->row_ptr[source]) > 0) {
-      sources.push_back(source);
+  }
+  printf("giant_component=%u,size=%u\n", giant, sizes[giant]);
+  return giant;
+}
+
+// Runs connected components instead of BFS, once per run
+void run_components(const CSR_local<uint32_t, float> *graph, int runs,
+                    bool check) {
+  MergedCSR_Components cc(graph);
+  uint32_t *components = new uint32_t[graph->nrows];
+  for (int i = 0; i < runs; i++) {
+    double t_start = omp_get_wtime();
+    uint32_t num_components = cc.connected_components(components);
+    double t_end = omp_get_wtime();
+    printf("run_id=%d,threads=%d,components=%u,%.4f\n", i,
+           omp_get_max_threads(), num_components, t_end - t_start);
+    if (check) {
+      printf("Checking components\n");
+      cc.check_result(components, num_components);
     }
   }
+  delete[] components;
+}
+
+// Number of directed edges scanned by a BFS: the degrees of the reached
+// vertices (distances and parents are both UINT32_MAX for the others)
+uint64_t traversed_edges(const CSR_local<uint32_t, float> *graph,
+                         const uint32_t *result) {
+  uint64_t edges = 0;
+  for (uint32_t i = 0; i < graph->nrows; i++) {
+    if (result[i] != UINT32_MAX) {
+      edges += graph->row_ptr[i + 1] - graph->row_ptr[i];
+    }
+  }
+  return edges;
+}
+
+// Bytes of the arrays of a CSR graph
+uint64_t csr_bytes(const CSR_local<uint32_t, float> *graph) {
+  if (graph->row_ptr == nullptr) {
+    return 0;
+  }
+  uint64_t bytes = (static_cast<uint64_t>(graph->nrows) + 1) * sizeof(uint32_t);
+  if (graph->col_idx != nullptr) {
+    bytes += static_cast<uint64_t>(graph->nnz) * sizeof(uint32_t);
+  }
+  if (graph->val != nullptr) {
+    bytes += static_cast<uint64_t>(graph->nnz) * sizeof(float);
+  }
+  return bytes;
+}
+
+// Frees the arrays of a CSR graph, keeping its sizes
+void free_csr(CSR_local<uint32_t, float> *graph) {
+  free(graph->row_ptr);
+  free(graph->col_idx);
+  free(graph->val);
+  graph->row_ptr = nullptr;
+  graph->col_idx = nullptr;
+  graph->val = nullptr;
 }
 
 int main(const int argc, char **argv) {
@@ -91,8 +127,53 @@ int main(const int argc, char **argv) {
   }
 
   double t_start = omp_get_wtime();
-  CSR_local<uint32_t, float> *graph =
-      Distr_MMIO_CSR_local_read<uint32_t, float>(argv[1], false);
+  CSR_local<uint32_t, float> *graph = load_graph(argv[1]);
+  if (graph == nullptr) {
+    return 1;
+  }
+  if (is_generator_spec(argv[1])) {
+    printf("Generated %s: %u vertices, %u edges in %.4f s\n", argv[1],
+           graph->nrows, graph->nnz, omp_get_wtime() - t_start);
+  }
+
+  if (argc > 2) {
+    runs = std::stoi(argv[2]);
+  }
+
+  if (argc > 4) {
+    check = true;
+  }
+
+  // Once the merged CSR is built, only the checks and the energy report read
+  // the source CSR
+  const char *free_env = std::getenv("FREE_CSR");
+  bool free_source = free_env != nullptr && std::string(free_env) == "1";
+  bool merged = algo_str == "merged_csr_distances" ||
+                algo_str == "merged_csr_parents";
+  if (free_source &&
+      (!merged || check || std::getenv("POWERCAP_ROOT") != nullptr)) {
+    printf("FREE_CSR needs a merged CSR implementation, without the check and "
+           "POWERCAP_ROOT\n");
+    delete graph;
+    return 1;
+  }
+
+  if (algo_str == "merged_csr_components") {
+    printf("Using Merged CSR Connected Components implementation\n");
+    run_components(graph, runs, check);
+    delete graph;
+    return 0;
+  }
+
+  // Hardware counters are opt-in, since opening them costs a few system calls
+  // per thread and needs a permissive perf_event_paranoid
+  const char *perf_env = std::getenv("PERF_COUNTERS");
+  if (perf_env != nullptr && std::string(perf_env) == "1") {
+    perf_counters = PerfCounters::open();
+  }
+  if (perf_counters != nullptr) {
+    perf_counters->begin(PERF_BUILD);
+  }
 
   BFS_Impl *bfs;
   if (algo_str == "merged_csr_parents") {
@@ -105,23 +186,28 @@ int main(const int argc, char **argv) {
     printf("Using Reference implementation\n");
     bfs = new Reference(graph);
   }
+  if (perf_counters != nullptr) {
+    perf_counters->end(PERF_BUILD);
+  }
   double t_end = omp_get_wtime();
 
   printf("Initialization: %f\n", t_end - t_start);
 
-  if (argc > 2) {
-    runs = std::stoi(argv[2]);
-  }
-
-  if (argc > 4) {
-    check = true;
-  }
-
-  if (argc > 5) {
+  if (argc > 5 && std::string(argv[5]) == "giant") {
+    uint32_t *components = new uint32_t[graph->nrows];
+    uint32_t giant = giant_component(graph, components);
+    generate_random_sources(bfs->graph, runs, sources, components, giant);
+    delete[] components;
+  } else if (argc > 5) {
     sources.insert(sources.end(), runs, std::stoi(argv[5]));
   } else {
     generate_random_sources(bfs->graph, runs, sources);
   }
+  if (free_source) {
+    printf("Freed the source CSR (%.2f MiB) after building the merged CSR\n",
+           csr_bytes(graph) / (1024.0 * 1024.0));
+    free_csr(graph);
+  }
 
 #pragma omp parallel
   {
@@ -132,6 +218,15 @@ int main(const int argc, char **argv) {
   }
 
   uint32_t *result = new uint32_t[bfs->graph->nrows];
+  EnergyMeter *meter = nullptr;
+  const char *powercap_root = std::getenv("POWERCAP_ROOT");
+  if (powercap_root != nullptr) {
+    meter = EnergyMeter::open(powercap_root);
+  }
+  const char *trace_file = std::getenv("TRACE_FILE");
+  if (trace_file != nullptr) {
+    tracer = new Tracer();
+  }
 
   for (uint32_t i = 0; i < sources.size(); i++) {
 #ifndef USE_PAPI
@@ -147,11 +242,41 @@ int main(const int argc, char **argv) {
       }
     }
     #endif
+    if (meter != nullptr) {
+      meter->start();
+    }
+    if (perf_counters != nullptr) {
+      perf_counters->start_traversal();
+    }
+    uint64_t trace_start = tracer != nullptr ? Tracer::now() : 0;
     bfs->BFS(sources[i], result);
+    if (tracer != nullptr) {
+      tracer->record(TRACE_RUN, 0, i, trace_start);
+    }
+    if (perf_counters != nullptr) {
+      perf_counters->stop();
+    }
 #ifndef USE_PAPI
     t_end = omp_get_wtime();
-    printf("run_id=%d,threads=%d,source=%d,%.4f\n", i, omp_get_max_threads(),
-           sources[i], t_end - t_start);
+    double joules = meter != nullptr ? meter->stop() : 0;
+    printf("run_id=%d,threads=%d,source=%d,", i, omp_get_max_threads(),
+           sources[i]);
+    if (meter != nullptr) {
+      // GTEPS per watt is the number of (billion) edges per joule
+      double gteps_per_watt =
+          joules > 0 ? traversed_edges(graph, result) * 1e-9 / joules : 0;
+      printf("joules=%.4f,gteps_per_watt=%.6f,", joules, gteps_per_watt);
+    }
+    printf("%.4f\n", t_end - t_start);
+    if (perf_counters != nullptr) {
+      // The merged CSR is built once, its counters come with the first run
+      if (i == 0) {
+        perf_counters->print(i, PERF_BUILD);
+      }
+      perf_counters->print(i, PERF_TRAVERSAL);
+      perf_counters->print(i, PERF_FINALIZE);
+      perf_counters->reset();
+    }
     if (check) {
       printf("Checking result for source %d\n", sources[i]);
       bfs->check_result(sources[i], result);
@@ -166,8 +291,24 @@ int main(const int argc, char **argv) {
       handle_error(retval);
   }
 #endif
+  const char *memory_env = std::getenv("MEMORY_REPORT");
+  if (memory_env != nullptr && std::string(memory_env) == "1") {
+    std::vector<MemoryUsage> items = {{"csr", csr_bytes(graph)}};
+    for (const MemoryUsage &item : bfs->memory_usage()) {
+      items.push_back(item);
+    }
+    items.push_back({"distances", static_cast<uint64_t>(graph->nrows) *
+                                      sizeof(uint32_t)});
+    print_memory_report(items, graph->nnz);
+  }
   delete[] result;
   delete graph;
   delete bfs;
+  if (tracer != nullptr) {
+    tracer->write(trace_file);
+  }
+  delete perf_counters;
+  delete meter;
+  delete tracer;
   return 0;
 }
\ No newline at end of file
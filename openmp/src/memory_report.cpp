@@ -0,0 +1,52 @@
+#include "memory_report.hpp"
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
+
+static void print_item(const std::string &name, uint64_t bytes,
+                       uint64_t edges) {
+  printf("memory_structure=%s,bytes=%llu,mib=%.2f,bytes_per_edge=%.2f\n",
+         name.c_str(), static_cast<unsigned long long>(bytes),
+         bytes / (1024.0 * 1024.0),
+         edges > 0 ? static_cast<double>(bytes) / edges : 0);
+}
+
+// Resident pages from /proc/self/statm, 0 if it cannot be read
+static uint64_t current_rss() {
+  FILE *f = fopen("/proc/self/statm", "r");
+  if (f == nullptr) {
+    return 0;
+  }
+  unsigned long size, resident;
+  int read = fscanf(f, "%lu %lu", &size, &resident);
+  fclose(f);
+  return read == 2 ? static_cast<uint64_t>(resident) * sysconf(_SC_PAGESIZE)
+                   : 0;
+}
+
+static uint64_t peak_rss() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  // Kilobytes on Linux
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+void print_memory_report(const std::vector<MemoryUsage> &items,
+                         uint64_t edges) {
+  uint64_t total = 0;
+  for (const MemoryUsage &item : items) {
+    if (item.bytes > 0) {
+      print_item(item.name, item.bytes, edges);
+      total += item.bytes;
+    }
+  }
+  print_item("total", total, edges);
+  // ru_maxrss is updated lazily and can trail the resident pages of statm, so
+  // the peak is at least the current RSS
+  uint64_t rss = current_rss();
+  uint64_t peak = peak_rss();
+  print_item("rss", rss, edges);
+  print_item("peak_rss", peak > rss ? peak : rss, edges);
+}
@@ -0,0 +1,194 @@
+#include "perf_counters.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <linux/perf_event.h>
+#include <omp.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+PerfCounters *perf_counters = nullptr;
+
+static const char *event_names[PERF_NUM_EVENTS] = {
+    "cycles", "instructions", "llc_misses", "dtlb_misses", "stalled_cycles"};
+static const char *phase_names[PERF_NUM_PHASES] = {"build", "traversal",
+                                                   "finalize"};
+
+static perf_event_attr event_attr(int event) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  switch (event) {
+  case PERF_CYCLES:
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    break;
+  case PERF_INSTRUCTIONS:
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    break;
+  case PERF_LLC_MISSES:
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    break;
+  case PERF_DTLB_MISSES:
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    break;
+  default:
+    attr.config = PERF_COUNT_HW_STALLED_CYCLES_BACKEND;
+    break;
+  }
+  // Multiplexed events are scaled by the fraction of time they counted
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return attr;
+}
+
+int PerfCounters::open_counters(ThreadCounters &t) {
+  int opened = 0;
+  for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+    perf_event_attr attr = event_attr(e);
+    t.fds[e] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    opened += t.fds[e] >= 0;
+  }
+  t.opened = true;
+  return opened;
+}
+
+void PerfCounters::read_counters(const ThreadCounters &t, Reading *readings) {
+  for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+    if (t.fds[e] < 0 ||
+        read(t.fds[e], &readings[e], sizeof(Reading)) != sizeof(Reading)) {
+      memset(&readings[e], 0, sizeof(Reading));
+    }
+  }
+}
+
+PerfCounters *PerfCounters::open() {
+  PerfCounters *counters = new PerfCounters();
+  counters->threads.resize(omp_get_max_threads());
+  if (open_counters(counters->threads[omp_get_thread_num()]) == 0) {
+    printf("Hardware counters unavailable (%s), check "
+           "/proc/sys/kernel/perf_event_paranoid\n",
+           strerror(errno));
+    delete counters;
+    return nullptr;
+  }
+  return counters;
+}
+
+PerfCounters::~PerfCounters() {
+  for (const ThreadCounters &t : threads) {
+    if (!t.opened) {
+      continue;
+    }
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+      if (t.fds[e] >= 0) {
+        close(t.fds[e]);
+      }
+    }
+  }
+}
+
+void PerfCounters::begin(PerfPhase phase) {
+  ThreadCounters &t = threads[omp_get_thread_num()];
+  if (!t.opened) {
+    open_counters(t);
+  }
+  t.active[phase] = true;
+  read_counters(t, t.start);
+}
+
+void PerfCounters::end(PerfPhase phase) {
+  ThreadCounters &t = threads[omp_get_thread_num()];
+  Reading end[PERF_NUM_EVENTS];
+  read_counters(t, end);
+  for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+    uint64_t running = end[e].running - t.start[e].running;
+    if (running > 0) {
+      t.counts[phase][e] += (double)(end[e].value - t.start[e].value) *
+                            (end[e].enabled - t.start[e].enabled) / running;
+    }
+  }
+}
+
+void PerfCounters::start_traversal() {
+  finalizing = false;
+#pragma omp parallel
+  begin(PERF_TRAVERSAL);
+}
+
+void PerfCounters::start_finalize() {
+  finalizing = true;
+#pragma omp parallel
+  {
+    end(PERF_TRAVERSAL);
+    begin(PERF_FINALIZE);
+  }
+}
+
+void PerfCounters::stop() {
+  PerfPhase phase = finalizing ? PERF_FINALIZE : PERF_TRAVERSAL;
+#pragma omp parallel
+  end(phase);
+}
+
+void PerfCounters::reset() {
+  for (ThreadCounters &t : threads) {
+    memset(t.active, 0, sizeof(t.active));
+    memset(t.counts, 0, sizeof(t.counts));
+  }
+}
+
+void PerfCounters::print_counts(int run_id, PerfPhase phase,
+                                const char *thread, const double *counts,
+                                const bool *available) const {
+  printf("perf_run_id=%d,phase=%s,thread=%s", run_id, phase_names[phase],
+         thread);
+  for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+    if (available[e]) {
+      printf(",%s=%.0f", event_names[e], counts[e]);
+    } else {
+      printf(",%s=n/a", event_names[e]);
+    }
+  }
+  if (available[PERF_CYCLES] && available[PERF_INSTRUCTIONS] &&
+      counts[PERF_CYCLES] > 0) {
+    printf(",ipc=%.3f", counts[PERF_INSTRUCTIONS] / counts[PERF_CYCLES]);
+  }
+  printf("\n");
+}
+
+void PerfCounters::print(int run_id, PerfPhase phase) const {
+  double total[PERF_NUM_EVENTS] = {};
+  bool available[PERF_NUM_EVENTS] = {};
+  int active = 0;
+  for (size_t i = 0; i < threads.size(); i++) {
+    const ThreadCounters &t = threads[i];
+    if (!t.active[phase]) {
+      continue;
+    }
+    bool thread_available[PERF_NUM_EVENTS];
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+      thread_available[e] = t.fds[e] >= 0;
+      available[e] |= thread_available[e];
+      total[e] += t.counts[phase][e];
+    }
+    print_counts(run_id, phase, std::to_string(i).c_str(), t.counts[phase],
+                 thread_available);
+    active++;
+  }
+  if (active > 1) {
+    print_counts(run_id, phase, "all", total, available);
+  }
+}
+
+void perf_counters_finalize() {
+  if (perf_counters != nullptr) {
+    perf_counters->start_finalize();
+  }
+}
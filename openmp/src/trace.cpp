@@ -0,0 +1,61 @@
+#include "trace.hpp"
+#include <cstdio>
+#include <ctime>
+
+Tracer *tracer = nullptr;
+
+static const char *names[TRACE_NUM_TYPES] = {"top_down", "finalize", "run"};
+
+Tracer::Tracer() : events(kBufferEvents), epoch(now()) {}
+
+uint64_t Tracer::now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+void Tracer::record(TraceType type, uint32_t level, uint32_t arg,
+                    uint64_t start_ns) {
+  Event &e = events[count++ % kBufferEvents];
+  e.start_ns = start_ns;
+  e.end_ns = now();
+  e.level = level;
+  e.arg = arg;
+  e.type = type;
+}
+
+bool Tracer::write(const std::string &path) const {
+  FILE *f = fopen(path.c_str(), "w");
+  if (f == nullptr) {
+    printf("Failed to open trace file [%s]\n", path.c_str());
+    return false;
+  }
+  uint64_t first = 0;
+  if (count > kBufferEvents) {
+    first = count - kBufferEvents;
+    printf("Trace buffer overflowed, only its last %llu events are written\n",
+           static_cast<unsigned long long>(kBufferEvents));
+  }
+  fprintf(f, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n"
+             "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, "
+             "\"tid\": 0, \"args\": {\"name\": \"main\"}}");
+  for (uint64_t i = first; i < count; i++) {
+    const Event &e = events[i % kBufferEvents];
+    // Timestamps and durations are in microseconds
+    fprintf(f,
+            ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, "
+            "\"ts\": %.3f, \"dur\": %.3f, \"args\": {",
+            names[e.type], (e.start_ns - epoch) / 1e3,
+            (e.end_ns - e.start_ns) / 1e3);
+    if (e.type == TRACE_TOP_DOWN) {
+      fprintf(f, "\"level\": %u, \"vertices\": %u", e.level, e.arg);
+    } else if (e.type == TRACE_RUN) {
+      fprintf(f, "\"run_id\": %u", e.arg);
+    }
+    fprintf(f, "}}");
+  }
+  fprintf(f, "\n]}\n");
+  fclose(f);
+  printf("Trace written to %s\n", path.c_str());
+  return true;
+}
@@ -1,4 +1,5 @@
 import glob
+import json
 import os
 from typing import Optional, Tuple
 import pandas as pd
@@ -86,6 +87,29 @@ def jobs_to_dataframe() -> pd.DataFrame:
     
   return pd.DataFrame(parsed_jobs)
 
+def bench_to_dataframe(pattern: str = "logs/bench/*.json") -> pd.DataFrame:
+  """Loads the JSON summaries written by benchmark/bin/bench -o <file>.json."""
+  rows = []
+  for path in glob.glob(pattern):
+    with open(path, "r") as f:
+      results = json.load(f)
+    dataset = os.path.basename(results["graph"]).removesuffix(".mtx")
+    for engine in results["engines"]:
+      rows.append(
+        {
+          "implementation": engine["engine"],
+          "dataset": dataset,
+          "num_cpus": engine["threads"],
+          "runtime": engine["geomean"],
+          "std_runtime": engine["stddev"],
+          "min_runtime": engine["min"],
+          "max_runtime": engine["max"],
+          "median_runtime": engine["median"],
+          "gteps": engine["gteps"],
+        }
+      )
+  return pd.DataFrame(rows)
+
 if __name__ == "__main__":
   df = jobs_to_dataframe()
   if not df.empty:
@@ -0,0 +1,274 @@
+// Micro-benchmarks of the building blocks of the BFS engine, measured in
+// isolation from any graph:
+//  - create_remove: frontier_create_chunk, CHUNK_SIZE pushes, then
+//    frontier_remove_chunk and CHUNK_SIZE pops, batched as in a level (one op
+//    is one chunk of one thread)
+//  - steal_balanced, steal_imbalanced: the own-chunks-then-steal loop of
+//    top_down draining -n chunks in total, spread over the pools or all in the
+//    pool of thread 0 (one op is one chunk); pools never shrink, so the total
+//    rather than the per-pool count keeps the memory independent of
+//    MAX_THREADS
+//  - dispatch: thread_pool_start_wait round trip of an empty work cycle (one
+//    op is one cycle)
+//  - barrier, level_barrier: barrier_wait and the inline level barrier of
+//    thread_main with no work in between (one op is one barrier)
+// MAX_THREADS and CHUNK_SIZE are compile-time constants, so `make microbench`
+// builds one binary per combination of MICRO_THREADS and MICRO_CHUNK_SIZES.
+#define _GNU_SOURCE
+#include "barrier.h"
+#include "cli_parser.h"
+#include "config.h"
+#include "frontier.h"
+#include "thread_pool.h"
+#include "utils.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Chunks a thread creates before removing them in create_remove, about the
+// number of chunks a thread produces in a level of a large frontier
+#define CREATE_BATCH 64
+
+thread_pool_t tp;
+
+static int iterations = 100000;
+static Frontier *frontier;
+static Barrier start_barrier;
+static Barrier barrier;
+static atomic_int active_threads = MAX_THREADS;
+static atomic_int level_threads = MAX_THREADS;
+static volatile int level;
+static uint64_t elapsed_ns[MAX_THREADS];
+// Sum of the popped vertices, so that the pops are not optimized away
+static uint64_t checksum[MAX_THREADS];
+
+static const char *primitives[] = {"create_remove", "steal_balanced",
+                                   "steal_imbalanced", "dispatch",
+                                   "barrier", "level_barrier"};
+
+// The last thread to finish wakes up the main thread, as in thread_main
+static void finish_cycle() {
+  if (atomic_fetch_sub(&active_threads, 1) == 1) {
+    active_threads = MAX_THREADS;
+    thread_pool_notify_parent(&tp);
+  }
+}
+
+static void fill_chunk(Chunk *c) {
+  for (int k = 0; k < CHUNK_SIZE; k++) {
+    chunk_push_vertex(c, k);
+  }
+}
+
+static uint64_t drain_chunk(Chunk *c) {
+  uint64_t sum = 0;
+  mer_t v;
+  while ((v = chunk_pop_vertex(c)) != VERT_MAX) {
+    sum += v;
+  }
+  return sum;
+}
+
+static void *create_remove(void *arg) {
+  int thread_id = *(int *)arg;
+  uint64_t sum = 0;
+  barrier_wait(&start_barrier, NULL, NULL);
+  uint64_t start = monotonic_ns();
+  for (int i = 0; i < iterations; i++) {
+    fill_chunk(frontier_create_chunk(frontier, thread_id));
+    if ((i + 1) % CREATE_BATCH == 0 || i + 1 == iterations) {
+      Chunk *c;
+      while ((c = frontier_remove_chunk(frontier, thread_id)) != NULL) {
+        sum += drain_chunk(c);
+      }
+    }
+  }
+  elapsed_ns[thread_id] = monotonic_ns() - start;
+  checksum[thread_id] = sum;
+  finish_cycle();
+  return NULL;
+}
+
+static void *steal(void *arg) {
+  int thread_id = *(int *)arg;
+  uint64_t sum = 0;
+  Chunk *c;
+  barrier_wait(&start_barrier, NULL, NULL);
+  uint64_t start = monotonic_ns();
+  while ((c = frontier_remove_chunk(frontier, thread_id)) != NULL) {
+    sum += drain_chunk(c);
+  }
+  // Same loop as top_down, skipping the pools with a single chunk left
+  bool work_to_do = true;
+  while (work_to_do) {
+    work_to_do = false;
+    for (int i = 0; i < MAX_THREADS; i++) {
+      if (frontier->thread_chunks[i]->top_chunk > 1) {
+        work_to_do = true;
+        if ((c = frontier_remove_chunk(frontier, i)) != NULL) {
+          sum += drain_chunk(c);
+        }
+        i--;
+      }
+    }
+  }
+  elapsed_ns[thread_id] = monotonic_ns() - start;
+  checksum[thread_id] = sum;
+  finish_cycle();
+  return NULL;
+}
+
+static void *dispatch(void *arg) {
+  (void)arg;
+  finish_cycle();
+  return NULL;
+}
+
+static void *spin_barrier(void *arg) {
+  int thread_id = *(int *)arg;
+  barrier_wait(&start_barrier, NULL, NULL);
+  uint64_t start = monotonic_ns();
+  for (int i = 0; i < iterations; i++) {
+    barrier_wait(&barrier, NULL, NULL);
+  }
+  elapsed_ns[thread_id] = monotonic_ns() - start;
+  finish_cycle();
+  return NULL;
+}
+
+static void *level_barrier(void *arg) {
+  int thread_id = *(int *)arg;
+  barrier_wait(&start_barrier, NULL, NULL);
+  uint64_t start = monotonic_ns();
+  for (int i = 0; i < iterations; i++) {
+    int old = level;
+    if (atomic_fetch_sub(&level_threads, 1) == 1) {
+      level_threads = MAX_THREADS;
+      atomic_thread_fence(memory_order_seq_cst);
+      level++;
+    }
+    while (level == old)
+      ;
+  }
+  elapsed_ns[thread_id] = monotonic_ns() - start;
+  finish_cycle();
+  return NULL;
+}
+
+/**
+ * Runs one repetition of `primitive` and returns its time per op in
+ * nanoseconds. The time of a work cycle is the one of its slowest thread.
+ */
+static double measure(const char *primitive) {
+  if (strcmp(primitive, "dispatch") == 0) {
+    tp.routine = dispatch;
+    uint64_t start = monotonic_ns();
+    for (int i = 0; i < iterations; i++) {
+      thread_pool_start_wait(&tp);
+    }
+    return (double)(monotonic_ns() - start) / iterations;
+  }
+
+  double ops = iterations;
+  frontier_clear(frontier);
+  if (strcmp(primitive, "create_remove") == 0) {
+    tp.routine = create_remove;
+  } else if (strncmp(primitive, "steal", 5) == 0) {
+    bool imbalanced = strcmp(primitive, "steal_imbalanced") == 0;
+    int pool_chunks = iterations / MAX_THREADS > 0 ? iterations / MAX_THREADS
+                                                   : 1;
+    for (int t = 0; t < MAX_THREADS; t++) {
+      for (int i = 0; i < pool_chunks; i++) {
+        fill_chunk(frontier_create_chunk(frontier, imbalanced ? 0 : t));
+      }
+    }
+    ops = (double)pool_chunks * MAX_THREADS;
+    tp.routine = steal;
+  } else if (strcmp(primitive, "barrier") == 0) {
+    tp.routine = spin_barrier;
+  } else {
+    level = 0;
+    tp.routine = level_barrier;
+  }
+  thread_pool_start_wait(&tp);
+
+  uint64_t slowest = 0;
+  for (int t = 0; t < MAX_THREADS; t++) {
+    slowest = elapsed_ns[t] > slowest ? elapsed_ns[t] : slowest;
+  }
+  return slowest / ops;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+  int repeats = 5;
+  char *only = NULL;
+  const CliOption options[] = {
+      {'n', "iterations",
+       "Ops per thread in each repetition (chunks in total for the steal "
+       "benchmarks, 100000 by default)",
+       ARG_TYPE_INT, &iterations, false},
+      {'r', "repeats", "Repetitions of each benchmark (5 by default)",
+       ARG_TYPE_INT, &repeats, false},
+      {'b', "benchmark",
+       "Run only this primitive: create_remove, steal_balanced, "
+       "steal_imbalanced, dispatch, barrier or level_barrier",
+       ARG_TYPE_STRING, &only, false}};
+  int num_options = sizeof(options) / sizeof(options[0]);
+  int parse_result =
+      cli_parse(argc, argv, options, num_options,
+                "Micro-benchmarks of the frontier, work stealing, thread pool "
+                "and barrier primitives.");
+  if (parse_result != 0) {
+    free(only);
+    return (parse_result == 1) ? 0 : 1;
+  }
+  if (iterations < 1 || repeats < 1) {
+    printf("The iterations and repeats must be positive\n");
+    return 1;
+  }
+  int num_primitives = sizeof(primitives) / sizeof(primitives[0]);
+  bool found = only == NULL;
+  for (int p = 0; p < num_primitives; p++) {
+    found |= only != NULL && strcmp(only, primitives[p]) == 0;
+  }
+  if (!found) {
+    printf("Unknown benchmark [%s]\n", only);
+    return 1;
+  }
+
+  frontier = frontier_create();
+  barrier_init(&start_barrier);
+  barrier_init(&barrier);
+  init_thread_pool(&tp, dispatch);
+  thread_pool_create(&tp);
+
+  double *samples = (double *)malloc(repeats * sizeof(double));
+  for (int p = 0; p < num_primitives; p++) {
+    if (only != NULL && strcmp(only, primitives[p]) != 0) {
+      continue;
+    }
+    for (int r = 0; r < repeats; r++) {
+      samples[r] = measure(primitives[p]);
+    }
+    qsort(samples, repeats, sizeof(double), compare_doubles);
+    printf("primitive=%s,threads=%d,chunk_size=%d,iterations=%d,repeats=%d,"
+           "min_ns=%.2f,median_ns=%.2f\n",
+           primitives[p], MAX_THREADS, CHUNK_SIZE, iterations, repeats,
+           samples[0], samples[repeats / 2]);
+  }
+
+  thread_pool_terminate(&tp);
+  destroy_thread_pool(&tp);
+  frontier_destroy(frontier);
+  free(samples);
+  free(only);
+  return 0;
+}
@@ -0,0 +1,160 @@
+"""Client of the query server of the Pthreads implementation (-m server).
+
+The protocol is described in src/server.h. Example:
+
+  ./bin/bfs -G kron:scale=20 -m server -S /tmp/bfs.sock &
+  python3 scripts/bfs_client.py /tmp/bfs.sock -s 1 2 3
+  python3 scripts/bfs_client.py /tmp/bfs.sock -m khop -k 2 -n 1000 -r 8
+"""
+import argparse
+import random
+import socket
+import struct
+import time
+from array import array
+from collections import deque
+from typing import Deque, Dict, List, NamedTuple, Optional
+
+SERVER_MAGIC = 0x53534642
+SERVER_VERSION = 1
+MODES = {'distances': 0, 'parents': 1, 'khop': 2}
+STATUSES = {0: 'ok', 1: 'bad_source', 2: 'bad_request'}
+
+# Native byte order and alignment, as the server writes its structs
+HELLO = struct.Struct('=4I')
+REQUEST = struct.Struct('=5I')
+RESULT = struct.Struct('=6IQ')
+
+
+class Result(NamedTuple):
+  request_id: int
+  query: int
+  source: int
+  status: str
+  levels: int
+  elapsed_ns: int
+  values: array            # Distances or parents, or k-hop IDs
+  depths: Optional[array]  # k-hop distances
+
+
+class BfsClient:
+  def __init__(self, path: str):
+    self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    self.sock.connect(path)
+    magic, version, self.num_vertices, self.num_edges = HELLO.unpack(
+        self._read(HELLO.size))
+    if magic != SERVER_MAGIC or version != SERVER_VERSION:
+      raise RuntimeError(f'{path} is not a compatible BFS server')
+    self.next_request_id = 0
+    self.modes: Dict[int, str] = {}
+    # Results of other requests read by query, returned first by receive
+    self.pending: Deque[Result] = deque()
+
+  def _read(self, size: int) -> bytes:
+    data = bytearray()
+    while len(data) < size:
+      chunk = self.sock.recv(size - len(data))
+      if not chunk:
+        raise ConnectionError('The server closed the connection')
+      data += chunk
+    return bytes(data)
+
+  def _read_values(self, count: int) -> array:
+    values = array('I')
+    values.frombytes(self._read(count * values.itemsize))
+    return values
+
+  def send(self, sources: List[int], mode: str = 'distances',
+           max_depth: int = 1) -> int:
+    """Sends a request without waiting for its results; returns its ID."""
+    request_id = self.next_request_id
+    self.next_request_id += 1
+    self.modes[request_id] = mode
+    header = REQUEST.pack(SERVER_MAGIC, request_id, MODES[mode], max_depth,
+                          len(sources))
+    self.sock.sendall(header + array('I', sources).tobytes())
+    return request_id
+
+  def receive(self) -> Result:
+    """Returns the next result, of any request sent so far."""
+    if self.pending:
+      return self.pending.popleft()
+    return self._read_result()
+
+  def _read_result(self) -> Result:
+    request_id, query, source, status, count, levels, elapsed_ns = \
+        RESULT.unpack(self._read(RESULT.size))
+    values = self._read_values(count)
+    depths = None
+    if self.modes.get(request_id) == 'khop':
+      depths = self._read_values(count)
+    return Result(request_id, query, source, STATUSES.get(status, 'unknown'),
+                  levels, elapsed_ns, values, depths)
+
+  def query(self, sources: List[int], mode: str = 'distances',
+            max_depth: int = 1) -> List[Result]:
+    """Sends a request and returns its results, in the order of `sources`.
+
+    Results of other requests still in flight are kept for receive.
+    """
+    request_id = self.send(sources, mode, max_depth)
+    results: Dict[int, Result] = {}
+    while len(results) < len(sources):
+      result = self._read_result()
+      if result.request_id != request_id:
+        self.pending.append(result)
+        continue
+      if result.status == 'bad_request':
+        raise RuntimeError('The server rejected the request')
+      results[result.query] = result
+    return [results[i] for i in range(len(sources))]
+
+  def close(self):
+    self.sock.close()
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+  parser.add_argument('socket', help='Unix domain socket of the server')
+  parser.add_argument('-m', '--mode', choices=MODES.keys(),
+                      default='distances')
+  parser.add_argument('-k', '--depth', type=int, default=1,
+                      help='Maximum depth of the khop queries')
+  parser.add_argument('-s', '--sources', type=int, nargs='+',
+                      help='Source vertices of the request')
+  parser.add_argument('-n', '--random', type=int, default=1,
+                      help='Random sources per request, without --sources')
+  parser.add_argument('-r', '--requests', type=int, default=1,
+                      help='Requests sent before reading the results')
+  parser.add_argument('-q', '--quiet', action='store_true',
+                      help='Only print the summary')
+  args = parser.parse_args()
+
+  client = BfsClient(args.socket)
+  rng = random.Random(27491095)
+  start = time.perf_counter()
+  expected = 0
+  for _ in range(args.requests):
+    sources = args.sources or [rng.randrange(client.num_vertices)
+                               for _ in range(args.random)]
+    client.send(sources, args.mode, args.depth)
+    expected += len(sources)
+  for _ in range(expected):
+    result = client.receive()
+    if result.status == 'bad_request':
+      raise RuntimeError('The server rejected the request')
+    if not args.quiet:
+      reached = len(result.values)
+      if args.mode != 'khop':
+        reached = sum(1 for v in result.values if v != 0xFFFFFFFF)
+      print(f'request_id={result.request_id},query={result.query},'
+            f'source={result.source},status={result.status},'
+            f'reached={reached},levels={result.levels},'
+            f'{result.elapsed_ns * 1e-9:.6f}')
+  elapsed = time.perf_counter() - start
+  print(f'queries={expected},qps={expected / elapsed:.2f},{elapsed:.4f}')
+  client.close()
+
+
+if __name__ == '__main__':
+  main()
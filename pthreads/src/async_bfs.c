@@ -0,0 +1,152 @@
+#include "async_bfs.h"
+#include "barrier.h"
+#include "frontier.h"
+#include "merged_csr.h"
+#include "thread_pool.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+static MergedCSR *async_csr;
+static Frontier *async_frontier;
+static Barrier async_barrier;
+static uint32_t *async_distances;
+
+// Published chunks that have not been taken, plus taken chunks whose output is
+// still in the private chunk of a thread. Zero means the traversal is over.
+static atomic_long pending_chunks;
+static uint64_t async_updates[MAX_THREADS];
+
+/**
+ * Relaxes the neighbors of the vertices of `c`, collecting the improved ones
+ * in the private chunk `out` and publishing it whenever it is full.
+ */
+static void relax_chunk(Chunk *c, Chunk *out, uint64_t *updates,
+                        int thread_id) {
+  mer_t v = VERT_MAX;
+  while ((v = chunk_pop_vertex(c)) != VERT_MAX) {
+    // The distance may have improved since v was published
+    mer_t distance =
+        __atomic_load_n(&DISTANCE(async_csr, v), __ATOMIC_RELAXED) + 1;
+    mer_t end = v + METADATA_SIZE + DEGREE(async_csr, v);
+    for (mer_t i = v + METADATA_SIZE; i < end; i++) {
+      mer_t neighbor = async_csr->merged[i];
+      mer_t old =
+          __atomic_load_n(&DISTANCE(async_csr, neighbor), __ATOMIC_RELAXED);
+      while (distance < old) {
+        if (__atomic_compare_exchange_n(&DISTANCE(async_csr, neighbor), &old,
+                                        distance, false, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) {
+          (*updates)++;
+          // A vertex with a single neighbor cannot improve it
+          if (DEGREE(async_csr, neighbor) != 1) {
+            if (out->next_free_index >= CHUNK_SIZE) {
+              atomic_fetch_add(&pending_chunks, 1);
+              frontier_publish_chunk(async_frontier, thread_id, out);
+              out->next_free_index = 0;
+            }
+            chunk_push_vertex(out, neighbor);
+          }
+          break;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Takes a chunk from this thread's pool or, if it is empty, from the pool of
+ * another thread.
+ */
+static bool take_chunk(Chunk *c, int thread_id) {
+  for (int k = 0; k < MAX_THREADS; k++) {
+    int i = (thread_id + k) % MAX_THREADS;
+    if (async_frontier->thread_chunk_counts[i] > 0 &&
+        frontier_take_chunk(async_frontier, i, c)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void notify_parent(void *arg) {
+  (void)arg;
+  thread_pool_notify_parent(&tp);
+}
+
+static void *async_thread_main(void *arg) {
+  int thread_id = *(int *)arg;
+  Chunk work, out;
+  out.next_free_index = 0;
+  uint64_t updates = 0;
+  // Taken chunks whose output is (partly) in `out`: they keep counting as
+  // pending until `out` is published
+  long owed = 0;
+
+  while (true) {
+    if (take_chunk(&work, thread_id)) {
+      relax_chunk(&work, &out, &updates, thread_id);
+      owed++;
+      continue;
+    }
+    // No work available: make the private output visible before settling
+    if (out.next_free_index > 0) {
+      atomic_fetch_add(&pending_chunks, 1);
+      frontier_publish_chunk(async_frontier, thread_id, &out);
+      out.next_free_index = 0;
+    }
+    if (owed > 0) {
+      atomic_fetch_sub(&pending_chunks, owed);
+      owed = 0;
+    } else if (atomic_load(&pending_chunks) == 0) {
+      break;
+    }
+  }
+
+  async_updates[thread_id] = updates;
+
+  // Write distances to the output array and reset them
+  mer_t chunk_size = async_csr->num_vertices / MAX_THREADS;
+  mer_t start = thread_id * chunk_size;
+  mer_t end = (thread_id == MAX_THREADS - 1) ? async_csr->num_vertices
+                                             : (thread_id + 1) * chunk_size;
+  for (mer_t i = start; i < end; i++) {
+    async_distances[i] = DISTANCE(async_csr, async_csr->row_ptr[i]);
+    DISTANCE(async_csr, async_csr->row_ptr[i]) = UINT32_MAX;
+  }
+  barrier_wait(&async_barrier, notify_parent, NULL);
+  return NULL;
+}
+
+void initialize_async_bfs(const mmio_csr_u32_f32_t *graph) {
+  async_csr = to_merged_csr(graph);
+  async_frontier = frontier_create();
+  barrier_init(&async_barrier);
+  init_thread_pool(&tp, async_thread_main);
+  thread_pool_create(&tp);
+}
+
+uint64_t async_bfs(uint32_t source, uint32_t *distances) {
+  mer_t v = async_csr->row_ptr[source];
+  DISTANCE(async_csr, v) = 0;
+  Chunk c;
+  c.next_free_index = 0;
+  chunk_push_vertex(&c, v);
+  frontier_publish_chunk(async_frontier, 0, &c);
+  pending_chunks = 1;
+  async_distances = distances;
+  atomic_thread_fence(memory_order_seq_cst);
+  thread_pool_start_wait(&tp);
+  uint64_t updates = 1;
+  for (int i = 0; i < MAX_THREADS; i++) {
+    updates += async_updates[i];
+  }
+  return updates;
+}
+
+void destroy_async_bfs() {
+  thread_pool_terminate(&tp);
+  destroy_thread_pool(&tp);
+  frontier_destroy(async_frontier);
+  destroy_merged_csr(async_csr);
+}
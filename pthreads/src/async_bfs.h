@@ -0,0 +1,40 @@
+#ifndef ASYNC_BFS_H
+#define ASYNC_BFS_H
+
+/**
+ * @brief Asynchronous (barrier-free) label-correcting BFS.
+ *
+ * There are no levels: threads keep taking chunks (their own first, then from
+ * the other threads) and lower the DISTANCE of the neighbors with an atomic
+ * minimum, publishing the improved vertices in new chunks. A vertex can be
+ * improved more than once, but on graphs with thousands of levels this costs
+ * less than the barrier at the end of every level.
+ *
+ * Chunks are exchanged by copy (frontier_publish_chunk and
+ * frontier_take_chunk), since the pools are produced and consumed at the same
+ * time. Termination is detected with a count of the outstanding chunks:
+ * published chunks plus taken chunks whose output has not been published yet.
+ */
+
+#include "mmio_c_wrapper.h"
+#include <stdint.h>
+
+/**
+ * Builds the merged CSR and the chunk pools and starts the thread pool with
+ * the asynchronous worker routine.
+ */
+void initialize_async_bfs(const mmio_csr_u32_f32_t *graph);
+
+/**
+ * Computes the distances from `source` into `distances`. Returns the number
+ * of distance updates (the number of reached vertices for a level-synchronous
+ * BFS, more when vertices are corrected).
+ */
+uint64_t async_bfs(uint32_t source, uint32_t *distances);
+
+/**
+ * Stops the thread pool and frees the asynchronous BFS data structures.
+ */
+void destroy_async_bfs();
+
+#endif // ASYNC_BFS_H
@@ -0,0 +1,23 @@
+#include "barrier.h"
+#include <stddef.h>
+
+void barrier_init(Barrier *b) {
+  atomic_store(&b->remaining, MAX_THREADS);
+  atomic_store(&b->generation, 0);
+}
+
+void barrier_wait(Barrier *b, void (*serial)(void *), void *arg) {
+  // Read the generation before arriving, the barrier cannot open again until
+  // this thread has decremented the counter
+  unsigned generation = atomic_load(&b->generation);
+  if (atomic_fetch_sub(&b->remaining, 1) == 1) {
+    if (serial != NULL) {
+      serial(arg);
+    }
+    atomic_store(&b->remaining, MAX_THREADS);
+    atomic_fetch_add(&b->generation, 1);
+  } else {
+    while (atomic_load(&b->generation) == generation)
+      ;
+  }
+}
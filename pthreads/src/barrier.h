@@ -0,0 +1,34 @@
+#ifndef BARRIER_H
+#define BARRIER_H
+
+/**
+ * @brief Lightweight spinning barrier for the MAX_THREADS worker threads.
+ *
+ * Generalizes the level barrier used in `thread_main`: threads decrement a
+ * shared counter and spin until the last thread to arrive releases them. The
+ * last thread can run a serial section (e.g. swapping frontiers) before the
+ * others are released. The barrier is reusable: a generation counter
+ * distinguishes consecutive phases.
+ */
+
+#include "config.h"
+#include <stdatomic.h>
+
+typedef struct {
+  atomic_int remaining;    // Threads that still have to arrive
+  atomic_uint generation;  // Incremented every time the barrier opens
+} Barrier;
+
+/**
+ * Initializes a barrier for MAX_THREADS threads.
+ */
+void barrier_init(Barrier *b);
+
+/**
+ * Blocks until all MAX_THREADS threads have called barrier_wait. The last
+ * thread to arrive runs `serial(arg)` (if `serial` is not NULL) before the
+ * other threads are released.
+ */
+void barrier_wait(Barrier *b, void (*serial)(void *), void *arg);
+
+#endif // BARRIER_H
@@ -0,0 +1,311 @@
+#include "bc.h"
+#include "barrier.h"
+#include "frontier.h"
+#include "thread_pool.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static MergedCSR *bc_csr;
+static Frontier *bc_f1, *bc_f2;
+static Barrier bc_barrier;
+static float *bc_scores;
+
+// Vertices discovered by each thread, level after level. The slice of level d
+// logged by thread t is [level_starts[d][t], level_starts[d + 1][t]).
+static VertexLog bc_logs[MAX_THREADS];
+static uint32_t (*level_starts)[MAX_THREADS];
+static uint32_t level_starts_capacity;
+// Next unclaimed position of each thread's slice in the current phase
+static atomic_uint bc_cursors[MAX_THREADS];
+static uint32_t bc_phase_level;
+
+static volatile bool bc_exploration_done;
+static volatile uint32_t bc_level;
+
+static inline double get_sigma(mer_t v) {
+  double sigma;
+  memcpy(&sigma, BC_SIGMA(bc_csr, v), sizeof(double));
+  return sigma;
+}
+
+static inline void set_sigma(mer_t v, double sigma) {
+  memcpy(BC_SIGMA(bc_csr, v), &sigma, sizeof(double));
+}
+
+static inline float get_delta(mer_t v) {
+  float delta;
+  memcpy(&delta, BC_DELTA(bc_csr, v), sizeof(float));
+  return delta;
+}
+
+static inline void set_delta(mer_t v, float delta) {
+  memcpy(BC_DELTA(bc_csr, v), &delta, sizeof(float));
+}
+
+MergedCSR *to_bc_merged_csr(const mmio_csr_u32_f32_t *graph) {
+  MergedCSR *merged_csr = (MergedCSR *)malloc(sizeof(MergedCSR));
+
+  merged_csr->num_edges = graph->nnz;
+  merged_csr->num_vertices = graph->nrows;
+  merged_csr->row_ptr =
+      (mer_t *)malloc((merged_csr->num_vertices + 1) * sizeof(mer_t));
+  merged_csr->merged =
+      (mer_t *)malloc(((uint64_t)merged_csr->num_edges +
+                       (uint64_t)merged_csr->num_vertices * BC_METADATA_SIZE) *
+                      sizeof(mer_t));
+
+  for (mer_t i = 0; i < merged_csr->num_vertices; i++) {
+    mer_t merged_pos = graph->row_ptr[i] + i * BC_METADATA_SIZE;
+    DEGREE(merged_csr, merged_pos) = graph->row_ptr[i + 1] - graph->row_ptr[i];
+    DISTANCE(merged_csr, merged_pos) = UINT32_MAX;
+    ID(merged_csr, merged_pos) = i;
+    double sigma = 0;
+    float delta = 0;
+    memcpy(BC_SIGMA(merged_csr, merged_pos), &sigma, sizeof(double));
+    memcpy(BC_DELTA(merged_csr, merged_pos), &delta, sizeof(float));
+    merged_pos += BC_METADATA_SIZE;
+    for (mer_t j = graph->row_ptr[i]; j < graph->row_ptr[i + 1];
+         j++, merged_pos++) {
+      merged_csr->merged[merged_pos] =
+          graph->row_ptr[graph->col_idx[j]] +
+          graph->col_idx[j] * BC_METADATA_SIZE;
+    }
+  }
+  for (mer_t i = 0; i < merged_csr->num_vertices + 1; i++) {
+    merged_csr->row_ptr[i] = graph->row_ptr[i] + i * BC_METADATA_SIZE;
+  }
+  return merged_csr;
+}
+
+/**
+ * Discovers the unvisited neighbors of the vertices of a chunk. Every vertex
+ * is pushed to the next frontier (even those with a single neighbor, since
+ * they need sigma and delta) and logged by the thread that discovered it.
+ */
+static void expand_chunk(Chunk *c, Chunk **dest, int thread_id) {
+  uint32_t next_level = bc_level + 1;
+  mer_t v = VERT_MAX;
+  while ((v = chunk_pop_vertex(c)) != VERT_MAX) {
+    mer_t end = v + BC_METADATA_SIZE + DEGREE(bc_csr, v);
+    for (mer_t i = v + BC_METADATA_SIZE; i < end; i++) {
+      mer_t neighbor = bc_csr->merged[i];
+      mer_t expected = UINT32_MAX;
+      if (DISTANCE(bc_csr, neighbor) == UINT32_MAX &&
+          __atomic_compare_exchange_n(&DISTANCE(bc_csr, neighbor), &expected,
+                                      next_level, false, __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED)) {
+        if (*dest == NULL || (*dest)->next_free_index >= CHUNK_SIZE) {
+          *dest = frontier_create_chunk(bc_f2, thread_id);
+        }
+        chunk_push_vertex(*dest, neighbor);
+        vertex_log_push(&bc_logs[thread_id], neighbor);
+      }
+    }
+  }
+}
+
+/**
+ * Expands the current frontier: chunks of this thread first, then stealing
+ * from the other threads (same scheme as top_down in bfs.c).
+ */
+static void expand(int thread_id) {
+  Chunk *dest = NULL;
+  Chunk *c = NULL;
+  while ((c = frontier_remove_chunk(bc_f1, thread_id)) != NULL) {
+    expand_chunk(c, &dest, thread_id);
+  }
+  bool work_to_do = true;
+  while (work_to_do) {
+    work_to_do = false;
+    for (int i = 0; i < MAX_THREADS; i++) {
+      if (bc_f1->thread_chunks[i]->top_chunk > 1) {
+        work_to_do = true;
+        if ((c = frontier_remove_chunk(bc_f1, i)) != NULL) {
+          expand_chunk(c, &dest, thread_id);
+        }
+        i--;
+      }
+    }
+  }
+}
+
+/**
+ * Counts the shortest paths to a vertex discovered at `level` as the sum of
+ * the counts of its neighbors one level up.
+ */
+static void pull_sigma(mer_t v, uint32_t level) {
+  double sigma = 0;
+  mer_t end = v + BC_METADATA_SIZE + DEGREE(bc_csr, v);
+  for (mer_t i = v + BC_METADATA_SIZE; i < end; i++) {
+    mer_t neighbor = bc_csr->merged[i];
+    if (DISTANCE(bc_csr, neighbor) == level - 1) {
+      sigma += get_sigma(neighbor);
+    }
+  }
+  set_sigma(v, sigma);
+  set_delta(v, 0);
+}
+
+/**
+ * Computes the dependency of the source on a vertex at `level` from its
+ * children one level down, and adds it to the score of the vertex.
+ */
+static void pull_delta(mer_t v, uint32_t level) {
+  double sigma = get_sigma(v);
+  float delta = 0;
+  mer_t end = v + BC_METADATA_SIZE + DEGREE(bc_csr, v);
+  for (mer_t i = v + BC_METADATA_SIZE; i < end; i++) {
+    mer_t neighbor = bc_csr->merged[i];
+    if (DISTANCE(bc_csr, neighbor) == level + 1) {
+      delta += sigma / get_sigma(neighbor) * (1 + get_delta(neighbor));
+    }
+  }
+  set_delta(v, delta);
+  if (level > 0) {
+    bc_scores[ID(bc_csr, v)] += delta;
+  }
+}
+
+/**
+ * Applies `f` to all the vertices of `bc_phase_level`, claiming blocks of
+ * BC_BLOCK_SIZE vertices from this thread's slice first and then from the
+ * slices of the other threads.
+ */
+static void process_level(int thread_id, void (*f)(mer_t, uint32_t)) {
+  uint32_t level = bc_phase_level;
+  for (int k = 0; k < MAX_THREADS; k++) {
+    int t = (thread_id + k) % MAX_THREADS;
+    uint32_t end = level_starts[level + 1][t];
+    uint32_t start;
+    while ((start = atomic_fetch_add(&bc_cursors[t], BC_BLOCK_SIZE)) < end) {
+      uint32_t block_end =
+          start + BC_BLOCK_SIZE < end ? start + BC_BLOCK_SIZE : end;
+      for (uint32_t i = start; i < block_end; i++) {
+        f(bc_logs[t].vertices[i], level);
+      }
+    }
+  }
+}
+
+/**
+ * Points the cursors to the beginning of the slices of `*level`.
+ */
+static void start_phase(void *arg) {
+  bc_phase_level = *(uint32_t *)arg;
+  for (int t = 0; t < MAX_THREADS; t++) {
+    atomic_store(&bc_cursors[t], level_starts[bc_phase_level][t]);
+  }
+}
+
+/**
+ * Closes the level that has just been discovered and prepares the sigma
+ * phase over it.
+ */
+static void end_level(void *arg) {
+  (void)arg;
+  uint32_t next_level = bc_level + 1;
+  if (next_level + 1 >= level_starts_capacity) {
+    level_starts_capacity *= 2;
+    level_starts = realloc(level_starts,
+                           level_starts_capacity * sizeof(*level_starts));
+  }
+  for (int t = 0; t < MAX_THREADS; t++) {
+    level_starts[next_level + 1][t] = bc_logs[t].size;
+  }
+  start_phase(&next_level);
+}
+
+static void swap_frontiers(void *arg) {
+  (void)arg;
+  Frontier *temp = bc_f2;
+  bc_f2 = bc_f1;
+  bc_f1 = temp;
+  if (frontier_get_total_chunks(bc_f1) == 0) {
+    bc_exploration_done = true;
+  } else {
+    bc_level++;
+  }
+}
+
+static void notify_parent(void *arg) {
+  (void)arg;
+  thread_pool_notify_parent(&tp);
+}
+
+static void *bc_thread_main(void *arg) {
+  int thread_id = *(int *)arg;
+
+  // Forward phase: BFS, counting shortest paths level by level
+  while (true) {
+    expand(thread_id);
+    barrier_wait(&bc_barrier, end_level, NULL);
+    process_level(thread_id, pull_sigma);
+    barrier_wait(&bc_barrier, swap_frontiers, NULL);
+    if (bc_exploration_done) {
+      break;
+    }
+  }
+
+  // Backward phase: accumulate dependencies from the deepest level up
+  for (uint32_t level = bc_level + 1; level-- > 0;) {
+    barrier_wait(&bc_barrier, start_phase, &level);
+    process_level(thread_id, pull_delta);
+  }
+  barrier_wait(&bc_barrier, NULL, NULL);
+
+  // Reset the vertices discovered by this thread for the next source
+  for (uint32_t i = 0; i < bc_logs[thread_id].size; i++) {
+    DISTANCE(bc_csr, bc_logs[thread_id].vertices[i]) = UINT32_MAX;
+  }
+  bc_logs[thread_id].size = 0;
+  barrier_wait(&bc_barrier, notify_parent, NULL);
+  return NULL;
+}
+
+void initialize_bc(const mmio_csr_u32_f32_t *graph) {
+  bc_csr = to_bc_merged_csr(graph);
+  bc_f1 = frontier_create();
+  bc_f2 = frontier_create();
+  for (int t = 0; t < MAX_THREADS; t++) {
+    vertex_log_init(&bc_logs[t]);
+  }
+  level_starts_capacity = 64;
+  level_starts = malloc(level_starts_capacity * sizeof(*level_starts));
+  barrier_init(&bc_barrier);
+  init_thread_pool(&tp, bc_thread_main);
+  thread_pool_create(&tp);
+}
+
+uint32_t bc(uint32_t source, float *scores) {
+  mer_t v = bc_csr->row_ptr[source];
+  DISTANCE(bc_csr, v) = 0;
+  set_sigma(v, 1);
+  set_delta(v, 0);
+  chunk_push_vertex(frontier_create_chunk(bc_f1, 0), v);
+  // The source is the only vertex of level 0, logged by thread 0
+  vertex_log_push(&bc_logs[0], v);
+  for (int t = 0; t < MAX_THREADS; t++) {
+    level_starts[0][t] = 0;
+    level_starts[1][t] = bc_logs[t].size;
+  }
+  bc_scores = scores;
+  bc_level = 0;
+  bc_exploration_done = false;
+  atomic_thread_fence(memory_order_seq_cst);
+  thread_pool_start_wait(&tp);
+  return bc_level;
+}
+
+void destroy_bc() {
+  thread_pool_terminate(&tp);
+  destroy_thread_pool(&tp);
+  frontier_destroy(bc_f1);
+  frontier_destroy(bc_f2);
+  for (int t = 0; t < MAX_THREADS; t++) {
+    vertex_log_destroy(&bc_logs[t]);
+  }
+  free(level_starts);
+  destroy_merged_csr(bc_csr);
+}
@@ -0,0 +1,60 @@
+#ifndef BC_H
+#define BC_H
+
+/**
+ * @brief Brandes betweenness centrality on the BFS engine.
+ *
+ * Every source runs a level-synchronous BFS with the chunked per-thread
+ * Frontier and work stealing, followed by a backward sweep that accumulates
+ * the dependencies from the deepest level up to the source.
+ *
+ * The merged CSR is extended with two metadata slots after the usual degree,
+ * distance and ID: the number of shortest paths from the source (sigma, a
+ * double spanning two words) and the dependency of the source on the vertex
+ * (delta, a float). Both are pulled from the neighbors of a vertex, so no
+ * floating point atomics are needed: sigma right after the vertex has been
+ * discovered, delta during the backward sweep. This relies on the graph being
+ * symmetric, as for the BFS.
+ *
+ * The vertices discovered at each level are logged by the thread that
+ * discovered them, so the backward sweep can walk the levels in reverse.
+ * Level slices are processed in blocks of BC_BLOCK_SIZE vertices, each thread
+ * starting from its own slice and then stealing blocks from the others.
+ */
+
+#include "config.h"
+#include "merged_csr.h"
+#include "mmio_c_wrapper.h"
+#include <stdint.h>
+
+#define BC_METADATA_SIZE 6
+// DEGREE, DISTANCE and ID are at the same positions as in MergedCSR
+#define BC_SIGMA(mer, i) (&mer->merged[i + 3]) // double, two words
+#define BC_DELTA(mer, i) (&mer->merged[i + 5]) // float
+
+/**
+ * Converts the CSR graph into the merged layout used by betweenness
+ * centrality, with all vertices unvisited.
+ */
+MergedCSR *to_bc_merged_csr(const mmio_csr_u32_f32_t *graph);
+
+/**
+ * Builds the BC data structures and starts the thread pool with the BC worker
+ * routine.
+ */
+void initialize_bc(const mmio_csr_u32_f32_t *graph);
+
+/**
+ * Adds the dependencies of `source` on every other vertex to `scores`
+ * (indexed by vertex ID), i.e. runs one iteration of Brandes' algorithm.
+ * Summing over sampled sources approximates the centrality. Returns the depth
+ * of the BFS tree.
+ */
+uint32_t bc(uint32_t source, float *scores);
+
+/**
+ * Stops the thread pool and frees the BC data structures.
+ */
+void destroy_bc();
+
+#endif // BC_H
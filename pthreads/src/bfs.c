@@ -1,12 +1,14 @@
 #define _GNU_SOURCE
-#include "cli_parser.h"
+#include "bfs.h"
 #include "config.h"
-#include "debug_utils.h"
 #include "frontier.h"
+#include "instrument.h"
 #include "merged_csr.h"
-#include "mmio_c_wrapper.h"
-#include "mt19937-64.h"
+#include "perf_counters.h"
+#include "shared_graph.h"
 #include "thread_pool.h"
+#include "trace.h"
+#include "utils.h"
 #include <assert.h>
 #include <pthread.h>
 #include <stdatomic.h>
@@ -14,13 +16,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
-#ifdef USE_PAPI
-#include "papi.h"
-#endif
 
 MergedCSR *merged_csr;
 Frontier *f1, *f2;
+// Pipelined levels: finished threads expand completed chunks of f2 into f3
+// while the others are still on the current level
+Frontier *f3;
 uint32_t *distances;
 
 atomic_int active_threads;
@@ -29,19 +30,120 @@ volatile uint32_t exploration_done;
 volatile int distance;
 
 int max_chunks;
+bool reorder_frontier;
+bool pipeline_levels;
+atomic_int finished_level[MAX_THREADS];
+atomic_int early_workers;
+atomic_bool swapping;
+bool compute_parents;
+
+// Depth-bounded (k-hop) traversals stop after max_depth levels and log the
+// vertices they touch, so that only those are written out and reset
+uint32_t max_depth = UINT32_MAX;
+VertexLog touched[MAX_THREADS];
+uint32_t *touched_ids;
+uint32_t *touched_distances;
+
+// Farthest vertex reached by each thread's share of the vertices, tracked
+// while the distances are written out (used by the diameter mode)
+uint32_t farthest_distance[MAX_THREADS];
+uint32_t farthest_vertex[MAX_THREADS];
 
 thread_pool_t tp;
 
-void top_down_chunk(MergedCSR *merged_csr, Frontier *next, Chunk *c,
-                    Chunk **dest, int distance, int thread_id) {
-  assert(c != NULL && "Chunk passed to top_down_chunk is NULL!");
+// Per-process visit state (distance or parent of each vertex ID) when the
+// merged CSR is shared read-only between processes, NULL otherwise
+mer_t *visit_state;
+
+// Visit state of the vertex at merged offset v: its DISTANCE slot, or its
+// entry of `state` (visit_state) for a shared merged CSR. The hot loops get
+// `state` as a parameter of always-inlined helpers called with a constant
+// NULL for the private merged CSR, so that case compiles to plain DISTANCE
+// accesses.
+#define VISIT(state, v)                                                        \
+  (*((state) != NULL ? &(state)[ID(merged_csr, v)] : &DISTANCE(merged_csr, v)))
+
+/**
+ * Top-down step for pipelined levels. A vertex can be reached early from the
+ * next level and later from the current one, so distances are lowered with an
+ * atomic minimum; vertices improved after being pushed are stale and skipped,
+ * since they have been pushed again at their right level.
+ */
+static inline __attribute__((always_inline)) void
+expand_chunk_pipelined(MergedCSR *merged_csr, Frontier *next, Chunk *c,
+                       Chunk **dest, int distance, int thread_id,
+                       mer_t *state) {
+  INSTRUMENT_ONLY(uint64_t vertices = 0; uint64_t edges = 0;)
+  mer_t v = VERT_MAX;
+  while ((v = chunk_pop_vertex(c)) != VERT_MAX) {
+    if (__atomic_load_n(&VISIT(state, v), __ATOMIC_RELAXED) !=
+        (mer_t)distance - 1) {
+      continue;
+    }
+    INSTRUMENT_ONLY(vertices++; edges += DEGREE(merged_csr, v);)
+    mer_t end = v + DEGREE(merged_csr, v) + METADATA_SIZE;
+    for (mer_t i = v + METADATA_SIZE; i < end; i++) {
+      mer_t neighbor = merged_csr->merged[i];
+      mer_t old =
+          __atomic_load_n(&VISIT(state, neighbor), __ATOMIC_RELAXED);
+      while ((mer_t)distance < old) {
+        if (__atomic_compare_exchange_n(&VISIT(state, neighbor), &old,
+                                        distance, false, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) {
+          if (DEGREE(merged_csr, neighbor) != 1) {
+            if (*dest == NULL || (*dest)->next_free_index >= CHUNK_SIZE) {
+              *dest = frontier_create_chunk(next, thread_id);
+            }
+            chunk_push_vertex(*dest, neighbor);
+          }
+          break;
+        }
+      }
+    }
+  }
+  INSTRUMENT_ONLY(LevelStats *stats = instrument_level(thread_id, distance - 1);
+                  stats->vertices += vertices; stats->edges += edges;)
+}
+
+void top_down_chunk_pipelined(MergedCSR *merged_csr, Frontier *next, Chunk *c,
+                              Chunk **dest, int distance, int thread_id) {
+  if (visit_state != NULL) {
+    expand_chunk_pipelined(merged_csr, next, c, dest, distance, thread_id,
+                           visit_state);
+  } else {
+    expand_chunk_pipelined(merged_csr, next, c, dest, distance, thread_id,
+                           NULL);
+  }
+}
+
+static inline __attribute__((always_inline)) void
+expand_chunk(MergedCSR *merged_csr, Frontier *next, Chunk *c, Chunk **dest,
+             int distance, int thread_id, mer_t *state) {
+  INSTRUMENT_ONLY(uint64_t edges = 0;)
   mer_t v = VERT_MAX;
   while ((v = chunk_pop_vertex(c)) != VERT_MAX) {
+    // In parents mode the slot of the discovered vertices gets the ID of the
+    // vertex that discovered them, which is in the same cache line as its
+    // degree: no extra memory access compared to distances
+    mer_t label = compute_parents ? ID(merged_csr, v) : (mer_t)distance;
+    INSTRUMENT_ONLY(edges += DEGREE(merged_csr, v);)
     mer_t end = v + DEGREE(merged_csr, v) + METADATA_SIZE;
     for (mer_t i = v + METADATA_SIZE; i < end; i++) {
       mer_t neighbor = merged_csr->merged[i];
-      if (DISTANCE(merged_csr, neighbor) == UINT32_MAX) {
-        DISTANCE(merged_csr, neighbor) = distance;
+      if (VISIT(state, neighbor) == UINT32_MAX) {
+        if (max_depth != UINT32_MAX) {
+          // The touched vertices must be logged exactly once: claim the
+          // vertex, so that only one of the threads reaching it logs it
+          mer_t expected = UINT32_MAX;
+          if (!__atomic_compare_exchange_n(&VISIT(state, neighbor), &expected,
+                                           label, false, __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED)) {
+            continue;
+          }
+          vertex_log_push(&touched[thread_id], neighbor);
+        } else {
+          VISIT(state, neighbor) = label;
+        }
         if (DEGREE(merged_csr, neighbor) != 1) {
           if (*dest == NULL || (*dest)->next_free_index >= CHUNK_SIZE) {
             *dest = frontier_create_chunk(next, thread_id);
@@ -51,6 +153,26 @@ void top_down_chunk(MergedCSR *merged_csr, Frontier *next, Chunk *c,
       }
     }
   }
+  INSTRUMENT_ONLY(instrument_level(thread_id, distance - 1)->edges += edges;)
+}
+
+void top_down_chunk(MergedCSR *merged_csr, Frontier *next, Chunk *c,
+                    Chunk **dest, int distance, int thread_id) {
+  assert(c != NULL && "Chunk passed to top_down_chunk is NULL!");
+  INSTRUMENT_ONLY(LevelStats *stats = instrument_level(thread_id, distance - 1);
+                  uint64_t start = monotonic_ns();)
+  if (pipeline_levels) {
+    top_down_chunk_pipelined(merged_csr, next, c, dest, distance, thread_id);
+    INSTRUMENT_ONLY(stats->processing_ns += monotonic_ns() - start;)
+    return;
+  }
+  INSTRUMENT_ONLY(stats->vertices += c->next_free_index;)
+  if (visit_state != NULL) {
+    expand_chunk(merged_csr, next, c, dest, distance, thread_id, visit_state);
+  } else {
+    expand_chunk(merged_csr, next, c, dest, distance, thread_id, NULL);
+  }
+  INSTRUMENT_ONLY(stats->processing_ns += monotonic_ns() - start;)
 }
 
 void top_down(MergedCSR *merged_csr, Frontier *current_frontier,
@@ -58,10 +180,19 @@ void top_down(MergedCSR *merged_csr, Frontier *current_frontier,
   Chunk *c = NULL;
   Chunk *next_chunk = NULL;
   Chunk **dest = &next_chunk;
+  INSTRUMENT_ONLY(LevelStats *stats = instrument_level(thread_id, distance - 1);)
   // Run top-down step for all chunks belonging to the thread
   while ((c = frontier_remove_chunk(current_frontier, thread_id)) != NULL) {
+    INSTRUMENT_ONLY(stats->own_chunks++;)
+    TRACE_ONLY(uint64_t trace_start = monotonic_ns();
+               uint32_t trace_vertices = c->next_free_index;)
     top_down_chunk(merged_csr, next_frontier, c, dest, distance, thread_id);
+    TRACE_ONLY(trace_event(thread_id, TRACE_CHUNK, distance - 1,
+                           trace_vertices, trace_start);)
   }
+  // Time spent in the stealing loop, minus the time expanding stolen chunks
+  INSTRUMENT_ONLY(uint64_t steal_start = monotonic_ns();
+                  uint64_t steal_processing = stats->processing_ns;)
   // Work stealing from other threads when finished processing chunks of this
   // thread
   bool work_to_do = true;
@@ -76,53 +207,237 @@ void top_down(MergedCSR *merged_csr, Frontier *current_frontier,
       if (current_frontier->thread_chunks[i]->top_chunk > 1) {
         work_to_do = 1;
         if ((c = frontier_remove_chunk(current_frontier, i)) != NULL) {
+          INSTRUMENT_ONLY(stats->stolen_chunks++;)
+          TRACE_ONLY(uint64_t trace_start = monotonic_ns();)
           top_down_chunk(merged_csr, next_frontier, c, dest, distance,
                          thread_id);
+          TRACE_ONLY(trace_event(thread_id, TRACE_STOLEN_CHUNK, distance - 1,
+                                 i, trace_start);)
         }
         i--;
       }
     }
   }
+  INSTRUMENT_ONLY(stats->stealing_ns += monotonic_ns() - steal_start -
+                                        (stats->processing_ns -
+                                         steal_processing);)
 }
 
 void finalize_distances(MergedCSR *merged_csr, int thread_id) {
-  // Write distances from mergedCSR to distances array
+  // Write distances (or parents) from mergedCSR to distances array
   mer_t chunk_size = merged_csr->num_vertices / MAX_THREADS;
   mer_t start = thread_id * chunk_size;
   mer_t end = (thread_id == MAX_THREADS - 1) ? merged_csr->num_vertices
                                              : (thread_id + 1) * chunk_size;
+  uint32_t max_distance = 0, max_vertex = start;
   for (mer_t i = start; i < end; i++) {
-    distances[i] = DISTANCE(merged_csr, merged_csr->row_ptr[i]);
-    DISTANCE(merged_csr, merged_csr->row_ptr[i]) = UINT32_MAX;
+    distances[i] = VISIT(visit_state, merged_csr->row_ptr[i]);
+    VISIT(visit_state, merged_csr->row_ptr[i]) = UINT32_MAX;
+    if (distances[i] != UINT32_MAX && distances[i] > max_distance) {
+      max_distance = distances[i];
+      max_vertex = i;
+    }
+  }
+  farthest_distance[thread_id] = max_distance;
+  farthest_vertex[thread_id] = max_vertex;
+}
+
+void finalize_touched(MergedCSR *merged_csr, int thread_id) {
+  // Write the vertices touched by this thread after the ones of the previous
+  // threads; the logs do not change anymore once the exploration is done
+  uint32_t offset = 0;
+  for (int i = 0; i < thread_id; i++) {
+    offset += touched[i].size;
+  }
+  VertexLog *log = &touched[thread_id];
+  for (uint32_t i = 0; i < log->size; i++) {
+    mer_t v = log->vertices[i];
+    touched_ids[offset + i] = ID(merged_csr, v);
+    touched_distances[offset + i] = VISIT(visit_state, v);
+    VISIT(visit_state, v) = UINT32_MAX;
+  }
+}
+
+/**
+ * Cost model for the locality-sorted frontier: sorting pays off only when the
+ * next frontier is dense enough that, once sorted, consecutive vertices are
+ * close in the merged CSR. The total frontier size is estimated from the
+ * thread's share, since threads produce roughly the same amount of work.
+ */
+static bool should_reorder(MergedCSR *merged_csr, int thread_vertices) {
+  if (thread_vertices < REORDER_MIN_VERTICES) {
+    return false;
+  }
+  uint64_t merged_size = merged_csr->row_ptr[merged_csr->num_vertices];
+  uint64_t frontier_size = (uint64_t)thread_vertices * MAX_THREADS;
+  return merged_size <= frontier_size * REORDER_MAX_GAP;
+}
+
+/**
+ * Pipelined levels: while waiting for the other threads to finish the level
+ * labeled `label`, expands chunks of the next frontier produced by threads
+ * that have already finished it (their chunks are complete and no longer
+ * written). The output goes to f3, which becomes the next frontier after the
+ * swap. The handshake with swap_pipelined_frontiers guarantees that no chunk
+ * is being expanded while the frontiers rotate.
+ */
+static void expand_early(int label, int thread_id) {
+  Chunk *dest = NULL;
+  while (distance == label) {
+    for (int i = 0; i < MAX_THREADS; i++) {
+      if (atomic_load(&finished_level[i]) != label ||
+          f2->thread_chunks[i]->top_chunk == 0) {
+        continue;
+      }
+      atomic_fetch_add(&early_workers, 1);
+      if (atomic_load(&swapping) || distance != label) {
+        atomic_fetch_sub(&early_workers, 1);
+        return;
+      }
+      Chunk *c = frontier_remove_chunk(f2, i);
+      if (c != NULL) {
+        TRACE_ONLY(uint64_t trace_start = monotonic_ns();)
+        top_down_chunk(merged_csr, f3, c, &dest, label + 1, thread_id);
+        TRACE_ONLY(trace_event(thread_id, TRACE_EARLY_CHUNK, label, i,
+                               trace_start);)
+      }
+      atomic_fetch_sub(&early_workers, 1);
+    }
   }
 }
 
+/**
+ * Rotates the three frontiers once every thread has finished the level and
+ * no early expansion is in progress. The exploration is over only when both
+ * the new current frontier and the chunks expanded early are empty. Returns
+ * the chunks of the new current frontier.
+ */
+static int swap_pipelined_frontiers() {
+  atomic_store(&swapping, true);
+  while (atomic_load(&early_workers) > 0)
+    ;
+  Frontier *temp = f1;
+  f1 = f2;
+  f2 = f3;
+  f3 = temp;
+  int chunks = frontier_get_total_chunks(f1);
+  if (chunks == 0 && frontier_get_total_chunks(f2) == 0)
+    exploration_done = 1;
+  if (chunks > max_chunks)
+    max_chunks = chunks;
+  atomic_thread_fence(memory_order_seq_cst);
+  distance++;
+  // Cleared after the level changes, so that late early workers see either
+  // the flag or the new level
+  atomic_store(&swapping, false);
+  return chunks;
+}
+
+#ifdef INSTRUMENT
+/**
+ * Charges the level labeled `label` with the time spent waiting at its
+ * barrier since `wait_start` and with the lock contention seen during the
+ * level. `early_processing` is the processing time of the next level before
+ * the wait, which is subtracted again when levels are pipelined.
+ */
+static void instrument_barrier(int thread_id, int label, uint64_t wait_start,
+                               uint64_t early_processing) {
+  uint64_t wait = monotonic_ns() - wait_start;
+  if (pipeline_levels) {
+    wait -= instrument_level(thread_id, label)->processing_ns -
+            early_processing;
+  }
+  LevelStats *stats = instrument_level(thread_id, label - 1);
+  stats->barrier_ns += wait;
+  stats->contended += instrument_contended;
+  instrument_contended = 0;
+}
+#endif
+
 void *thread_main(void *arg) {
   int thread_id = *(int *)arg;
+  if (perf_enabled) {
+    perf_begin(thread_id, PERF_TRAVERSAL);
+  }
 
   while (!exploration_done) {
     int old = distance;
     top_down(merged_csr, f1, f2, distance, thread_id);
-    if (atomic_fetch_sub(&active_threads, 1) == 1) {
+    // The chunks produced by this thread are not visible to other threads
+    // until the frontiers are swapped, so they can be reordered here
+    if (reorder_frontier &&
+        should_reorder(merged_csr,
+                       frontier_get_thread_vertices(f2, thread_id))) {
+      frontier_sort_thread_chunks(f2, thread_id,
+                                  merged_csr->row_ptr[merged_csr->num_vertices]);
+    }
+    // Chunks expanded early count as processing of the next level, so their
+    // time is not part of the wait
+    INSTRUMENT_ONLY(uint64_t wait_start = monotonic_ns();
+                    uint64_t early_processing =
+                        pipeline_levels
+                            ? instrument_level(thread_id, old)->processing_ns
+                            : 0;)
+    TRACE_ONLY(uint64_t trace_wait_start = monotonic_ns();)
+    if (pipeline_levels) {
+      atomic_store(&finished_level[thread_id], old);
+      if (atomic_fetch_sub(&active_threads, 1) == 1) {
+        active_threads = MAX_THREADS;
+#ifdef TRACE
+        uint64_t trace_start = monotonic_ns();
+        int chunks = swap_pipelined_frontiers();
+        trace_event(thread_id, TRACE_SWAP, old - 1, chunks, trace_start);
+#else
+        swap_pipelined_frontiers();
+#endif
+      } else {
+        expand_early(old, thread_id);
+      }
+    } else if (atomic_fetch_sub(&active_threads, 1) == 1) {
       // Swap frontiers
       active_threads = MAX_THREADS;
+      TRACE_ONLY(uint64_t trace_start = monotonic_ns();)
       Frontier *temp = f2;
       f2 = f1;
       f1 = temp;
       int chunks = frontier_get_total_chunks(f1);
       if (chunks == 0)
         exploration_done = 1;
+      if ((uint32_t)distance >= max_depth) {
+        // Vertices at depth max_depth are not expanded
+        frontier_clear(f1);
+        exploration_done = 1;
+      }
       if (chunks > max_chunks)
         max_chunks = chunks;
       // printf("%u \n", distance);
       // print_chunk_counts(f1);
+      TRACE_ONLY(trace_event(thread_id, TRACE_SWAP, old - 1, chunks,
+                             trace_start);)
       atomic_thread_fence(memory_order_seq_cst);
       distance++;
     }
     while (distance == old)
       ;
+    TRACE_ONLY(
+        trace_event(thread_id, TRACE_BARRIER, old - 1, 0, trace_wait_start);)
+    INSTRUMENT_ONLY(
+        instrument_barrier(thread_id, old, wait_start, early_processing);)
+  }
+  if (perf_enabled) {
+    perf_end(thread_id, PERF_TRAVERSAL);
+    perf_begin(thread_id, PERF_FINALIZE);
+  }
+  TRACE_ONLY(uint64_t trace_start = monotonic_ns();)
+  if (max_depth != UINT32_MAX) {
+    finalize_touched(merged_csr, thread_id);
+  } else {
+    finalize_distances(merged_csr, thread_id);
+  }
+  TRACE_ONLY(trace_event(thread_id, TRACE_FINALIZE, 0, 0, trace_start);)
+  if (perf_enabled) {
+    perf_end(thread_id, PERF_FINALIZE);
   }
-  finalize_distances(merged_csr, thread_id);
 
   if (atomic_fetch_sub(&active_threads, 1) == 1) {
     // printf("Max distance: %u\n", distance);
@@ -131,132 +446,137 @@ void *thread_main(void *arg) {
   return NULL;
 }
 
-void initialize_bfs(const mmio_csr_u32_f32_t *graph) {
-  merged_csr = to_merged_csr(graph);
+static void start_engine() {
   f1 = frontier_create();
   f2 = frontier_create();
+  f3 = frontier_create();
+  for (int i = 0; i < MAX_THREADS; i++) {
+    vertex_log_init(&touched[i]);
+  }
   init_thread_pool(&tp, thread_main);
   thread_pool_create(&tp);
 }
 
+void initialize_bfs(const mmio_csr_u32_f32_t *graph) {
+  merged_csr = to_merged_csr(graph);
+  visit_state = NULL;
+  start_engine();
+}
+
+void initialize_bfs_shared(const SharedGraph *shared) {
+  // The engine never writes to the merged CSR when visit_state is set
+  merged_csr = (MergedCSR *)&shared->csr;
+  visit_state = (mer_t *)malloc(merged_csr->num_vertices * sizeof(mer_t));
+  memset(visit_state, UINT32_MAX, merged_csr->num_vertices * sizeof(mer_t));
+  start_engine();
+}
+
 void bfs(uint32_t source) {
   // Convert source vertex to mergedCSR index
+  mer_t source_id = source;
   source = merged_csr->row_ptr[source];
-  DISTANCE(merged_csr, source) = 0;
+  if (compute_parents) {
+    VISIT(visit_state, source) = source_id;
+  } else {
+    VISIT(visit_state, source) = 0;
+  }
   Chunk *c = frontier_create_chunk(f1, 0);
   chunk_push_vertex(c, source);
   exploration_done = 0;
   active_threads = MAX_THREADS;
+  for (int i = 0; i < MAX_THREADS; i++) {
+    finished_level[i] = 0;
+  }
+  early_workers = 0;
+  swapping = false;
   distance = 1;
   max_chunks = 0;
   atomic_thread_fence(memory_order_seq_cst);
   thread_pool_start_wait(&tp);
 }
 
-uint32_t *generate_sources(const mmio_csr_u32_f32_t *graph, int runs,
-                           uint32_t num_vertices, uint32_t source) {
-  uint32_t *sources = (uint32_t *)malloc(runs * sizeof(uint32_t));
-  if (source != UINT32_MAX) {
-    for (int i = 0; i < runs; i++) {
-      sources[i] = source;
-    }
-  } else {
-    init_genrand64(SEED);
-    for (int i = 0; i < runs; i++) {
-      do {
-        uint64_t gen = genrand64_int64();
-        sources[i] = (uint32_t)gen % num_vertices;
-      } while (graph->row_ptr[sources[i] + 1] - graph->row_ptr[sources[i]] ==
-               0);
-    }
+/**
+ * Runs a BFS from `source` that stops after `depth` levels. Writes the IDs of
+ * the reached vertices (source included) to `ids` and their distances to
+ * `depths`, in no particular order, and returns their number. Only the
+ * touched vertices are written and reset, so the cost is proportional to the
+ * size of the neighborhood.
+ */
+uint32_t bfs_bounded(uint32_t source, uint32_t depth, uint32_t *ids,
+                     uint32_t *depths) {
+  if (depth == 0) {
+    ids[0] = source;
+    depths[0] = 0;
+    return 1;
   }
-  return sources;
+  max_depth = depth;
+  touched_ids = ids;
+  touched_distances = depths;
+  vertex_log_push(&touched[0], merged_csr->row_ptr[source]);
+  bfs(source);
+  uint32_t count = 0;
+  for (int i = 0; i < MAX_THREADS; i++) {
+    count += touched[i].size;
+    touched[i].size = 0;
+  }
+  max_depth = UINT32_MAX;
+  return count;
 }
 
-typedef struct {
-  char *filename; // Will be allocated by the parser
-  int runs;
-  int source_id;
-  bool check;
-  bool output;
-} AppArgs;
-
-int main(int argc, char **argv) {
-  AppArgs args = {.filename = NULL,
-                  .runs = 1,
-                  .source_id = -1,
-                  .check = false,
-                  .output = true};
-  const CliOption options[] = {
-      {'f', "file", "Load graph from file", ARG_TYPE_STRING, &args.filename,
-       true},
-      {'n', "runs", "Number of runs", ARG_TYPE_INT, &args.runs, false},
-      {'s', "source", "ID of source vertex", ARG_TYPE_INT, &args.source_id,
-       false},
-      {'c', "check", "Checks BFS correctness", ARG_TYPE_BOOL, &args.check,
-       false}};
-  int num_options = sizeof(options) / sizeof(options[0]);
-  const char *app_description =
-      "An optimized BFS algorithm for large-diameter graphs.";
-  int parse_result =
-      cli_parse(argc, argv, options, num_options, app_description);
-
-  // Check the result: 0 is success, 1 means help was printed, -1 is an error.
-  if (parse_result != 0) {
-    if (args.filename)
-      free(args.filename);
-    return (parse_result == 1) ? 0 : 1;
+/**
+ * Runs a BFS from `source` and returns its eccentricity (the largest finite
+ * distance). The distances are left in `distances` and a vertex at that
+ * distance is written to `farthest`.
+ */
+uint32_t bfs_eccentricity(uint32_t source, uint32_t *farthest) {
+  bfs(source);
+  uint32_t eccentricity = 0;
+  *farthest = source;
+  for (int i = 0; i < MAX_THREADS; i++) {
+    if (farthest_distance[i] > eccentricity) {
+      eccentricity = farthest_distance[i];
+      *farthest = farthest_vertex[i];
+    }
   }
+  return eccentricity;
+}
 
-  mmio_csr_u32_f32_t *graph = mmio_read_csr_u32_f32(args.filename, false);
-  if (graph == NULL) {
-    printf("Failed to import graph from file [%s]\n", args.filename);
-    return -1;
+int bfs_memory_usage(MemoryItem *items) {
+  mer_t num_vertices = merged_csr->num_vertices;
+  uint64_t logs = 0;
+  for (int i = 0; i < MAX_THREADS; i++) {
+    logs += (uint64_t)touched[i].capacity * sizeof(ver_t);
   }
+  // A shared merged CSR is mapped by every attached process, but resident
+  // once per host
+  bool shared = visit_state != NULL;
+  items[0] = (MemoryItem){shared ? "shared_merged_csr" : "merged_csr",
+                          (uint64_t)merged_csr->row_ptr[num_vertices] *
+                              sizeof(mer_t)};
+  items[1] = (MemoryItem){shared ? "shared_merged_row_ptr" : "merged_row_ptr",
+                          ((uint64_t)num_vertices + 1) * sizeof(mer_t)};
+  items[2] = (MemoryItem){"frontiers",
+                          frontier_bytes(f1) + frontier_bytes(f2) +
+                              frontier_bytes(f3)};
+  items[3] = (MemoryItem){"vertex_logs", logs};
+  items[4] = (MemoryItem){"visit_state",
+                          shared ? (uint64_t)num_vertices * sizeof(mer_t) : 0};
+  return 5;
+}
 
-  uint32_t *sources =
-    generate_sources(graph, args.runs, graph->nrows, args.source_id);
-
-  distances = (uint32_t *)malloc(graph->nrows * sizeof(uint32_t));
-  memset(distances, UINT32_MAX, graph->nrows * sizeof(uint32_t));
-  initialize_bfs(graph);
-
-  struct timespec start, end;
-  double elapsed;
-  for (int i = 0; i < args.runs; i++) {
-    #ifndef USE_PAPI
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    #endif
-    bfs(sources[i]);
-    #ifndef USE_PAPI
-    clock_gettime(CLOCK_MONOTONIC, &end);
-    long seconds = end.tv_sec - start.tv_sec;
-    long nanoseconds = end.tv_nsec - start.tv_nsec;
-    elapsed = seconds + nanoseconds * 1e-9;
-
-    printf(
-        "run_id=%d,diameter=%d,threads=%d,chunk_size=%d,max_chunks=%d,source=%d,%.4f\n",
-        i, distance, MAX_THREADS, CHUNK_SIZE, max_chunks, sources[i], elapsed);
-
-    if (args.check) {
-      check_bfs_correctness(graph, distances, sources[i]);
-    }
-
-    memset(distances, UINT32_MAX, merged_csr->num_vertices * sizeof(uint32_t));
-    #endif
-  }
-  // Terminate threads
+void destroy_bfs() {
   thread_pool_terminate(&tp);
-
-  free(sources);
-  free(graph->row_ptr);
-  free(graph->col_idx);
-  free(graph);
   frontier_destroy(f1);
   frontier_destroy(f2);
+  frontier_destroy(f3);
+  for (int i = 0; i < MAX_THREADS; i++) {
+    vertex_log_destroy(&touched[i]);
+  }
   destroy_thread_pool(&tp);
-  destroy_merged_csr(merged_csr);
-  free(distances);
-
-  return 0;
+  if (visit_state != NULL) {
+    free(visit_state);
+    visit_state = NULL;
+  } else {
+    destroy_merged_csr(merged_csr);
+  }
 }
@@ -0,0 +1,93 @@
+#ifndef BFS_H
+#define BFS_H
+
+/**
+ * @brief Level-synchronous parallel BFS over the merged CSR (the engine
+ * behind the default mode).
+ *
+ * Each level is expanded chunk by chunk, threads first empty their own chunk
+ * pools and then steal from the others, and the frontiers are swapped at a
+ * barrier. The result of a BFS is written by the workers to `distances`,
+ * which must point to an array of one entry per vertex before calling bfs().
+ * This header only exposes the engine state that callers configure or read,
+ * so that it can be included next to other graph libraries (for instance
+ * from C++ by the benchmark driver).
+ */
+
+#include "memory_report.h"
+#include "mmio_c_wrapper.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Output of the last BFS: distance (or parent, with compute_parents) of each
+// vertex ID, UINT32_MAX for unreached vertices
+extern uint32_t *distances;
+// Number of levels of the last BFS, plus one
+extern volatile int distance;
+// Largest number of chunks of a frontier in the last BFS
+extern int max_chunks;
+
+// Options read by the next BFS
+extern bool reorder_frontier; // Locality-sorted frontiers (-r)
+extern bool compute_parents;  // BFS tree instead of distances (-p)
+extern bool pipeline_levels;  // Pipelined levels (-l)
+
+/**
+ * Builds the merged CSR and starts the thread pool with the BFS worker
+ * routine.
+ */
+void initialize_bfs(const mmio_csr_u32_f32_t *graph);
+
+// Merged CSR attached from shared memory (see shared_graph.h)
+typedef struct SharedGraph SharedGraph;
+
+/**
+ * Starts the engine on a shared merged CSR, which stays read-only: the
+ * distances (or parents) of the traversals live in a per-process array
+ * indexed by vertex ID instead of in its DISTANCE slots. The shared graph must
+ * outlive the engine.
+ */
+void initialize_bfs_shared(const SharedGraph *shared);
+
+/**
+ * Runs a BFS from `source`, writing the result to `distances`.
+ */
+void bfs(uint32_t source);
+
+/**
+ * Runs a BFS from `source` that stops after `depth` levels. Writes the IDs of
+ * the reached vertices (source included) to `ids` and their distances to
+ * `depths`, in no particular order, and returns their number.
+ */
+uint32_t bfs_bounded(uint32_t source, uint32_t depth, uint32_t *ids,
+                     uint32_t *depths);
+
+/**
+ * Runs a BFS from `source` and returns its eccentricity (the largest finite
+ * distance). The distances are left in `distances` and a vertex at that
+ * distance is written to `farthest`.
+ */
+uint32_t bfs_eccentricity(uint32_t source, uint32_t *farthest);
+
+/**
+ * Writes the memory taken by the engine (merged CSR, frontiers, vertex logs,
+ * visit state) to `items` and returns their number. The frontiers have the
+ * size reached by the BFSs run so far.
+ */
+int bfs_memory_usage(MemoryItem *items);
+
+/**
+ * Stops the thread pool and frees the merged CSR (unless shared) and the
+ * frontiers.
+ */
+void destroy_bfs();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BFS_H
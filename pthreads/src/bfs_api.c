@@ -0,0 +1,205 @@
+#include "bfs_api.h"
+#include "bfs.h"
+#include "generators.h"
+#include "mmio_c_wrapper.h"
+#include "shared_graph.h"
+#include "validate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct BfsGraph {
+  mmio_csr_u32_f32_t *csr;
+};
+
+struct BfsEngine {
+  uint32_t num_vertices;
+  BfsOptions options;
+  SharedGraph *shared; // NULL unless attached
+};
+
+// The engine state lives in bfs.c, so only one engine can be prepared
+static bool engine_prepared = false;
+
+static BfsGraph *wrap_csr(mmio_csr_u32_f32_t *csr) {
+  if (csr == NULL) {
+    return NULL;
+  }
+  BfsGraph *graph = (BfsGraph *)malloc(sizeof(BfsGraph));
+  graph->csr = csr;
+  return graph;
+}
+
+BfsGraph *bfs_graph_load(const char *path) {
+  mmio_csr_u32_f32_t *csr = mmio_read_csr_u32_f32(path, false);
+  if (csr == NULL) {
+    printf("Failed to import graph from file [%s]\n", path);
+  }
+  return wrap_csr(csr);
+}
+
+BfsGraph *bfs_graph_generate(const char *spec) {
+  return wrap_csr(generate_graph(spec));
+}
+
+BfsGraph *bfs_graph_from_csr(uint32_t num_vertices, const uint32_t *row_ptr,
+                             const uint32_t *col_idx) {
+  if (row_ptr[0] != 0) {
+    printf("The row pointers must start at 0\n");
+    return NULL;
+  }
+  for (uint32_t v = 0; v < num_vertices; v++) {
+    if (row_ptr[v + 1] < row_ptr[v]) {
+      printf("The row pointers must be non-decreasing (vertex %u)\n", v);
+      return NULL;
+    }
+  }
+  uint32_t num_edges = row_ptr[num_vertices];
+  for (uint32_t i = 0; i < num_edges; i++) {
+    if (col_idx[i] >= num_vertices) {
+      printf("Neighbor %u at index %u is out of bounds\n", col_idx[i], i);
+      return NULL;
+    }
+  }
+  mmio_csr_u32_f32_t *csr =
+      (mmio_csr_u32_f32_t *)malloc(sizeof(mmio_csr_u32_f32_t));
+  csr->nrows = num_vertices;
+  csr->ncols = num_vertices;
+  csr->nnz = num_edges;
+  csr->row_ptr =
+      (uint32_t *)malloc(((size_t)num_vertices + 1) * sizeof(uint32_t));
+  csr->col_idx = (uint32_t *)malloc((size_t)num_edges * sizeof(uint32_t));
+  csr->val = NULL;
+  memcpy(csr->row_ptr, row_ptr, ((size_t)num_vertices + 1) * sizeof(uint32_t));
+  memcpy(csr->col_idx, col_idx, (size_t)num_edges * sizeof(uint32_t));
+  return wrap_csr(csr);
+}
+
+uint32_t bfs_graph_num_vertices(const BfsGraph *graph) {
+  return graph->csr->nrows;
+}
+
+uint32_t bfs_graph_num_edges(const BfsGraph *graph) { return graph->csr->nnz; }
+
+bool bfs_graph_check_distances(const BfsGraph *graph, uint32_t source,
+                               const uint32_t *distances) {
+  return validate_distances(graph->csr, distances, source);
+}
+
+bool bfs_graph_check_parents(const BfsGraph *graph, uint32_t source,
+                             const uint32_t *parents) {
+  return validate_parents(graph->csr, parents, source);
+}
+
+int bfs_graph_publish(const BfsGraph *graph, const char *name) {
+  return shared_graph_publish(name, graph->csr);
+}
+
+void bfs_graph_free(BfsGraph *graph) {
+  if (graph == NULL) {
+    return;
+  }
+  free(graph->csr->row_ptr);
+  free(graph->csr->col_idx);
+  free(graph->csr->val);
+  free(graph->csr);
+  free(graph);
+}
+
+BfsEngine *bfs_engine_prepare(const BfsGraph *graph, const BfsOptions *options) {
+  if (engine_prepared) {
+    printf("A BFS engine is already prepared, destroy it first\n");
+    return NULL;
+  }
+  engine_prepared = true;
+  BfsEngine *engine = (BfsEngine *)malloc(sizeof(BfsEngine));
+  engine->num_vertices = graph->csr->nrows;
+  engine->options = options != NULL ? *options : (BfsOptions){false, false};
+  engine->shared = NULL;
+  initialize_bfs(graph->csr);
+  return engine;
+}
+
+BfsEngine *bfs_engine_attach(const char *name, const BfsOptions *options) {
+  if (engine_prepared) {
+    printf("A BFS engine is already prepared, destroy it first\n");
+    return NULL;
+  }
+  SharedGraph *shared = shared_graph_attach(name);
+  if (shared == NULL) {
+    return NULL;
+  }
+  engine_prepared = true;
+  BfsEngine *engine = (BfsEngine *)malloc(sizeof(BfsEngine));
+  engine->num_vertices = shared->csr.num_vertices;
+  engine->options = options != NULL ? *options : (BfsOptions){false, false};
+  engine->shared = shared;
+  initialize_bfs_shared(shared);
+  return engine;
+}
+
+static bool valid_source(const BfsEngine *engine, uint32_t source) {
+  if (source >= engine->num_vertices) {
+    printf("Source vertex %u is out of bounds (num_vertices=%u)\n", source,
+           engine->num_vertices);
+    return false;
+  }
+  return true;
+}
+
+int bfs_engine_distances(BfsEngine *engine, uint32_t source,
+                         uint32_t *result) {
+  if (!valid_source(engine, source)) {
+    return -1;
+  }
+  reorder_frontier = engine->options.reorder;
+  pipeline_levels = engine->options.pipeline;
+  compute_parents = false;
+  distances = result;
+  bfs(source);
+  return 0;
+}
+
+int bfs_engine_parents(BfsEngine *engine, uint32_t source, uint32_t *parents) {
+  if (!valid_source(engine, source)) {
+    return -1;
+  }
+  reorder_frontier = engine->options.reorder;
+  // Pipelined levels cannot compute parents
+  pipeline_levels = false;
+  compute_parents = true;
+  distances = parents;
+  bfs(source);
+  return 0;
+}
+
+int64_t bfs_engine_khop(BfsEngine *engine, uint32_t source, uint32_t depth,
+                        uint32_t *ids, uint32_t *depths) {
+  if (!valid_source(engine, source)) {
+    return -1;
+  }
+  reorder_frontier = engine->options.reorder;
+  pipeline_levels = false;
+  compute_parents = false;
+  // No vertex is farther than num_vertices - 1 hops
+  if (depth >= engine->num_vertices) {
+    depth = engine->num_vertices;
+  }
+  return bfs_bounded(source, depth, ids, depths);
+}
+
+uint32_t bfs_engine_num_vertices(const BfsEngine *engine) {
+  return engine->num_vertices;
+}
+
+void bfs_engine_destroy(BfsEngine *engine) {
+  if (engine == NULL) {
+    return;
+  }
+  destroy_bfs();
+  if (engine->shared != NULL) {
+    shared_graph_detach(engine->shared);
+  }
+  free(engine);
+  engine_prepared = false;
+}
@@ -0,0 +1,132 @@
+#ifndef BFS_API_H
+#define BFS_API_H
+
+/**
+ * @brief Embeddable interface to the BFS engine, for services that link the
+ * library instead of running bin/bfs.
+ *
+ * `make lib` builds bin/libbfs.a and bin/libbfs.so from every source but
+ * main.c; programs linking the static one also need -ldistributed_mmio
+ * -lstdc++ -pthread -lm -lrt. The interface separates the three phases of the
+ * command line modes:
+ *  - loading: a BfsGraph holds a CSR graph read from a file, generated from
+ *    a spec or copied from caller arrays (undirected graphs stored with both
+ *    directions of each edge, as the loaders produce);
+ *  - preparation: a BfsEngine holds the merged CSR built from the graph, the
+ *    frontiers and the running thread pool. The graph is not used by the
+ *    queries and can be freed right after;
+ *  - queries: each query writes its result into caller-provided buffers.
+ * The engine state is global, as for the command line modes: at most one
+ * BfsEngine exists at a time, and its queries must not run concurrently.
+ * MAX_THREADS and CHUNK_SIZE are those the library was built with. Errors are
+ * printed and reported with NULL or -1.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct BfsGraph BfsGraph;
+typedef struct BfsEngine BfsEngine;
+
+typedef struct {
+  bool reorder;  // Locality-sorted frontiers (-r)
+  bool pipeline; // Pipelined levels (-l), used by the distance queries only
+} BfsOptions;
+
+/**
+ * Reads a graph with distributed_mmio (Matrix Market or its binary format).
+ */
+BfsGraph *bfs_graph_load(const char *path);
+
+/**
+ * Generates a graph from a spec such as "kron:scale=20,ef=16" (see
+ * generators.h).
+ */
+BfsGraph *bfs_graph_generate(const char *spec);
+
+/**
+ * Copies a graph in CSR form: `row_ptr` has num_vertices + 1 entries and the
+ * neighbors of vertex v are col_idx[row_ptr[v]] .. col_idx[row_ptr[v+1]-1].
+ */
+BfsGraph *bfs_graph_from_csr(uint32_t num_vertices, const uint32_t *row_ptr,
+                             const uint32_t *col_idx);
+
+uint32_t bfs_graph_num_vertices(const BfsGraph *graph);
+
+/**
+ * Number of directed edges (each undirected edge counts twice).
+ */
+uint32_t bfs_graph_num_edges(const BfsGraph *graph);
+
+/**
+ * Validates the result of a query from `source` against the graph, with the
+ * checks of -c (see validate.h). Returns true if it is correct.
+ */
+bool bfs_graph_check_distances(const BfsGraph *graph, uint32_t source,
+                               const uint32_t *distances);
+bool bfs_graph_check_parents(const BfsGraph *graph, uint32_t source,
+                             const uint32_t *parents);
+
+/**
+ * Builds the merged CSR of `graph` into the shared memory segment `name` (see
+ * shared_graph.h), for engines of other processes to attach. Returns 0, or -1
+ * if the segment exists or cannot be allocated.
+ */
+int bfs_graph_publish(const BfsGraph *graph, const char *name);
+
+void bfs_graph_free(BfsGraph *graph);
+
+/**
+ * Builds the merged CSR of `graph` and starts the worker threads. `options`
+ * can be NULL for the defaults. Returns NULL if an engine already exists.
+ */
+BfsEngine *bfs_engine_prepare(const BfsGraph *graph, const BfsOptions *options);
+
+/**
+ * Starts the worker threads on the merged CSR published in the segment
+ * `name`, mapped read-only instead of built. Returns NULL if an engine
+ * already exists or the segment cannot be attached.
+ */
+BfsEngine *bfs_engine_attach(const char *name, const BfsOptions *options);
+
+/**
+ * Writes the distance of every vertex from `source` to `distances` (one
+ * entry per vertex, UINT32_MAX for unreached vertices). Returns 0, or -1 if
+ * the source is out of range.
+ */
+int bfs_engine_distances(BfsEngine *engine, uint32_t source,
+                         uint32_t *distances);
+
+/**
+ * Writes the parent of every vertex in a BFS tree rooted at `source` to
+ * `parents` (the source is its own parent, UINT32_MAX for unreached
+ * vertices). Returns 0, or -1 if the source is out of range.
+ */
+int bfs_engine_parents(BfsEngine *engine, uint32_t source, uint32_t *parents);
+
+/**
+ * Finds the vertices within `depth` hops of `source`, touching only their
+ * neighborhood: writes their IDs (source included) to `ids` and their
+ * distances to `depths`, in no particular order. Both buffers need room for
+ * every reached vertex (at most one entry per vertex). Returns the number of
+ * vertices found, or -1 if the source is out of range.
+ */
+int64_t bfs_engine_khop(BfsEngine *engine, uint32_t source, uint32_t depth,
+                        uint32_t *ids, uint32_t *depths);
+
+uint32_t bfs_engine_num_vertices(const BfsEngine *engine);
+
+/**
+ * Stops the worker threads and frees the merged CSR (or detaches it).
+ */
+void bfs_engine_destroy(BfsEngine *engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BFS_API_H
@@ -0,0 +1,223 @@
+#include "cc.h"
+#include "barrier.h"
+#include "config.h"
+#include "merged_csr.h"
+#include "thread_pool.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+static MergedCSR *cc_csr;
+static Barrier cc_barrier;
+static uint32_t *cc_components;
+static atomic_uint cc_next_block;
+static atomic_uint cc_num_components;
+// Offset of the representative of the (sampled) largest component
+static mer_t cc_giant;
+
+static inline mer_t load_component(mer_t v) {
+  return __atomic_load_n(&COMPONENT(cc_csr, v), __ATOMIC_RELAXED);
+}
+
+/**
+ * Merges the trees of `u` and `v`, hooking the larger representative under
+ * the smaller one (as in Afforest).
+ */
+static void link_vertices(mer_t u, mer_t v) {
+  mer_t p1 = load_component(u);
+  mer_t p2 = load_component(v);
+  while (p1 != p2) {
+    mer_t high = p1 > p2 ? p1 : p2;
+    mer_t low = p1 + p2 - high;
+    mer_t p_high = load_component(high);
+    // Already linked by another thread
+    if (p_high == low) {
+      break;
+    }
+    if (p_high == high &&
+        __atomic_compare_exchange_n(&COMPONENT(cc_csr, high), &p_high, low,
+                                    false, __ATOMIC_RELAXED,
+                                    __ATOMIC_RELAXED)) {
+      break;
+    }
+    p1 = load_component(load_component(high));
+    p2 = load_component(low);
+  }
+}
+
+/**
+ * Shortens the paths of the vertices in [start, end) to point directly to the
+ * representative.
+ */
+static void compress(mer_t start, mer_t end) {
+  for (mer_t i = start; i < end; i++) {
+    mer_t v = cc_csr->row_ptr[i];
+    while (load_component(v) != load_component(load_component(v))) {
+      COMPONENT(cc_csr, v) = load_component(load_component(v));
+    }
+  }
+}
+
+/**
+ * Claims the next block of CC_BLOCK_SIZE vertices of a link phase. Returns
+ * false once all vertices have been handed out.
+ */
+static bool next_block(mer_t *start, mer_t *end) {
+  mer_t block_start = atomic_fetch_add(&cc_next_block, 1) * CC_BLOCK_SIZE;
+  if (block_start >= cc_csr->num_vertices) {
+    return false;
+  }
+  *start = block_start;
+  *end = block_start + CC_BLOCK_SIZE < cc_csr->num_vertices
+             ? block_start + CC_BLOCK_SIZE
+             : cc_csr->num_vertices;
+  return true;
+}
+
+static void reset_blocks(void *arg) {
+  (void)arg;
+  atomic_store(&cc_next_block, 0);
+}
+
+static int compare_offsets(const void *a, const void *b) {
+  mer_t x = *(const mer_t *)a, y = *(const mer_t *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * Guesses the largest component as the most frequent representative among
+ * AFFOREST_SAMPLES randomly sampled vertices.
+ */
+static void sample_giant(void *arg) {
+  (void)arg;
+  static mer_t samples[AFFOREST_SAMPLES];
+  reset_blocks(NULL);
+  if (cc_csr->num_vertices == 0) {
+    return;
+  }
+  uint64_t state = SEED;
+  for (int k = 0; k < AFFOREST_SAMPLES; k++) {
+    // xorshift64
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    samples[k] = load_component(cc_csr->row_ptr[state % cc_csr->num_vertices]);
+  }
+  qsort(samples, AFFOREST_SAMPLES, sizeof(mer_t), compare_offsets);
+  int best_count = 0;
+  for (int k = 0, count = 0; k < AFFOREST_SAMPLES; k++) {
+    count = (k > 0 && samples[k] == samples[k - 1]) ? count + 1 : 1;
+    if (count > best_count) {
+      best_count = count;
+      cc_giant = samples[k];
+    }
+  }
+}
+
+static void notify_parent(void *arg) {
+  (void)arg;
+  thread_pool_notify_parent(&tp);
+}
+
+static void *cc_thread_main(void *arg) {
+  int thread_id = *(int *)arg;
+  mer_t chunk_size = cc_csr->num_vertices / MAX_THREADS;
+  mer_t start = thread_id * chunk_size;
+  mer_t end = (thread_id == MAX_THREADS - 1) ? cc_csr->num_vertices
+                                             : (thread_id + 1) * chunk_size;
+  mer_t block_start, block_end;
+
+  for (mer_t i = start; i < end; i++) {
+    COMPONENT(cc_csr, cc_csr->row_ptr[i]) = cc_csr->row_ptr[i];
+  }
+  barrier_wait(&cc_barrier, reset_blocks, NULL);
+
+  // Link each vertex to its first neighbors, one neighbor per round
+  for (mer_t r = 0; r < AFFOREST_NEIGHBOR_ROUNDS; r++) {
+    while (next_block(&block_start, &block_end)) {
+      for (mer_t i = block_start; i < block_end; i++) {
+        mer_t v = cc_csr->row_ptr[i];
+        if (DEGREE(cc_csr, v) > r) {
+          link_vertices(v, cc_csr->merged[v + METADATA_SIZE + r]);
+        }
+      }
+    }
+    barrier_wait(&cc_barrier, NULL, NULL);
+    compress(start, end);
+    barrier_wait(&cc_barrier,
+                 r == AFFOREST_NEIGHBOR_ROUNDS - 1 ? sample_giant
+                                                   : reset_blocks,
+                 NULL);
+  }
+
+  // Link the remaining edges, except for the vertices already in the largest
+  // component: the graph is symmetric, so their edges towards other
+  // components are linked from the other side
+  while (next_block(&block_start, &block_end)) {
+    for (mer_t i = block_start; i < block_end; i++) {
+      mer_t v = cc_csr->row_ptr[i];
+      if (load_component(v) == cc_giant) {
+        continue;
+      }
+      mer_t neighbors_end = v + METADATA_SIZE + DEGREE(cc_csr, v);
+      for (mer_t j = v + METADATA_SIZE + AFFOREST_NEIGHBOR_ROUNDS;
+           j < neighbors_end; j++) {
+        link_vertices(v, cc_csr->merged[j]);
+      }
+    }
+  }
+  barrier_wait(&cc_barrier, NULL, NULL);
+
+  // Every vertex now points to its representative
+  compress(start, end);
+  uint32_t roots = 0;
+  for (mer_t i = start; i < end; i++) {
+    mer_t v = cc_csr->row_ptr[i];
+    roots += COMPONENT(cc_csr, v) == v;
+    cc_components[i] = ID(cc_csr, COMPONENT(cc_csr, v));
+  }
+  atomic_fetch_add(&cc_num_components, roots);
+  barrier_wait(&cc_barrier, notify_parent, NULL);
+  return NULL;
+}
+
+void initialize_cc(const mmio_csr_u32_f32_t *graph) {
+  cc_csr = to_merged_csr(graph);
+  barrier_init(&cc_barrier);
+  init_thread_pool(&tp, cc_thread_main);
+  thread_pool_create(&tp);
+}
+
+uint32_t cc(uint32_t *components) {
+  cc_components = components;
+  cc_num_components = 0;
+  atomic_thread_fence(memory_order_seq_cst);
+  thread_pool_start_wait(&tp);
+  return cc_num_components;
+}
+
+void destroy_cc() {
+  thread_pool_terminate(&tp);
+  destroy_thread_pool(&tp);
+  destroy_merged_csr(cc_csr);
+}
+
+uint32_t giant_component(const mmio_csr_u32_f32_t *graph, uint32_t *components,
+                         uint32_t *size) {
+  initialize_cc(graph);
+  cc(components);
+  destroy_cc();
+
+  uint32_t *sizes = (uint32_t *)calloc(graph->nrows, sizeof(uint32_t));
+  uint32_t giant = 0;
+  for (uint32_t i = 0; i < graph->nrows; i++) {
+    if (++sizes[components[i]] > sizes[giant]) {
+      giant = components[i];
+    }
+  }
+  if (size != NULL) {
+    *size = graph->nrows > 0 ? sizes[giant] : 0;
+  }
+  free(sizes);
+  return giant;
+}
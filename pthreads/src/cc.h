@@ -0,0 +1,48 @@
+#ifndef CC_H
+#define CC_H
+
+/**
+ * @brief Parallel connected components (Afforest) over the merged CSR.
+ *
+ * The component of each vertex is kept in its DISTANCE slot (see COMPONENT in
+ * merged_csr.h) as the merged offset of the representative vertex, so that
+ * following a link is a single access to the merged array. Since offsets grow
+ * with the vertex IDs, linking the larger offset under the smaller one gives
+ * the same forest as the usual ID-based Afforest.
+ *
+ * Edges are linked in both directions, so the graph is treated as undirected:
+ * like the BFS, this assumes that the input matrix is symmetric.
+ */
+
+#include "mmio_c_wrapper.h"
+#include <stdint.h>
+
+/**
+ * Builds the merged CSR and starts the thread pool with the components worker
+ * routine.
+ */
+void initialize_cc(const mmio_csr_u32_f32_t *graph);
+
+/**
+ * Labels every vertex with the ID of the representative (smallest ID) of its
+ * component, writing the labels to `components`. Returns the number of
+ * components.
+ */
+uint32_t cc(uint32_t *components);
+
+/**
+ * Stops the thread pool and frees the components data structures.
+ */
+void destroy_cc();
+
+/**
+ * Computes the connected components of `graph` and returns the label of the
+ * largest one, writing the labels to `components` and the size of the largest
+ * component to `size` (if not NULL). Meant for source selection: builds and
+ * destroys its own thread pool, so it must not be called while another mode
+ * is initialized.
+ */
+uint32_t giant_component(const mmio_csr_u32_f32_t *graph, uint32_t *components,
+                         uint32_t *size);
+
+#endif // CC_H
@@ -19,6 +19,18 @@ static int parse_int_arg(const char *optarg, int *dest) {
   return 0;
 }
 
+// Internal helper to parse a floating-point number and store it.
+static int parse_double_arg(const char *optarg, double *dest) {
+  char *endptr;
+  double val = strtod(optarg, &endptr);
+  if (*endptr != '\0' || optarg == endptr) {
+    fprintf(stderr, "Error: Invalid floating-point value '%s'\n", optarg);
+    return -1;
+  }
+  *dest = val;
+  return 0;
+}
+
 void cli_print_help(const CliOption options[], int num_options,
                     const char *app_description) {
   printf("Usage: [options]\n");
@@ -36,6 +48,8 @@ void cli_print_help(const CliOption options[], int num_options,
     const char *arg_type_str = "";
     if (opt->type == ARG_TYPE_INT)
       arg_type_str = " <int>";
+    if (opt->type == ARG_TYPE_DOUBLE)
+      arg_type_str = " <float>";
     if (opt->type == ARG_TYPE_STRING)
       arg_type_str = " <string>";
 
@@ -115,6 +129,12 @@ int cli_parse(int argc, char **argv, const CliOption options[], int num_options,
             return -1;
           }
           break;
+        case ARG_TYPE_DOUBLE:
+          if (parse_double_arg(optarg, (double *)opt_def->value_ptr) != 0) {
+            free(seen_options);
+            return -1;
+          }
+          break;
         case ARG_TYPE_STRING:
           // Caller is responsible for freeing this memory
           *(char **)opt_def->value_ptr = strdup(optarg);
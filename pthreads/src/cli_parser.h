@@ -8,8 +8,9 @@
  */
 typedef enum {
   ARG_TYPE_BOOL,  // A flag that is either present (true) or not (false)
-  ARG_TYPE_INT,   // An integer value (e.g., -n 10)
-  ARG_TYPE_STRING // A string value (e.g., -f path/to/file)
+  ARG_TYPE_INT,    // An integer value (e.g., -n 10)
+  ARG_TYPE_DOUBLE, // A floating-point value (e.g., -d 0.5)
+  ARG_TYPE_STRING  // A string value (e.g., -f path/to/file)
 } ArgType;
 
 /**
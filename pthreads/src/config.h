@@ -12,6 +12,50 @@
 #endif
 #define INITIAL_CHUNKS_PER_THREAD 128
 
+// Cost model for the locality-sorted frontier (enabled with -r). A thread
+// sorts the chunks it produced for the next level only if it holds at least
+// REORDER_MIN_VERTICES vertices and the estimated average gap between
+// consecutive sorted frontier vertices in the merged CSR is at most
+// REORDER_MAX_GAP words (so that neighboring vertices share cache lines and
+// pages). Smaller frontiers are scattered anyway and are left untouched.
+#define REORDER_MIN_VERTICES 512
+#define REORDER_MAX_GAP 256
+#define REORDER_MAX_BUCKETS 16384
+
+// Delta-stepping SSSP: distances past SSSP_MAX_BUCKETS - 1 buckets share the
+// last bucket, which is processed until it stays empty, so that a tiny delta
+// cannot make the per-thread bins grow without bound (16 bytes per bucket)
+#define SSSP_MAX_BUCKETS (1 << 16)
+
+// Afforest connected components: every vertex is first linked to its first
+// AFFOREST_NEIGHBOR_ROUNDS neighbors, then AFFOREST_SAMPLES vertices are
+// sampled to guess the largest component, whose vertices skip the remaining
+// edges. Link phases hand out vertices in blocks of CC_BLOCK_SIZE.
+#define AFFOREST_NEIGHBOR_ROUNDS 2
+#define AFFOREST_SAMPLES 1024
+#define CC_BLOCK_SIZE 1024
+
+// Betweenness centrality: the per-level slices of discovered vertices are
+// processed (and stolen) in blocks of BC_BLOCK_SIZE vertices
+#define BC_BLOCK_SIZE 256
+
+// Neighbors inserted after the merged CSR is built (dynamic mode) go to
+// per-vertex linked blocks; 13 neighbors, the size and the link fill 64 bytes
+#define OVERFLOW_BLOCK_SIZE 13
+
+// Events kept per thread by the timeline of TRACE=1 builds (see -T); 32 bytes
+// each, older events are overwritten
+#define TRACE_BUFFER_EVENTS (1 << 18)
+
+// Query server (server mode): at most SERVER_MAX_CLIENTS connections and
+// SERVER_MAX_SOURCES sources per request; a batch takes queued requests up to
+// SERVER_MAX_BATCH queries, and a client that does not read its results for
+// SERVER_SEND_TIMEOUT seconds is dropped
+#define SERVER_MAX_CLIENTS 64
+#define SERVER_MAX_SOURCES (1 << 20)
+#define SERVER_MAX_BATCH (1 << 16)
+#define SERVER_SEND_TIMEOUT 10
+
 // Seed used for picking source vertices
 // Using same seed as in GAP benchmark for reproducible experiments
 // https://github.com/sbeamer/gapbs/blob/b5e3e19c2845f22fb338f4a4bc4b1ccee861d026/src/util.h#L22
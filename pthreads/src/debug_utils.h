@@ -5,8 +5,12 @@
 #include "frontier.h"
 #include "merged_csr.h"
 #include "mmio_c_wrapper.h"
+#include <math.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 void print_chunk_counts(const Frontier *f) {
   printf("Chunk counts: ");
@@ -160,4 +164,524 @@ int check_bfs_correctness(const mmio_csr_u32_f32_t *graph, const uint32_t *dista
   return 1;
 }
 
+int check_parents(const mmio_csr_u32_f32_t *graph, const uint32_t *parents,
+                  uint32_t source) {
+  uint32_t n = graph->nrows;
+  int correct = 1;
+
+  // Run a sequential BFS to compute the depth of each vertex
+  uint32_t *depth = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *queue = (uint32_t *)malloc(n * sizeof(uint32_t));
+  for (uint32_t i = 0; i < n; i++) {
+    depth[i] = UINT32_MAX;
+  }
+  uint32_t head = 0, tail = 0;
+  depth[source] = 0;
+  queue[tail++] = source;
+  while (head < tail) {
+    uint32_t u = queue[head++];
+    for (uint32_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+      uint32_t v = graph->col_idx[i];
+      if (depth[v] == UINT32_MAX) {
+        depth[v] = depth[u] + 1;
+        queue[tail++] = v;
+      }
+    }
+  }
+
+  for (uint32_t u = 0; u < n; u++) {
+    // Vertices are in the BFS tree if and only if they are reachable
+    if ((depth[u] == UINT32_MAX) != (parents[u] == UINT32_MAX)) {
+      printf("Error: Reachability mismatch for vertex %u (depth=%u, "
+             "parent=%u)\n",
+             u, depth[u], parents[u]);
+      correct = 0;
+      continue;
+    }
+    if (depth[u] == UINT32_MAX) {
+      continue;
+    }
+    if (u == source) {
+      if (parents[u] != source) {
+        printf("Error: Parent of source vertex %u must be itself (got %u)\n",
+               source, parents[u]);
+        correct = 0;
+      }
+      continue;
+    }
+    // The parent must be a neighbor one level closer to the source
+    bool parent_found = false;
+    for (uint32_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+      if (graph->col_idx[i] == parents[u]) {
+        parent_found = true;
+        break;
+      }
+    }
+    if (!parent_found) {
+      printf("Error: Couldn't find edge from parent %u to vertex %u\n",
+             parents[u], u);
+      correct = 0;
+    } else if (depth[parents[u]] != depth[u] - 1) {
+      printf("Error: Wrong depth of child %u (parent %u with depth %u)\n", u,
+             parents[u], depth[parents[u]]);
+      correct = 0;
+    }
+  }
+  free(depth);
+  free(queue);
+
+  if (correct) {
+    printf("BFS tree verification passed for source vertex %u.\n", source);
+  }
+  return correct;
+}
+
+int check_path(const mmio_csr_u32_f32_t *graph, const uint32_t *path, int hops,
+               uint32_t source, uint32_t target) {
+  uint32_t n = graph->nrows;
+
+  // Run a sequential BFS from the source to get the expected length
+  uint32_t *depth = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *queue = (uint32_t *)malloc(n * sizeof(uint32_t));
+  for (uint32_t i = 0; i < n; i++) {
+    depth[i] = UINT32_MAX;
+  }
+  uint32_t head = 0, tail = 0;
+  depth[source] = 0;
+  queue[tail++] = source;
+  while (head < tail && depth[target] == UINT32_MAX) {
+    uint32_t u = queue[head++];
+    for (uint32_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+      uint32_t v = graph->col_idx[i];
+      if (depth[v] == UINT32_MAX) {
+        depth[v] = depth[u] + 1;
+        queue[tail++] = v;
+      }
+    }
+  }
+  int expected = depth[target] == UINT32_MAX ? -1 : (int)depth[target];
+  free(depth);
+  free(queue);
+
+  if (hops != expected) {
+    printf("Error: Path from %u to %u has %d hops, expected %d\n", source,
+           target, hops, expected);
+    return 0;
+  }
+  if (hops >= 0 && (path[0] != source || path[hops] != target)) {
+    printf("Error: Path from %u to %u starts at %u and ends at %u\n", source,
+           target, path[0], path[hops]);
+    return 0;
+  }
+  for (int k = 0; k < hops; k++) {
+    bool edge_found = false;
+    for (uint32_t i = graph->row_ptr[path[k]]; i < graph->row_ptr[path[k] + 1];
+         i++) {
+      if (graph->col_idx[i] == path[k + 1]) {
+        edge_found = true;
+        break;
+      }
+    }
+    if (!edge_found) {
+      printf("Error: Path uses missing edge {%u, %u}\n", path[k],
+             path[k + 1]);
+      return 0;
+    }
+  }
+  printf("Path verification passed for source %u and target %u.\n", source,
+         target);
+  return 1;
+}
+
+int check_khop_distances(const mmio_csr_u32_f32_t *graph,
+                         const uint32_t *distances, uint32_t source,
+                         uint32_t depth) {
+  uint32_t n = graph->nrows;
+
+  // Run a sequential BFS to compute the expected distances
+  uint32_t *expected = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *queue = (uint32_t *)malloc(n * sizeof(uint32_t));
+  for (uint32_t i = 0; i < n; i++) {
+    expected[i] = UINT32_MAX;
+  }
+  uint32_t head = 0, tail = 0;
+  expected[source] = 0;
+  queue[tail++] = source;
+  while (head < tail) {
+    uint32_t u = queue[head++];
+    for (uint32_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+      uint32_t v = graph->col_idx[i];
+      if (expected[v] == UINT32_MAX) {
+        expected[v] = expected[u] + 1;
+        queue[tail++] = v;
+      }
+    }
+  }
+  free(queue);
+
+  int correct = 1;
+  for (uint32_t u = 0; u < n; u++) {
+    // Vertices farther than depth must not be reached
+    uint32_t want = expected[u] <= depth ? expected[u] : UINT32_MAX;
+    if (distances[u] != want) {
+      printf("Error: Vertex %u has distance %u in the %u-hop neighborhood of "
+             "%u, expected %u\n",
+             u, distances[u], depth, source, want);
+      correct = 0;
+      break;
+    }
+  }
+  free(expected);
+  if (correct) {
+    printf("k-hop verification passed for source vertex %u.\n", source);
+  }
+  return correct;
+}
+
+int check_khop(const mmio_csr_u32_f32_t *graph, const uint32_t *ids,
+               const uint32_t *depths, uint32_t count, uint32_t source,
+               uint32_t depth) {
+  uint32_t *distances = (uint32_t *)malloc(graph->nrows * sizeof(uint32_t));
+  for (uint32_t i = 0; i < graph->nrows; i++) {
+    distances[i] = UINT32_MAX;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    if (distances[ids[i]] != UINT32_MAX) {
+      printf("Error: Vertex %u reported twice\n", ids[i]);
+      free(distances);
+      return 0;
+    }
+    distances[ids[i]] = depths[i];
+  }
+  int correct = check_khop_distances(graph, distances, source, depth);
+  free(distances);
+  return correct;
+}
+
+typedef struct {
+  float distance;
+  uint32_t vertex;
+} HeapEntry;
+
+static void heap_push(HeapEntry *heap, uint64_t *size, HeapEntry e) {
+  uint64_t i = (*size)++;
+  while (i > 0 && heap[(i - 1) / 2].distance > e.distance) {
+    heap[i] = heap[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  heap[i] = e;
+}
+
+static HeapEntry heap_pop(HeapEntry *heap, uint64_t *size) {
+  HeapEntry top = heap[0];
+  HeapEntry last = heap[--(*size)];
+  uint64_t i = 0;
+  while (2 * i + 1 < *size) {
+    uint64_t child = 2 * i + 1;
+    if (child + 1 < *size && heap[child + 1].distance < heap[child].distance) {
+      child++;
+    }
+    if (heap[child].distance >= last.distance) {
+      break;
+    }
+    heap[i] = heap[child];
+    i = child;
+  }
+  heap[i] = last;
+  return top;
+}
+
+/**
+ * Checks weighted distances against a sequential Dijkstra with the same
+ * weights as to_weighted_merged_csr (absolute values, 1 for pattern graphs).
+ * Distances are summed in different orders, so a small relative error is
+ * tolerated.
+ */
+int check_sssp(const mmio_csr_u32_f32_t *graph, const float *distances,
+               uint32_t source) {
+  uint32_t n = graph->nrows;
+  float *expected = (float *)malloc(n * sizeof(float));
+  HeapEntry *heap =
+      (HeapEntry *)malloc((graph->nnz + 1) * sizeof(HeapEntry));
+  for (uint32_t i = 0; i < n; i++) {
+    expected[i] = INFINITY;
+  }
+  uint64_t size = 0;
+  expected[source] = 0;
+  heap_push(heap, &size, (HeapEntry){0, source});
+  while (size > 0) {
+    HeapEntry e = heap_pop(heap, &size);
+    if (e.distance > expected[e.vertex]) {
+      continue;
+    }
+    for (uint32_t i = graph->row_ptr[e.vertex];
+         i < graph->row_ptr[e.vertex + 1]; i++) {
+      float weight = graph->val != NULL ? fabsf(graph->val[i]) : 1.0f;
+      float new_distance = e.distance + weight;
+      if (new_distance < expected[graph->col_idx[i]]) {
+        expected[graph->col_idx[i]] = new_distance;
+        heap_push(heap, &size, (HeapEntry){new_distance, graph->col_idx[i]});
+      }
+    }
+  }
+  free(heap);
+
+  int correct = 1;
+  for (uint32_t i = 0; i < n && correct; i++) {
+    if (isinf(expected[i]) != isinf(distances[i]) ||
+        (!isinf(expected[i]) &&
+         fabsf(expected[i] - distances[i]) > 1e-4f * fmaxf(1.0f, expected[i]))) {
+      printf("Error: Vertex %u has distance %f, expected %f\n", i,
+             distances[i], expected[i]);
+      correct = 0;
+    }
+  }
+  free(expected);
+  if (correct) {
+    printf("SSSP verification passed for source vertex %u.\n", source);
+  }
+  return correct;
+}
+
+/**
+ * Checks connected component labels: both endpoints of every edge must have
+ * the same label, and the number of components must match a sequential BFS
+ * labeling (so the labels cannot merge distinct components either).
+ */
+int check_components(const mmio_csr_u32_f32_t *graph,
+                     const uint32_t *components, uint32_t num_components) {
+  uint32_t n = graph->nrows;
+  for (uint32_t u = 0; u < n; u++) {
+    for (uint32_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+      if (components[u] != components[graph->col_idx[i]]) {
+        printf("Error: Vertices %u and %u are adjacent but have labels %u and "
+               "%u\n",
+               u, graph->col_idx[i], components[u],
+               components[graph->col_idx[i]]);
+        return 0;
+      }
+    }
+  }
+
+  bool *visited = (bool *)calloc(n, sizeof(bool));
+  uint32_t *queue = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t expected = 0;
+  for (uint32_t s = 0; s < n; s++) {
+    if (visited[s]) {
+      continue;
+    }
+    expected++;
+    uint32_t head = 0, tail = 0;
+    visited[s] = true;
+    queue[tail++] = s;
+    while (head < tail) {
+      uint32_t u = queue[head++];
+      for (uint32_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+        if (!visited[graph->col_idx[i]]) {
+          visited[graph->col_idx[i]] = true;
+          queue[tail++] = graph->col_idx[i];
+        }
+      }
+    }
+  }
+  free(visited);
+  free(queue);
+
+  if (num_components != expected) {
+    printf("Error: Found %u components, expected %u\n", num_components,
+           expected);
+    return 0;
+  }
+  printf("Connected components verification passed (%u components).\n",
+         num_components);
+  return 1;
+}
+
+/**
+ * Checks betweenness scores against a sequential Brandes over the same
+ * sources. Scores are sums of floating point ratios accumulated in different
+ * orders, so a small relative error is tolerated.
+ */
+int check_bc(const mmio_csr_u32_f32_t *graph, const float *scores,
+             const uint32_t *sources, int num_sources) {
+  uint32_t n = graph->nrows;
+  double *expected = (double *)calloc(n, sizeof(double));
+  double *sigma = (double *)malloc(n * sizeof(double));
+  double *delta = (double *)malloc(n * sizeof(double));
+  uint32_t *depth = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *order = (uint32_t *)malloc(n * sizeof(uint32_t));
+  for (int s = 0; s < num_sources; s++) {
+    for (uint32_t i = 0; i < n; i++) {
+      sigma[i] = 0;
+      delta[i] = 0;
+      depth[i] = UINT32_MAX;
+    }
+    uint32_t head = 0, tail = 0;
+    depth[sources[s]] = 0;
+    sigma[sources[s]] = 1;
+    order[tail++] = sources[s];
+    while (head < tail) {
+      uint32_t u = order[head++];
+      for (uint32_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+        uint32_t v = graph->col_idx[i];
+        if (depth[v] == UINT32_MAX) {
+          depth[v] = depth[u] + 1;
+          order[tail++] = v;
+        }
+        if (depth[v] == depth[u] + 1) {
+          sigma[v] += sigma[u];
+        }
+      }
+    }
+    // Vertices in non-increasing depth order
+    while (tail-- > 1) {
+      uint32_t w = order[tail];
+      for (uint32_t i = graph->row_ptr[w]; i < graph->row_ptr[w + 1]; i++) {
+        uint32_t u = graph->col_idx[i];
+        if (depth[u] + 1 == depth[w]) {
+          delta[u] += sigma[u] / sigma[w] * (1 + delta[w]);
+        }
+      }
+      expected[w] += delta[w];
+    }
+  }
+  free(sigma);
+  free(delta);
+  free(depth);
+  free(order);
+
+  int correct = 1;
+  for (uint32_t i = 0; i < n && correct; i++) {
+    if (fabs(expected[i] - scores[i]) > 1e-3 * fmax(1.0, expected[i])) {
+      printf("Error: Vertex %u has score %f, expected %f\n", i, scores[i],
+             expected[i]);
+      correct = 0;
+    }
+  }
+  free(expected);
+  if (correct) {
+    printf("BC verification passed for %d sources.\n", num_sources);
+  }
+  return correct;
+}
+
+/**
+ * Checks the diameter of the component of `source` by running a sequential
+ * BFS from each of its vertices. Quadratic: only meant for small graphs.
+ */
+int check_diameter(const mmio_csr_u32_f32_t *graph, uint32_t source,
+                   uint32_t diameter) {
+  uint32_t n = graph->nrows;
+  uint32_t *depth = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *queue = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *component = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t component_size = 0, expected = 0;
+  for (uint32_t k = 0; k == 0 || k < component_size; k++) {
+    uint32_t s = k == 0 ? source : component[k];
+    for (uint32_t i = 0; i < n; i++) {
+      depth[i] = UINT32_MAX;
+    }
+    uint32_t head = 0, tail = 0;
+    depth[s] = 0;
+    queue[tail++] = s;
+    while (head < tail) {
+      uint32_t u = queue[head++];
+      for (uint32_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+        uint32_t v = graph->col_idx[i];
+        if (depth[v] == UINT32_MAX) {
+          depth[v] = depth[u] + 1;
+          queue[tail++] = v;
+        }
+      }
+    }
+    if (k == 0) {
+      component_size = tail;
+      memcpy(component, queue, tail * sizeof(uint32_t));
+    }
+    if (depth[queue[tail - 1]] > expected) {
+      expected = depth[queue[tail - 1]];
+    }
+  }
+  free(depth);
+  free(queue);
+  free(component);
+
+  if (diameter != expected) {
+    printf("Error: Diameter is %u, expected %u\n", diameter, expected);
+    return 0;
+  }
+  printf("Diameter verification passed for the component of %u.\n", source);
+  return 1;
+}
+
+/**
+ * Checks the distances of the dynamic mode against a sequential BFS on the
+ * graph extended with the `num_edges` inserted edges (pairs of IDs in
+ * `edges`, inserted in both directions).
+ */
+int check_dynamic(const mmio_csr_u32_f32_t *graph, const uint32_t *edges,
+                  uint32_t num_edges, const uint32_t *distances,
+                  uint32_t source) {
+  uint32_t n = graph->nrows;
+  uint64_t *row_ptr = (uint64_t *)calloc(n + 1, sizeof(uint64_t));
+  for (uint32_t u = 0; u < n; u++) {
+    row_ptr[u + 1] = graph->row_ptr[u + 1] - graph->row_ptr[u];
+  }
+  for (uint32_t k = 0; k < 2 * num_edges; k++) {
+    row_ptr[edges[k] + 1]++;
+  }
+  for (uint32_t u = 0; u < n; u++) {
+    row_ptr[u + 1] += row_ptr[u];
+  }
+  uint64_t *next = (uint64_t *)malloc(n * sizeof(uint64_t));
+  uint32_t *col_idx = (uint32_t *)malloc(row_ptr[n] * sizeof(uint32_t));
+  for (uint32_t u = 0; u < n; u++) {
+    next[u] = row_ptr[u];
+    for (uint32_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+      col_idx[next[u]++] = graph->col_idx[i];
+    }
+  }
+  for (uint32_t k = 0; k < num_edges; k++) {
+    col_idx[next[edges[2 * k]]++] = edges[2 * k + 1];
+    col_idx[next[edges[2 * k + 1]]++] = edges[2 * k];
+  }
+
+  uint32_t *depth = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *queue = (uint32_t *)malloc(n * sizeof(uint32_t));
+  for (uint32_t i = 0; i < n; i++) {
+    depth[i] = UINT32_MAX;
+  }
+  uint32_t head = 0, tail = 0;
+  depth[source] = 0;
+  queue[tail++] = source;
+  while (head < tail) {
+    uint32_t u = queue[head++];
+    for (uint64_t i = row_ptr[u]; i < row_ptr[u + 1]; i++) {
+      if (depth[col_idx[i]] == UINT32_MAX) {
+        depth[col_idx[i]] = depth[u] + 1;
+        queue[tail++] = col_idx[i];
+      }
+    }
+  }
+
+  int correct = 1;
+  for (uint32_t i = 0; i < n && correct; i++) {
+    if (depth[i] != distances[i]) {
+      printf("Error: Vertex %u has distance %u, expected %u\n", i,
+             distances[i], depth[i]);
+      correct = 0;
+    }
+  }
+  free(row_ptr);
+  free(next);
+  free(col_idx);
+  free(depth);
+  free(queue);
+  if (correct) {
+    printf("Dynamic BFS verification passed after %u insertions.\n",
+           num_edges);
+  }
+  return correct;
+}
+
 #endif // DEBUG_UTILS_H
\ No newline at end of file
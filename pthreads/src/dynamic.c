@@ -0,0 +1,274 @@
+#include "dynamic.h"
+#include "barrier.h"
+#include "frontier.h"
+#include "merged_csr.h"
+#include "thread_pool.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+static MergedCSR *dyn_csr;
+static OverflowBlock **overflow; // Inserted neighbors, indexed by vertex ID
+static Frontier *dyn_f1, *dyn_f2;
+static Barrier dyn_barrier;
+
+static volatile bool dyn_done;
+static uint32_t dyn_rounds;
+static uint32_t dyn_updated[MAX_THREADS];
+
+// Endpoints improved by the inserted edges, sorted by their new distance.
+// Each one joins the frontier at the level of its distance, so that the
+// repair proceeds in BFS order and a vertex is rarely improved twice.
+typedef struct {
+  mer_t vertex;
+  mer_t distance;
+} Seed;
+static Seed *dyn_seeds;
+static uint32_t dyn_num_seeds, dyn_seeds_capacity, dyn_next_seed;
+static mer_t dyn_level; // Distance of the vertices in the current frontier
+
+/**
+ * Lowers the distance of `neighbor` to `distance` if it is smaller, pushing it
+ * to the next frontier when it is.
+ */
+static inline void relax(mer_t neighbor, mer_t distance, Chunk **dest,
+                         int thread_id) {
+  mer_t old = __atomic_load_n(&DISTANCE(dyn_csr, neighbor), __ATOMIC_RELAXED);
+  while (distance < old) {
+    if (__atomic_compare_exchange_n(&DISTANCE(dyn_csr, neighbor), &old,
+                                    distance, false, __ATOMIC_RELAXED,
+                                    __ATOMIC_RELAXED)) {
+      if (*dest == NULL || (*dest)->next_free_index >= CHUNK_SIZE) {
+        *dest = frontier_create_chunk(dyn_f2, thread_id);
+      }
+      chunk_push_vertex(*dest, neighbor);
+      dyn_updated[thread_id]++;
+      break;
+    }
+  }
+}
+
+static void propagate_chunk(Chunk *c, Chunk **dest, int thread_id) {
+  mer_t v = VERT_MAX;
+  while ((v = chunk_pop_vertex(c)) != VERT_MAX) {
+    // The distance may have improved again since v was pushed
+    mer_t distance =
+        __atomic_load_n(&DISTANCE(dyn_csr, v), __ATOMIC_RELAXED) + 1;
+    mer_t end = v + METADATA_SIZE + DEGREE(dyn_csr, v);
+    for (mer_t i = v + METADATA_SIZE; i < end; i++) {
+      relax(dyn_csr->merged[i], distance, dest, thread_id);
+    }
+    for (OverflowBlock *b = overflow[ID(dyn_csr, v)]; b != NULL; b = b->next) {
+      for (uint32_t i = 0; i < b->size; i++) {
+        relax(b->neighbors[i], distance, dest, thread_id);
+      }
+    }
+  }
+}
+
+/**
+ * Propagates from the current frontier: chunks of this thread first, then
+ * stealing from the other threads (same scheme as top_down in bfs.c).
+ */
+static void propagate(int thread_id) {
+  Chunk *dest = NULL;
+  Chunk *c = NULL;
+  while ((c = frontier_remove_chunk(dyn_f1, thread_id)) != NULL) {
+    propagate_chunk(c, &dest, thread_id);
+  }
+  bool work_to_do = true;
+  while (work_to_do) {
+    work_to_do = false;
+    for (int i = 0; i < MAX_THREADS; i++) {
+      if (dyn_f1->thread_chunks[i]->top_chunk > 1) {
+        work_to_do = true;
+        if ((c = frontier_remove_chunk(dyn_f1, i)) != NULL) {
+          propagate_chunk(c, &dest, thread_id);
+        }
+        i--;
+      }
+    }
+  }
+}
+
+/**
+ * Pushes the seeds at distance `dyn_level` to the current frontier, spread
+ * round-robin over the chunk pools of the threads. Seeds that have been
+ * reached with a shorter distance in the meantime are dropped.
+ */
+static void push_seeds() {
+  Chunk *dest[MAX_THREADS] = {NULL};
+  int thread_id = 0;
+  for (; dyn_next_seed < dyn_num_seeds &&
+         dyn_seeds[dyn_next_seed].distance == dyn_level;
+       dyn_next_seed++) {
+    mer_t v = dyn_seeds[dyn_next_seed].vertex;
+    if (DISTANCE(dyn_csr, v) != dyn_level) {
+      continue;
+    }
+    if (dest[thread_id] == NULL ||
+        dest[thread_id]->next_free_index >= CHUNK_SIZE) {
+      dest[thread_id] = frontier_create_chunk(dyn_f1, thread_id);
+    }
+    chunk_push_vertex(dest[thread_id], v);
+    thread_id = (thread_id + 1) % MAX_THREADS;
+  }
+}
+
+static void swap_frontiers(void *arg) {
+  (void)arg;
+  Frontier *temp = dyn_f2;
+  dyn_f2 = dyn_f1;
+  dyn_f1 = temp;
+  dyn_rounds++;
+  dyn_level++;
+  push_seeds();
+  // Skip the levels without work until the next seeds
+  while (frontier_get_total_chunks(dyn_f1) == 0 &&
+         dyn_next_seed < dyn_num_seeds) {
+    dyn_level = dyn_seeds[dyn_next_seed].distance;
+    push_seeds();
+  }
+  if (frontier_get_total_chunks(dyn_f1) == 0) {
+    dyn_done = true;
+  }
+}
+
+static void notify_parent(void *arg) {
+  (void)arg;
+  thread_pool_notify_parent(&tp);
+}
+
+static void *dynamic_thread_main(void *arg) {
+  int thread_id = *(int *)arg;
+  while (!dyn_done) {
+    propagate(thread_id);
+    barrier_wait(&dyn_barrier, swap_frontiers, NULL);
+  }
+  barrier_wait(&dyn_barrier, notify_parent, NULL);
+  return NULL;
+}
+
+/**
+ * Runs the propagation from the vertices already in the current frontier,
+ * at distance `dyn_level`, and from the remaining seeds.
+ */
+static DynamicStats run_propagation(uint32_t seeds) {
+  DynamicStats stats = {0, seeds};
+  if (frontier_get_total_chunks(dyn_f1) == 0) {
+    return stats;
+  }
+  for (int i = 0; i < MAX_THREADS; i++) {
+    dyn_updated[i] = 0;
+  }
+  dyn_rounds = 0;
+  dyn_done = false;
+  atomic_thread_fence(memory_order_seq_cst);
+  thread_pool_start_wait(&tp);
+  stats.rounds = dyn_rounds;
+  for (int i = 0; i < MAX_THREADS; i++) {
+    stats.updated += dyn_updated[i];
+  }
+  return stats;
+}
+
+void initialize_dynamic(const mmio_csr_u32_f32_t *graph) {
+  dyn_csr = to_merged_csr(graph);
+  overflow = (OverflowBlock **)calloc(graph->nrows, sizeof(OverflowBlock *));
+  dyn_f1 = frontier_create();
+  dyn_f2 = frontier_create();
+  dyn_seeds_capacity = 1024;
+  dyn_seeds = (Seed *)malloc(dyn_seeds_capacity * sizeof(Seed));
+  barrier_init(&dyn_barrier);
+  init_thread_pool(&tp, dynamic_thread_main);
+  thread_pool_create(&tp);
+}
+
+DynamicStats dynamic_bfs(uint32_t source) {
+  for (mer_t i = 0; i < dyn_csr->num_vertices; i++) {
+    DISTANCE(dyn_csr, dyn_csr->row_ptr[i]) = UINT32_MAX;
+  }
+  mer_t v = dyn_csr->row_ptr[source];
+  DISTANCE(dyn_csr, v) = 0;
+  chunk_push_vertex(frontier_create_chunk(dyn_f1, 0), v);
+  dyn_level = 0;
+  dyn_num_seeds = dyn_next_seed = 0;
+  return run_propagation(1);
+}
+
+static void append_neighbor(uint32_t u, uint32_t v) {
+  OverflowBlock *b = overflow[u];
+  if (b == NULL || b->size == OVERFLOW_BLOCK_SIZE) {
+    b = (OverflowBlock *)malloc(sizeof(OverflowBlock));
+    b->size = 0;
+    b->next = overflow[u];
+    overflow[u] = b;
+  }
+  b->neighbors[b->size++] = dyn_csr->row_ptr[v];
+}
+
+/**
+ * Records `v` as a seed of the repair if the new edge from `u` shortens its
+ * distance.
+ */
+static void seed(uint32_t u, uint32_t v) {
+  mer_t du = DISTANCE(dyn_csr, dyn_csr->row_ptr[u]);
+  mer_t dv = DISTANCE(dyn_csr, dyn_csr->row_ptr[v]);
+  if (du == UINT32_MAX || du + 1 >= dv) {
+    return;
+  }
+  DISTANCE(dyn_csr, dyn_csr->row_ptr[v]) = du + 1;
+  if (dyn_num_seeds == dyn_seeds_capacity) {
+    dyn_seeds_capacity *= 2;
+    dyn_seeds =
+        (Seed *)realloc(dyn_seeds, dyn_seeds_capacity * sizeof(Seed));
+  }
+  dyn_seeds[dyn_num_seeds++] = (Seed){dyn_csr->row_ptr[v], du + 1};
+}
+
+static int compare_seeds(const void *a, const void *b) {
+  mer_t x = ((const Seed *)a)->distance, y = ((const Seed *)b)->distance;
+  return (x > y) - (x < y);
+}
+
+DynamicStats dynamic_insert(const uint32_t *edges, uint32_t num_edges) {
+  dyn_num_seeds = dyn_next_seed = 0;
+  for (uint32_t k = 0; k < num_edges; k++) {
+    uint32_t u = edges[2 * k], v = edges[2 * k + 1];
+    append_neighbor(u, v);
+    append_neighbor(v, u);
+    seed(u, v);
+    seed(v, u);
+  }
+  if (dyn_num_seeds == 0) {
+    return (DynamicStats){0, 0};
+  }
+  qsort(dyn_seeds, dyn_num_seeds, sizeof(Seed), compare_seeds);
+  dyn_level = dyn_seeds[0].distance;
+  push_seeds();
+  return run_propagation(dyn_num_seeds);
+}
+
+void dynamic_distances(uint32_t *distances) {
+  for (mer_t i = 0; i < dyn_csr->num_vertices; i++) {
+    distances[i] = DISTANCE(dyn_csr, dyn_csr->row_ptr[i]);
+  }
+}
+
+void destroy_dynamic() {
+  thread_pool_terminate(&tp);
+  destroy_thread_pool(&tp);
+  frontier_destroy(dyn_f1);
+  frontier_destroy(dyn_f2);
+  for (mer_t i = 0; i < dyn_csr->num_vertices; i++) {
+    OverflowBlock *b = overflow[i];
+    while (b != NULL) {
+      OverflowBlock *next = b->next;
+      free(b);
+      b = next;
+    }
+  }
+  free(overflow);
+  free(dyn_seeds);
+  destroy_merged_csr(dyn_csr);
+}
@@ -0,0 +1,66 @@
+#ifndef DYNAMIC_H
+#define DYNAMIC_H
+
+/**
+ * @brief BFS distances maintained under batches of edge insertions.
+ *
+ * The graph is the static merged CSR plus, for every vertex, a linked list of
+ * overflow blocks holding the neighbors inserted later (as merged offsets,
+ * like the static ones). The distances from the source live in the DISTANCE
+ * slots and persist across batches.
+ *
+ * Insertions can only shorten distances. After a batch is appended, the
+ * endpoints whose distance improves through a new edge are the only seeds of
+ * the repair, which propagates improvements level by level with an atomic
+ * minimum on the DISTANCE slot, on the chunked Frontier with work stealing.
+ * Seeds join the frontier at the level of their new distance, so the repair
+ * proceeds in BFS order, and vertices whose distance does not change are
+ * never visited. The initial BFS
+ * is the same propagation seeded with the source alone.
+ *
+ * Edges are inserted in both directions, as the graph is symmetric.
+ */
+
+#include "config.h"
+#include "mmio_c_wrapper.h"
+#include <stdint.h>
+
+typedef struct OverflowBlock {
+  mer_t neighbors[OVERFLOW_BLOCK_SIZE];
+  uint32_t size;
+  struct OverflowBlock *next;
+} OverflowBlock;
+
+typedef struct {
+  uint32_t rounds;  // Propagation rounds (levels) of the last update
+  uint32_t updated; // Distance improvements (seeds included)
+} DynamicStats;
+
+/**
+ * Builds the merged CSR, the (empty) overflow lists and the frontiers and
+ * starts the thread pool with the propagation routine.
+ */
+void initialize_dynamic(const mmio_csr_u32_f32_t *graph);
+
+/**
+ * Computes the distances from `source` from scratch.
+ */
+DynamicStats dynamic_bfs(uint32_t source);
+
+/**
+ * Appends `num_edges` edges (pairs of vertex IDs in `edges`) to the graph and
+ * repairs the distances from the current source.
+ */
+DynamicStats dynamic_insert(const uint32_t *edges, uint32_t num_edges);
+
+/**
+ * Writes the current distance of every vertex (UINT32_MAX if unreachable).
+ */
+void dynamic_distances(uint32_t *distances);
+
+/**
+ * Stops the thread pool and frees the graph, including the overflow blocks.
+ */
+void destroy_dynamic();
+
+#endif // DYNAMIC_H
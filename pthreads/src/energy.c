@@ -0,0 +1,124 @@
+#define _GNU_SOURCE
+#include "energy.h"
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool read_value(const char *path, uint64_t *value) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    return false;
+  }
+  bool ok = fscanf(f, "%" SCNu64, value) == 1;
+  fclose(f);
+  return ok;
+}
+
+// Recent Intel CPUs expose the package counter a second time through the
+// MMIO interface (intel-rapl-mmio:0, also named package-0): only the MSR zones
+// are summed, or the package energy would be counted twice
+#define RAPL_MMIO_ZONE "intel-rapl-mmio"
+
+static bool is_measured_zone(const char *root, const char *zone) {
+  if (strncmp(zone, RAPL_MMIO_ZONE, strlen(RAPL_MMIO_ZONE)) == 0) {
+    return false;
+  }
+  char path[4096];
+  snprintf(path, sizeof(path), "%s/%s/name", root, zone);
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    return false;
+  }
+  char name[64] = "";
+  bool ok = fscanf(f, "%63s", name) == 1;
+  fclose(f);
+  return ok && (strncmp(name, "package", 7) == 0 ||
+                strncmp(name, "dram", 4) == 0);
+}
+
+EnergyMeter *energy_meter_create(const char *root) {
+  DIR *dir = opendir(root);
+  if (dir == NULL) {
+    printf("Cannot open powercap root [%s], energy is not measured\n", root);
+    return NULL;
+  }
+  EnergyMeter *meter = (EnergyMeter *)calloc(1, sizeof(EnergyMeter));
+  int capacity = 0;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.' ||
+        !is_measured_zone(root, entry->d_name)) {
+      continue;
+    }
+    char path[4096];
+    uint64_t max_range, value;
+    snprintf(path, sizeof(path), "%s/%s/max_energy_range_uj", root,
+             entry->d_name);
+    if (!read_value(path, &max_range)) {
+      continue;
+    }
+    snprintf(path, sizeof(path), "%s/%s/energy_uj", root, entry->d_name);
+    // Reading energy_uj needs root on recent kernels
+    if (!read_value(path, &value)) {
+      continue;
+    }
+    if (meter->num_zones == capacity) {
+      capacity = capacity == 0 ? 4 : capacity * 2;
+      meter->energy_files =
+          (char **)realloc(meter->energy_files, capacity * sizeof(char *));
+      meter->max_range =
+          (uint64_t *)realloc(meter->max_range, capacity * sizeof(uint64_t));
+      meter->start =
+          (uint64_t *)realloc(meter->start, capacity * sizeof(uint64_t));
+    }
+    meter->energy_files[meter->num_zones] = strdup(path);
+    meter->max_range[meter->num_zones] = max_range;
+    meter->num_zones++;
+  }
+  closedir(dir);
+  if (meter->num_zones == 0) {
+    printf("No readable package or dram zone under [%s], energy is not "
+           "measured\n",
+           root);
+    energy_meter_destroy(meter);
+    return NULL;
+  }
+  return meter;
+}
+
+void energy_meter_start(EnergyMeter *meter) {
+  for (int i = 0; i < meter->num_zones; i++) {
+    if (!read_value(meter->energy_files[i], &meter->start[i])) {
+      meter->start[i] = 0;
+    }
+  }
+}
+
+double energy_meter_stop(EnergyMeter *meter) {
+  uint64_t total = 0;
+  for (int i = 0; i < meter->num_zones; i++) {
+    uint64_t end;
+    if (!read_value(meter->energy_files[i], &end)) {
+      continue;
+    }
+    if (end >= meter->start[i]) {
+      total += end - meter->start[i];
+    } else {
+      total += meter->max_range[i] - meter->start[i] + end;
+    }
+  }
+  return total * 1e-6;
+}
+
+void energy_meter_destroy(EnergyMeter *meter) {
+  for (int i = 0; i < meter->num_zones; i++) {
+    free(meter->energy_files[i]);
+  }
+  free(meter->energy_files);
+  free(meter->max_range);
+  free(meter->start);
+  free(meter);
+}
@@ -0,0 +1,41 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+/**
+ * @brief Energy readings from the Linux powercap (RAPL) interface.
+ *
+ * Every zone under the powercap root whose name starts with "package" or
+ * "dram" exposes a cumulative energy_uj counter; the energy of a run is the
+ * sum of the increments of all of them (cores and uncore are part of the
+ * package zones, so they are not counted again). Counters that wrap around
+ * during a run are corrected with max_energy_range_uj. The root is
+ * configurable, so that a directory with fake zones can stand in for
+ * /sys/class/powercap.
+ */
+
+#include <stdint.h>
+
+typedef struct {
+  int num_zones;
+  char **energy_files; // Path of the energy_uj file of each zone
+  uint64_t *max_range; // Value at which each counter wraps around (uJ)
+  uint64_t *start;     // Reading of each counter at energy_meter_start
+} EnergyMeter;
+
+/**
+ * Finds the package and DRAM zones under `root`. Returns NULL, after printing
+ * why, if none can be read.
+ */
+EnergyMeter *energy_meter_create(const char *root);
+
+void energy_meter_start(EnergyMeter *meter);
+
+/**
+ * Returns the energy (joules) consumed by all zones since the last
+ * energy_meter_start.
+ */
+double energy_meter_stop(EnergyMeter *meter);
+
+void energy_meter_destroy(EnergyMeter *meter);
+
+#endif // ENERGY_H
@@ -1,9 +1,11 @@
 #include "frontier.h"
 #include "config.h"
+#include "instrument.h"
 #include <assert.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * Allocates additional chunks for a thread.
@@ -35,6 +37,8 @@ Frontier *frontier_create() {
     f->thread_chunks[i] = (ThreadChunks *)malloc(sizeof(ThreadChunks));
     f->thread_chunks[i]->chunks_size = 0;
     f->thread_chunks[i]->top_chunk = 0;
+    f->thread_chunks[i]->sort_buffer = NULL;
+    f->thread_chunks[i]->sort_buffer_size = 0;
     allocate_chunks(f->thread_chunks[i], INITIAL_CHUNKS_PER_THREAD);
     f->thread_chunk_counts[i] = 0;
     pthread_mutex_init(&f->thread_chunks[i]->lock, NULL);
@@ -48,6 +52,7 @@ void frontier_destroy(Frontier *f) {
       free(f->thread_chunks[i]->chunks[j]);
     }
     free(f->thread_chunks[i]->chunks);
+    free(f->thread_chunks[i]->sort_buffer);
     pthread_mutex_destroy(&f->thread_chunks[i]->lock);
   }
   free(f->thread_chunks);
@@ -67,7 +72,14 @@ Chunk *frontier_create_chunk(Frontier *f, int thread_id) {
 
 Chunk *frontier_remove_chunk(Frontier *f, int thread_id) {
   ThreadChunks *thread = f->thread_chunks[thread_id];
+#ifdef INSTRUMENT
+  if (pthread_mutex_trylock(&thread->lock) != 0) {
+    instrument_contended++;
+    pthread_mutex_lock(&thread->lock);
+  }
+#else
   pthread_mutex_lock(&thread->lock);
+#endif
   if (thread->top_chunk > 0) {
     thread->top_chunk--;
     Chunk *chunk = thread->chunks[thread->top_chunk];
@@ -102,4 +114,150 @@ int frontier_get_total_chunks(Frontier *f) {
     total += f->thread_chunk_counts[i];
   }
   return total;
-}
\ No newline at end of file
+}
+
+void frontier_clear(Frontier *f) {
+  for (int i = 0; i < MAX_THREADS; i++) {
+    ThreadChunks *thread = f->thread_chunks[i];
+    for (int j = 0; j < thread->top_chunk; j++) {
+      thread->chunks[j]->next_free_index = 0;
+    }
+    thread->top_chunk = 0;
+    f->thread_chunk_counts[i] = 0;
+  }
+}
+
+void frontier_publish_chunk(Frontier *f, int thread_id, const Chunk *c) {
+  ThreadChunks *thread = f->thread_chunks[thread_id];
+  pthread_mutex_lock(&thread->lock);
+  if (thread->top_chunk >= thread->chunks_size) {
+    allocate_chunks(thread, thread->chunks_size);
+  }
+  Chunk *dest = thread->chunks[thread->top_chunk++];
+  memcpy(dest->vertices, c->vertices, c->next_free_index * sizeof(ver_t));
+  dest->next_free_index = c->next_free_index;
+  f->thread_chunk_counts[thread_id]++;
+  pthread_mutex_unlock(&thread->lock);
+}
+
+bool frontier_take_chunk(Frontier *f, int thread_id, Chunk *c) {
+  ThreadChunks *thread = f->thread_chunks[thread_id];
+  pthread_mutex_lock(&thread->lock);
+  if (thread->top_chunk == 0) {
+    pthread_mutex_unlock(&thread->lock);
+    return false;
+  }
+  Chunk *src = thread->chunks[--thread->top_chunk];
+  memcpy(c->vertices, src->vertices, src->next_free_index * sizeof(ver_t));
+  c->next_free_index = src->next_free_index;
+  src->next_free_index = 0;
+  f->thread_chunk_counts[thread_id]--;
+  pthread_mutex_unlock(&thread->lock);
+  return true;
+}
+
+uint64_t frontier_bytes(const Frontier *f) {
+  uint64_t bytes =
+      sizeof(Frontier) + MAX_THREADS * (sizeof(ThreadChunks *) + sizeof(int));
+  for (int i = 0; i < MAX_THREADS; i++) {
+    const ThreadChunks *thread = f->thread_chunks[i];
+    bytes += sizeof(ThreadChunks) +
+             (uint64_t)thread->chunks_size * (sizeof(Chunk *) + sizeof(Chunk)) +
+             2 * (uint64_t)thread->sort_buffer_size * sizeof(ver_t);
+  }
+  return bytes;
+}
+
+void vertex_log_init(VertexLog *log) {
+  log->vertices = NULL;
+  log->size = 0;
+  log->capacity = 0;
+}
+
+void vertex_log_push(VertexLog *log, ver_t v) {
+  if (log->size == log->capacity) {
+    log->capacity = log->capacity == 0 ? CHUNK_SIZE : 2 * log->capacity;
+    log->vertices =
+        (ver_t *)realloc(log->vertices, log->capacity * sizeof(ver_t));
+  }
+  log->vertices[log->size++] = v;
+}
+
+void vertex_log_destroy(VertexLog *log) {
+  free(log->vertices);
+  vertex_log_init(log);
+}
+
+int frontier_get_thread_vertices(Frontier *f, int thread_id) {
+  ThreadChunks *thread = f->thread_chunks[thread_id];
+  int total = 0;
+  for (int i = 0; i < thread->top_chunk; i++) {
+    total += thread->chunks[i]->next_free_index;
+  }
+  return total;
+}
+
+void frontier_sort_thread_chunks(Frontier *f, int thread_id, mer_t max_offset) {
+  ThreadChunks *thread = f->thread_chunks[thread_id];
+  int n = frontier_get_thread_vertices(f, thread_id);
+  if (n < 2) {
+    return;
+  }
+  // Scratch space: n vertices for the gathered input followed by n vertices
+  // for the sorted output
+  if (thread->sort_buffer_size < n) {
+    free(thread->sort_buffer);
+    thread->sort_buffer_size = n;
+    thread->sort_buffer = (ver_t *)malloc(2 * (size_t)n * sizeof(ver_t));
+  }
+  ver_t *in = thread->sort_buffer;
+  ver_t *out = thread->sort_buffer + n;
+
+  // Pick the bucket count as the smallest power of two >= n (capped), and the
+  // shift so that buckets evenly cover [0, max_offset)
+  int bucket_bits = 0;
+  while ((1 << bucket_bits) < n && (1 << bucket_bits) < REORDER_MAX_BUCKETS) {
+    bucket_bits++;
+  }
+  int offset_bits = 0;
+  while (offset_bits < (int)(8 * sizeof(mer_t)) &&
+         ((uint64_t)1 << offset_bits) < (uint64_t)max_offset) {
+    offset_bits++;
+  }
+  int shift = offset_bits > bucket_bits ? offset_bits - bucket_bits : 0;
+  int buckets = 1 << bucket_bits;
+
+  int histogram[REORDER_MAX_BUCKETS + 1];
+  memset(histogram, 0, (buckets + 1) * sizeof(int));
+  int k = 0;
+  for (int i = 0; i < thread->top_chunk; i++) {
+    Chunk *c = thread->chunks[i];
+    for (int j = 0; j < c->next_free_index; j++) {
+      in[k++] = c->vertices[j];
+      histogram[(c->vertices[j] >> shift) + 1]++;
+    }
+  }
+  for (int b = 0; b < buckets; b++) {
+    histogram[b + 1] += histogram[b];
+  }
+  for (int i = 0; i < n; i++) {
+    out[histogram[in[i] >> shift]++] = in[i];
+  }
+
+  // Repack: chunks and vertices are popped from the top, so store the sorted
+  // sequence in reverse to have the smallest offsets processed first
+  int used_chunks = (n + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  for (int i = 0; i < used_chunks; i++) {
+    Chunk *c = thread->chunks[i];
+    int count = (i == used_chunks - 1) ? n - i * CHUNK_SIZE : CHUNK_SIZE;
+    for (int j = 0; j < count; j++) {
+      c->vertices[j] = out[n - 1 - (i * CHUNK_SIZE + j)];
+    }
+    c->next_free_index = count;
+  }
+  for (int i = used_chunks; i < thread->top_chunk; i++) {
+    thread->chunks[i]->next_free_index = 0;
+  }
+  f->thread_chunk_counts[thread_id] -= thread->top_chunk - used_chunks;
+  thread->top_chunk = used_chunks;
+}
@@ -43,6 +43,8 @@ typedef struct {
   int chunks_size;       // Current size of the chunks array
   int top_chunk;         // Index of the next chunk to be allocated
   pthread_mutex_t lock;  // Mutex for thread-safe access
+  ver_t *sort_buffer;    // Scratch space used by frontier_sort_thread_chunks
+  int sort_buffer_size;  // Current capacity of sort_buffer (in vertices)
 } ThreadChunks;
 
 typedef struct {
@@ -50,6 +52,17 @@ typedef struct {
   int *thread_chunk_counts;
 } Frontier;
 
+/**
+ * Growable list of vertices owned by a single thread. Used to remember the
+ * vertices touched by a query, so that their state can be reset without
+ * sweeping the whole graph.
+ */
+typedef struct {
+  ver_t *vertices;
+  uint32_t size;
+  uint32_t capacity;
+} VertexLog;
+
 /**
  * Creates and initializes a new Frontier structure. Allocates memory for
  * per-thread vertex chunk pools and sets up mutexes for thread-safe chunk
@@ -91,4 +104,65 @@ mer_t chunk_pop_vertex(Chunk *c);
  */
 int frontier_get_total_chunks(Frontier *f);
 
+/**
+ * Empties all the chunks of the Frontier. Must not be called while other
+ * threads access the Frontier.
+ */
+void frontier_clear(Frontier *f);
+
+/**
+ * Publishes a copy of chunk `c` in the pool of `thread_id`. The copy is made
+ * under the pool's lock, so unlike frontier_create_chunk this can be called
+ * while other threads take chunks from the same pool, and `c` can be reused
+ * right away (asynchronous traversals).
+ */
+void frontier_publish_chunk(Frontier *f, int thread_id, const Chunk *c);
+
+/**
+ * Takes the top chunk of the pool of `thread_id`, copying it into `c` under
+ * the pool's lock. Returns false if the pool is empty.
+ */
+bool frontier_take_chunk(Frontier *f, int thread_id, Chunk *c);
+
+/**
+ * Bytes allocated by the Frontier: the chunk pools keep every chunk they ever
+ * allocated (they grow and never shrink), plus the sort buffers.
+ */
+uint64_t frontier_bytes(const Frontier *f);
+
+/**
+ * Initializes an empty vertex log.
+ */
+void vertex_log_init(VertexLog *log);
+
+/**
+ * Appends a vertex to the log, growing it if needed.
+ */
+void vertex_log_push(VertexLog *log, ver_t v);
+
+/**
+ * Frees the memory of a vertex log.
+ */
+void vertex_log_destroy(VertexLog *log);
+
+/**
+ * Gets the number of vertices stored in the chunks owned by a thread.
+ * Only valid while the thread is the sole producer of its chunks (i.e. between
+ * the end of its top-down step and the frontier swap).
+ */
+int frontier_get_thread_vertices(Frontier *f, int thread_id);
+
+/**
+ * Reorders the vertices stored in the chunks owned by a thread so that they are
+ * popped in increasing merged CSR offset order. Vertices are bucketed by offset
+ * range with a single counting-sort pass: the number of buckets grows with the
+ * number of vertices (up to REORDER_MAX_BUCKETS), so each bucket spans roughly
+ * the average gap between consecutive frontier vertices. Chunks are repacked,
+ * so the thread may end up owning fewer chunks than before.
+ * `max_offset` is an upper bound (exclusive) on the stored vertex offsets.
+ * Must only be called by the owning thread while no other thread accesses its
+ * chunks.
+ */
+void frontier_sort_thread_chunks(Frontier *f, int thread_id, mer_t max_offset);
+
 #endif // FRONTIER_H
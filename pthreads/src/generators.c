@@ -0,0 +1,475 @@
+#define _GNU_SOURCE
+#include "generators.h"
+#include "config.h"
+#include "parallel.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Graph500 Kronecker initiator probabilities (D = 1 - A - B - C)
+#define KRON_A 0.57
+#define KRON_B 0.19
+#define KRON_C 0.19
+
+// Marks an edge slot that holds no edge (e.g. a dropped grid edge)
+#define NO_VERTEX UINT32_MAX
+
+typedef struct {
+  char name[16];
+  uint64_t scale, ef, x, y, z, seed;
+  double drop;
+  double radius; // 0 selects the default radius
+} GraphSpec;
+
+typedef struct {
+  GraphSpec spec;
+  uint64_t n; // Number of vertices
+  uint64_t m; // Number of edge slots
+  uint32_t *src, *dst;
+  // Kronecker vertex scrambling
+  uint64_t mask, scramble1, scramble2;
+  // Random geometric graph
+  double *px, *py;
+  uint64_t cells_per_side;
+  uint32_t *cell_start, *cell_points, *cell_cursor;
+  uint64_t *edge_offset;
+  // CSR construction
+  uint32_t *degrees, *row_ptr, *col_idx, *unique_row_ptr, *unique_col_idx;
+} Generator;
+
+// SplitMix64 finalizer
+static inline uint64_t mix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// Independent stream of random numbers for each edge (or vertex) index
+static inline uint64_t stream_start(uint64_t seed, uint64_t index) {
+  return mix64(seed ^ mix64(index));
+}
+
+static inline uint64_t next_random(uint64_t *state) {
+  *state += 0x9e3779b97f4a7c15ULL;
+  return mix64(*state);
+}
+
+// Uniform double in [0, 1)
+static inline double unit(uint64_t r) { return (r >> 11) * 0x1.0p-53; }
+
+/**
+ * Bijection of [0, 2^scale) that spreads the high-degree vertices of the
+ * Kronecker graph, which would otherwise all have small IDs.
+ */
+static inline uint32_t scramble(const Generator *g, uint64_t v) {
+  v = (v * g->scramble1) & g->mask;
+  v ^= v >> (g->spec.scale / 2 + 1);
+  v = (v * g->scramble2 + g->spec.seed) & g->mask;
+  return (uint32_t)v;
+}
+
+static void kron_edges(uint64_t begin, uint64_t end, void *arg) {
+  Generator *g = (Generator *)arg;
+  for (uint64_t e = begin; e < end; e++) {
+    uint64_t state = stream_start(g->spec.seed, e);
+    uint64_t u = 0, v = 0;
+    for (uint64_t level = 0; level < g->spec.scale; level++) {
+      double r = unit(next_random(&state));
+      // Quadrants A, B, C and D are (0, 0), (0, 1), (1, 0) and (1, 1)
+      uint64_t bit_u = r >= KRON_A + KRON_B;
+      uint64_t bit_v = (r >= KRON_A && r < KRON_A + KRON_B) ||
+                       r >= KRON_A + KRON_B + KRON_C;
+      u = (u << 1) | bit_u;
+      v = (v << 1) | bit_v;
+    }
+    g->src[e] = scramble(g, u);
+    g->dst[e] = scramble(g, v);
+  }
+}
+
+static void uniform_edges(uint64_t begin, uint64_t end, void *arg) {
+  Generator *g = (Generator *)arg;
+  for (uint64_t e = begin; e < end; e++) {
+    uint64_t state = stream_start(g->spec.seed, e);
+    g->src[e] = (uint32_t)(next_random(&state) % g->n);
+    g->dst[e] = (uint32_t)(next_random(&state) % g->n);
+  }
+}
+
+// Slot 3v + d holds the edge from v to its successor along dimension d
+static void grid_edges(uint64_t begin, uint64_t end, void *arg) {
+  Generator *g = (Generator *)arg;
+  uint64_t x = g->spec.x, y = g->spec.y, z = g->spec.z;
+  for (uint64_t slot = begin; slot < end; slot++) {
+    uint64_t v = slot / 3;
+    uint64_t i = v % x, j = v / x % y, k = v / (x * y);
+    uint64_t neighbor = NO_VERTEX;
+    switch (slot % 3) {
+    case 0:
+      neighbor = i + 1 < x ? v + 1 : NO_VERTEX;
+      break;
+    case 1:
+      neighbor = j + 1 < y ? v + x : NO_VERTEX;
+      break;
+    default:
+      neighbor = k + 1 < z ? v + x * y : NO_VERTEX;
+      break;
+    }
+    uint64_t state = stream_start(g->spec.seed, slot);
+    if (neighbor != NO_VERTEX && unit(next_random(&state)) >= g->spec.drop) {
+      g->src[slot] = (uint32_t)v;
+      g->dst[slot] = (uint32_t)neighbor;
+    } else {
+      g->src[slot] = NO_VERTEX;
+      g->dst[slot] = NO_VERTEX;
+    }
+  }
+}
+
+static inline uint64_t cell_coordinate(const Generator *g, double c) {
+  uint64_t cell = (uint64_t)(c * g->cells_per_side);
+  return cell < g->cells_per_side ? cell : g->cells_per_side - 1;
+}
+
+static void rgg_points(uint64_t begin, uint64_t end, void *arg) {
+  Generator *g = (Generator *)arg;
+  for (uint64_t v = begin; v < end; v++) {
+    uint64_t state = stream_start(g->spec.seed, v);
+    g->px[v] = unit(next_random(&state));
+    g->py[v] = unit(next_random(&state));
+    uint64_t cell = cell_coordinate(g, g->py[v]) * g->cells_per_side +
+                    cell_coordinate(g, g->px[v]);
+    __atomic_fetch_add(&g->cell_start[cell + 1], 1, __ATOMIC_RELAXED);
+  }
+}
+
+static void rgg_buckets(uint64_t begin, uint64_t end, void *arg) {
+  Generator *g = (Generator *)arg;
+  for (uint64_t v = begin; v < end; v++) {
+    uint64_t cell = cell_coordinate(g, g->py[v]) * g->cells_per_side +
+                    cell_coordinate(g, g->px[v]);
+    uint32_t pos =
+        __atomic_fetch_add(&g->cell_cursor[cell], 1, __ATOMIC_RELAXED);
+    g->cell_points[pos] = (uint32_t)v;
+  }
+}
+
+/**
+ * Visits the points within the radius of `v` with a larger ID, counting them
+ * (fill = false) or writing the edges to them at edge_offset[v] (fill = true).
+ * The cells are at least as wide as the radius, so the neighbors of `v` are
+ * in the 3x3 cells around its own.
+ */
+static uint64_t rgg_neighbors(Generator *g, uint64_t v, bool fill) {
+  uint64_t side = g->cells_per_side;
+  uint64_t cx = cell_coordinate(g, g->px[v]);
+  uint64_t cy = cell_coordinate(g, g->py[v]);
+  double r2 = g->spec.radius * g->spec.radius;
+  uint64_t found = 0;
+  for (uint64_t y = cy > 0 ? cy - 1 : 0; y <= cy + 1 && y < side; y++) {
+    for (uint64_t x = cx > 0 ? cx - 1 : 0; x <= cx + 1 && x < side; x++) {
+      uint64_t cell = y * side + x;
+      for (uint32_t p = g->cell_start[cell]; p < g->cell_start[cell + 1];
+           p++) {
+        uint32_t u = g->cell_points[p];
+        double dx = g->px[u] - g->px[v], dy = g->py[u] - g->py[v];
+        if (u > v && dx * dx + dy * dy < r2) {
+          if (fill) {
+            g->src[g->edge_offset[v] + found] = (uint32_t)v;
+            g->dst[g->edge_offset[v] + found] = u;
+          }
+          found++;
+        }
+      }
+    }
+  }
+  return found;
+}
+
+static void rgg_count(uint64_t begin, uint64_t end, void *arg) {
+  Generator *g = (Generator *)arg;
+  for (uint64_t v = begin; v < end; v++) {
+    g->edge_offset[v] = rgg_neighbors(g, v, false);
+  }
+}
+
+static void rgg_fill(uint64_t begin, uint64_t end, void *arg) {
+  Generator *g = (Generator *)arg;
+  for (uint64_t v = begin; v < end; v++) {
+    rgg_neighbors(g, v, true);
+  }
+}
+
+static void rgg_edges(Generator *g) {
+  uint64_t n = g->n;
+  // Cells of side >= radius, but not many more cells than points
+  uint64_t side = (uint64_t)(1.0 / g->spec.radius);
+  uint64_t max_side = 2 * (uint64_t)ceil(sqrt((double)n));
+  side = side < 1 ? 1 : side > max_side ? max_side : side;
+  uint64_t cells = side * side;
+  g->cells_per_side = side;
+  g->px = (double *)malloc(n * sizeof(double));
+  g->py = (double *)malloc(n * sizeof(double));
+  g->cell_start = (uint32_t *)calloc(cells + 1, sizeof(uint32_t));
+  g->cell_cursor = (uint32_t *)malloc(cells * sizeof(uint32_t));
+  g->cell_points = (uint32_t *)malloc(n * sizeof(uint32_t));
+  g->edge_offset = (uint64_t *)malloc((n + 1) * sizeof(uint64_t));
+
+  parallel_for(n, rgg_points, g);
+  for (uint64_t c = 0; c < cells; c++) {
+    g->cell_start[c + 1] += g->cell_start[c];
+    g->cell_cursor[c] = g->cell_start[c];
+  }
+  parallel_for(n, rgg_buckets, g);
+  parallel_for(n, rgg_count, g);
+  uint64_t total = 0;
+  for (uint64_t v = 0; v < n; v++) {
+    uint64_t count = g->edge_offset[v];
+    g->edge_offset[v] = total;
+    total += count;
+  }
+  g->m = total;
+  g->src = (uint32_t *)malloc(total * sizeof(uint32_t));
+  g->dst = (uint32_t *)malloc(total * sizeof(uint32_t));
+  parallel_for(n, rgg_fill, g);
+
+  free(g->px);
+  free(g->py);
+  free(g->cell_start);
+  free(g->cell_cursor);
+  free(g->cell_points);
+  free(g->edge_offset);
+}
+
+static void count_degrees(uint64_t begin, uint64_t end, void *arg) {
+  Generator *g = (Generator *)arg;
+  for (uint64_t e = begin; e < end; e++) {
+    uint32_t u = g->src[e], v = g->dst[e];
+    if (u != NO_VERTEX && u != v) {
+      __atomic_fetch_add(&g->degrees[u], 1, __ATOMIC_RELAXED);
+      __atomic_fetch_add(&g->degrees[v], 1, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+// Both directions of every edge, at cursors kept in `degrees`
+static void scatter_edges(uint64_t begin, uint64_t end, void *arg) {
+  Generator *g = (Generator *)arg;
+  for (uint64_t e = begin; e < end; e++) {
+    uint32_t u = g->src[e], v = g->dst[e];
+    if (u != NO_VERTEX && u != v) {
+      g->col_idx[__atomic_fetch_add(&g->degrees[u], 1, __ATOMIC_RELAXED)] = v;
+      g->col_idx[__atomic_fetch_add(&g->degrees[v], 1, __ATOMIC_RELAXED)] = u;
+    }
+  }
+}
+
+static int compare_vertices(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+// Sorts each adjacency list and leaves its number of distinct neighbors in
+// `degrees`
+static void sort_adjacency(uint64_t begin, uint64_t end, void *arg) {
+  Generator *g = (Generator *)arg;
+  for (uint64_t v = begin; v < end; v++) {
+    uint32_t *neighbors = g->col_idx + g->row_ptr[v];
+    uint32_t degree = g->row_ptr[v + 1] - g->row_ptr[v];
+    qsort(neighbors, degree, sizeof(uint32_t), compare_vertices);
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < degree; i++) {
+      if (i == 0 || neighbors[i] != neighbors[i - 1]) {
+        neighbors[unique++] = neighbors[i];
+      }
+    }
+    g->degrees[v] = unique;
+  }
+}
+
+static void compact_adjacency(uint64_t begin, uint64_t end, void *arg) {
+  Generator *g = (Generator *)arg;
+  for (uint64_t v = begin; v < end; v++) {
+    memcpy(g->unique_col_idx + g->unique_row_ptr[v], g->col_idx + g->row_ptr[v],
+           g->degrees[v] * sizeof(uint32_t));
+  }
+}
+
+// Exclusive prefix sum of `degrees` into `row_ptr`; returns the total
+static uint64_t prefix_sum(const uint32_t *degrees, uint32_t *row_ptr,
+                           uint64_t n) {
+  uint64_t total = 0;
+  for (uint64_t v = 0; v < n; v++) {
+    row_ptr[v] = (uint32_t)total;
+    total += degrees[v];
+  }
+  row_ptr[n] = (uint32_t)total;
+  return total;
+}
+
+/**
+ * Builds the undirected CSR of the edge list, dropping self-loops and
+ * duplicate edges. Frees the edge list.
+ */
+static mmio_csr_u32_f32_t *edges_to_csr(Generator *g) {
+  uint64_t n = g->n;
+  g->degrees = (uint32_t *)calloc(n, sizeof(uint32_t));
+  parallel_for(g->m, count_degrees, g);
+  g->row_ptr = (uint32_t *)malloc((n + 1) * sizeof(uint32_t));
+  uint64_t total = 0;
+  for (uint64_t v = 0; v < n; v++) {
+    total += g->degrees[v];
+  }
+  if (total > UINT32_MAX) {
+    printf("The generated graph has %lu directed edges, more than the 32-bit "
+           "CSR can hold\n",
+           total);
+    free(g->src);
+    free(g->dst);
+    free(g->degrees);
+    free(g->row_ptr);
+    return NULL;
+  }
+  prefix_sum(g->degrees, g->row_ptr, n);
+  memcpy(g->degrees, g->row_ptr, n * sizeof(uint32_t));
+  g->col_idx = (uint32_t *)malloc(total * sizeof(uint32_t));
+  parallel_for(g->m, scatter_edges, g);
+  free(g->src);
+  free(g->dst);
+
+  parallel_for(n, sort_adjacency, g);
+  g->unique_row_ptr = (uint32_t *)malloc((n + 1) * sizeof(uint32_t));
+  uint64_t nnz = prefix_sum(g->degrees, g->unique_row_ptr, n);
+  g->unique_col_idx = (uint32_t *)malloc(nnz * sizeof(uint32_t));
+  parallel_for(n, compact_adjacency, g);
+  free(g->degrees);
+  free(g->row_ptr);
+  free(g->col_idx);
+
+  mmio_csr_u32_f32_t *graph =
+      (mmio_csr_u32_f32_t *)malloc(sizeof(mmio_csr_u32_f32_t));
+  graph->nrows = (uint32_t)n;
+  graph->ncols = (uint32_t)n;
+  graph->nnz = (uint32_t)nnz;
+  graph->row_ptr = g->unique_row_ptr;
+  graph->col_idx = g->unique_col_idx;
+  graph->val = NULL;
+  return graph;
+}
+
+static bool parse_value(const char *key, const char *value, GraphSpec *spec) {
+  char *end;
+  if (strcmp(key, "drop") == 0 || strcmp(key, "r") == 0) {
+    double d = strtod(value, &end);
+    if (*value == '\0' || *end != '\0') {
+      return false;
+    }
+    *(strcmp(key, "drop") == 0 ? &spec->drop : &spec->radius) = d;
+    return true;
+  }
+  uint64_t *dest = strcmp(key, "scale") == 0  ? &spec->scale
+                   : strcmp(key, "ef") == 0   ? &spec->ef
+                   : strcmp(key, "x") == 0    ? &spec->x
+                   : strcmp(key, "y") == 0    ? &spec->y
+                   : strcmp(key, "z") == 0    ? &spec->z
+                   : strcmp(key, "seed") == 0 ? &spec->seed
+                                              : NULL;
+  if (dest == NULL || *value == '\0' || *value == '-') {
+    return false;
+  }
+  *dest = strtoull(value, &end, 10);
+  return *end == '\0';
+}
+
+static bool parse_spec(const char *text, GraphSpec *spec) {
+  *spec = (GraphSpec){.scale = 16, .ef = 16, .x = 1024, .y = 1024, .z = 1,
+                      .seed = SEED, .drop = 0, .radius = 0};
+  const char *colon = strchr(text, ':');
+  size_t length = colon != NULL ? (size_t)(colon - text) : strlen(text);
+  if (length >= sizeof(spec->name)) {
+    printf("Unknown graph generator in [%s]\n", text);
+    return false;
+  }
+  memcpy(spec->name, text, length);
+  spec->name[length] = '\0';
+  if (strcmp(spec->name, "kron") != 0 && strcmp(spec->name, "uniform") != 0 &&
+      strcmp(spec->name, "grid") != 0 && strcmp(spec->name, "rgg") != 0) {
+    printf("Unknown graph generator [%s], expected kron, uniform, grid or "
+           "rgg\n",
+           spec->name);
+    return false;
+  }
+  if (colon != NULL) {
+    char *params = strdup(colon + 1);
+    char *saveptr;
+    for (char *param = strtok_r(params, ",", &saveptr); param != NULL;
+         param = strtok_r(NULL, ",", &saveptr)) {
+      char *value = strchr(param, '=');
+      if (value != NULL) {
+        *value++ = '\0';
+      }
+      if (value == NULL || !parse_value(param, value, spec)) {
+        printf("Invalid generator parameter [%s] in [%s]\n", param, text);
+        free(params);
+        return false;
+      }
+    }
+    free(params);
+  }
+  if (strcmp(spec->name, "grid") == 0) {
+    if (spec->x == 0 || spec->y == 0 || spec->z == 0 ||
+        spec->x * spec->y * spec->z >= NO_VERTEX) {
+      printf("The grid needs between 1 and 2^32 - 1 vertices\n");
+      return false;
+    }
+  } else if (spec->scale == 0 || spec->scale > 31) {
+    printf("The scale must be between 1 and 31\n");
+    return false;
+  }
+  if (spec->drop < 0 || spec->drop > 1 || spec->radius < 0) {
+    printf("The drop probability must be in [0, 1] and the radius "
+           "non-negative\n");
+    return false;
+  }
+  return true;
+}
+
+mmio_csr_u32_f32_t *generate_graph(const char *spec) {
+  Generator g;
+  memset(&g, 0, sizeof(g));
+  if (!parse_spec(spec, &g.spec)) {
+    return NULL;
+  }
+  if (strcmp(g.spec.name, "grid") == 0) {
+    g.n = g.spec.x * g.spec.y * g.spec.z;
+    g.m = 3 * g.n;
+  } else {
+    g.n = 1ULL << g.spec.scale;
+    g.m = g.spec.ef * g.n;
+  }
+
+  if (strcmp(g.spec.name, "rgg") == 0) {
+    if (g.spec.radius == 0) {
+      g.spec.radius = 0.55 * sqrt(log((double)g.n) / g.n);
+    }
+    rgg_edges(&g);
+  } else {
+    g.src = (uint32_t *)malloc(g.m * sizeof(uint32_t));
+    g.dst = (uint32_t *)malloc(g.m * sizeof(uint32_t));
+    if (strcmp(g.spec.name, "kron") == 0) {
+      g.mask = g.n - 1;
+      g.scramble1 = mix64(g.spec.seed + 1) | 1;
+      g.scramble2 = mix64(g.spec.seed + 2) | 1;
+      parallel_for(g.m, kron_edges, &g);
+    } else if (strcmp(g.spec.name, "uniform") == 0) {
+      parallel_for(g.m, uniform_edges, &g);
+    } else {
+      parallel_for(g.m, grid_edges, &g);
+    }
+  }
+  return edges_to_csr(&g);
+}
@@ -0,0 +1,37 @@
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+/**
+ * @brief Synthetic graphs generated in parallel directly in CSR form, without
+ * going through a Matrix Market file.
+ *
+ * A generator is selected by a spec of the form `name:key=value,...`:
+ *  - kron:scale=S,ef=E      Graph500 Kronecker (R-MAT with A=0.57,
+ *                           B=C=0.19) with 2^S vertices and E*2^S edges
+ *  - uniform:scale=S,ef=E   Uniform random (Erdos-Renyi) graph of the same
+ *                           size
+ *  - grid:x=X,y=Y,z=Z,drop=P  2D (z=1) or 3D lattice in row-major order, each
+ *                           edge removed with probability P (road-like)
+ *  - rgg:scale=S,r=R        Random geometric graph of 2^S points in the unit
+ *                           square, connected within distance R
+ *                           (0.55 * sqrt(ln(n) / n) by default)
+ * Every generator also accepts seed=N. Missing keys take the defaults scale=16,
+ * ef=16, x=y=1024, z=1, drop=0.
+ *
+ * The graphs are undirected: symmetric, without self-loops or duplicate edges
+ * and with sorted adjacency lists, and have no values. Each random choice
+ * depends only on the seed and on the index of the edge (or vertex) it
+ * belongs to, so a spec always yields the same graph regardless of the number
+ * of threads, and the OpenMP engine generates the same graph from it.
+ */
+
+#include "mmio_c_wrapper.h"
+
+/**
+ * Generates the graph described by `spec`. Returns NULL, after printing why,
+ * if the spec is malformed or the graph has more than 2^32 - 1 edges. The
+ * arrays are allocated with malloc, like those of mmio_read_csr_u32_f32.
+ */
+mmio_csr_u32_f32_t *generate_graph(const char *spec);
+
+#endif // GENERATORS_H
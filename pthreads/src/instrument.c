@@ -0,0 +1,110 @@
+#define _GNU_SOURCE
+#include "instrument.h"
+
+#ifdef INSTRUMENT
+#include "config.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Thread_local uint64_t instrument_contended = 0;
+
+typedef struct {
+  LevelStats *levels;
+  uint32_t capacity; // Allocated levels
+  uint32_t used;     // Levels touched in the current run
+} ThreadStats;
+
+static ThreadStats thread_stats[MAX_THREADS];
+
+LevelStats *instrument_level(int thread_id, uint32_t level) {
+  ThreadStats *t = &thread_stats[thread_id];
+  if (level >= t->capacity) {
+    uint32_t capacity = t->capacity == 0 ? 64 : t->capacity;
+    while (capacity <= level) {
+      capacity *= 2;
+    }
+    t->levels = (LevelStats *)realloc(t->levels, capacity * sizeof(LevelStats));
+    memset(t->levels + t->capacity, 0,
+           (capacity - t->capacity) * sizeof(LevelStats));
+    t->capacity = capacity;
+  }
+  if (level >= t->used) {
+    t->used = level + 1;
+  }
+  return &t->levels[level];
+}
+
+void instrument_reset() {
+  for (int i = 0; i < MAX_THREADS; i++) {
+    if (thread_stats[i].levels != NULL) {
+      memset(thread_stats[i].levels, 0,
+             thread_stats[i].capacity * sizeof(LevelStats));
+    }
+    thread_stats[i].used = 0;
+  }
+}
+
+static bool level_is_empty(uint32_t level) {
+  for (int i = 0; i < MAX_THREADS; i++) {
+    if (level < thread_stats[i].used &&
+        thread_stats[i].levels[level].vertices > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void instrument_write(FILE *f, int run_id, bool json, bool first) {
+  uint32_t levels = 0;
+  for (int i = 0; i < MAX_THREADS; i++) {
+    if (thread_stats[i].used > levels) {
+      levels = thread_stats[i].used;
+    }
+  }
+  // With pipelined levels the threads touch the level after the last one
+  // while waiting for the final barrier
+  while (levels > 0 && level_is_empty(levels - 1)) {
+    levels--;
+  }
+  if (first && !json) {
+    fprintf(f, "run_id,level,thread,vertices,edges,own_chunks,stolen_chunks,"
+               "contended_locks,processing_s,stealing_s,barrier_s\n");
+  }
+  LevelStats empty = {0};
+  for (uint32_t level = 0; level < levels; level++) {
+    for (int i = 0; i < MAX_THREADS; i++) {
+      const LevelStats *s = level < thread_stats[i].used
+                                ? &thread_stats[i].levels[level]
+                                : &empty;
+      if (json) {
+        fprintf(f,
+                "%s\n  {\"run_id\": %d, \"level\": %u, \"thread\": %d, "
+                "\"vertices\": %lu, \"edges\": %lu, \"own_chunks\": %lu, "
+                "\"stolen_chunks\": %lu, \"contended_locks\": %lu, "
+                "\"processing_s\": %.9f, \"stealing_s\": %.9f, "
+                "\"barrier_s\": %.9f}",
+                first ? "" : ",", run_id, level, i, s->vertices, s->edges,
+                s->own_chunks, s->stolen_chunks, s->contended,
+                s->processing_ns * 1e-9, s->stealing_ns * 1e-9,
+                s->barrier_ns * 1e-9);
+        first = false;
+      } else {
+        fprintf(f, "%d,%u,%d,%lu,%lu,%lu,%lu,%lu,%.9f,%.9f,%.9f\n", run_id,
+                level, i, s->vertices, s->edges, s->own_chunks,
+                s->stolen_chunks, s->contended, s->processing_ns * 1e-9,
+                s->stealing_ns * 1e-9, s->barrier_ns * 1e-9);
+      }
+    }
+  }
+}
+
+void instrument_destroy() {
+  for (int i = 0; i < MAX_THREADS; i++) {
+    free(thread_stats[i].levels);
+    thread_stats[i].levels = NULL;
+    thread_stats[i].capacity = 0;
+    thread_stats[i].used = 0;
+  }
+}
+#endif
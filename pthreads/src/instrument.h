@@ -0,0 +1,60 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+/**
+ * @brief Per-level, per-thread counters of the level-synchronous BFS.
+ *
+ * The INSTRUMENT_ONLY hooks are compiled in by `make INSTRUMENT=1` only.
+ * Each thread owns an array of LevelStats indexed by level (grown on demand),
+ * so recording needs no synchronization. Lock contention is counted in
+ * frontier_remove_chunk with a trylock before the blocking lock, into a
+ * thread-local counter that the owner moves into its level at the barrier.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef INSTRUMENT
+#define INSTRUMENT_ONLY(...) __VA_ARGS__
+
+typedef struct {
+  uint64_t vertices;       // Frontier vertices expanded
+  uint64_t edges;          // Edges scanned
+  uint64_t own_chunks;     // Chunks taken from the thread's own pool
+  uint64_t stolen_chunks;  // Chunks stolen from other threads
+  uint64_t contended;      // Chunk pool locks found already taken
+  uint64_t processing_ns;  // Time expanding chunks
+  uint64_t stealing_ns;    // Time looking for chunks to steal
+  uint64_t barrier_ns;     // Time waiting for the other threads
+} LevelStats;
+
+extern _Thread_local uint64_t instrument_contended;
+
+/**
+ * Returns the counters of `thread_id` for `level` (0 for the source's
+ * neighbors). Must be called by thread `thread_id` only.
+ */
+LevelStats *instrument_level(int thread_id, uint32_t level);
+
+/**
+ * Clears the counters of all threads before a new run.
+ */
+void instrument_reset();
+
+/**
+ * Appends the counters of run `run_id` to `f`, one record per level and
+ * thread, as CSV rows or as JSON objects of an array. `first` is true for the
+ * first run written to the file (CSV header, no leading comma in JSON).
+ */
+void instrument_write(FILE *f, int run_id, bool json, bool first);
+
+/**
+ * Frees the counters of all threads.
+ */
+void instrument_destroy();
+#else
+#define INSTRUMENT_ONLY(...)
+#endif
+
+#endif // INSTRUMENT_H
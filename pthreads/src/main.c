@@ -0,0 +1,1183 @@
+#define _GNU_SOURCE
+#include "async_bfs.h"
+#include "bc.h"
+#include "bfs.h"
+#include "cc.h"
+#include "cli_parser.h"
+#include "config.h"
+#include "debug_utils.h"
+#include "dynamic.h"
+#include "energy.h"
+#include "generators.h"
+#include "instrument.h"
+#include "memory_report.h"
+#include "merged_csr.h"
+#include "mmio_c_wrapper.h"
+#include "msbfs.h"
+#include "mt19937-64.h"
+#include "p2p.h"
+#include "perf_counters.h"
+#include "server.h"
+#include "shared_graph.h"
+#include "sssp.h"
+#include "throughput.h"
+#include "trace.h"
+#include "utils.h"
+#include "validate.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef USE_PAPI
+#include "papi.h"
+#endif
+
+/**
+ * Picks `runs` random sources with at least one neighbor (or repeats `source`
+ * if one is given). If `components` is not NULL, random sources are restricted
+ * to the vertices labeled `component`.
+ */
+uint32_t *generate_sources(const mmio_csr_u32_f32_t *graph, int runs,
+                           uint32_t num_vertices, uint32_t source,
+                           const uint32_t *components, uint32_t component) {
+  uint32_t *sources = (uint32_t *)malloc(runs * sizeof(uint32_t));
+  if (source != UINT32_MAX) {
+    for (int i = 0; i < runs; i++) {
+      sources[i] = source;
+    }
+  } else {
+    init_genrand64(SEED);
+    for (int i = 0; i < runs; i++) {
+      do {
+        uint64_t gen = genrand64_int64();
+        sources[i] = (uint32_t)gen % num_vertices;
+      } while (graph->row_ptr[sources[i] + 1] - graph->row_ptr[sources[i]] ==
+                   0 ||
+               (components != NULL && components[sources[i]] != component));
+    }
+  }
+  return sources;
+}
+
+typedef struct {
+  char *filename; // Will be allocated by the parser
+  char *generator; // Will be allocated by the parser
+  char *mode;     // Will be allocated by the parser
+  int runs;
+  int source_id;
+  int target_id;
+  int depth;
+  char *queries;  // Will be allocated by the parser
+  char *instrument; // Will be allocated by the parser
+  char *trace;      // Will be allocated by the parser
+  char *powercap;   // Will be allocated by the parser
+  char *publish;    // Will be allocated by the parser
+  char *attach;     // Will be allocated by the parser
+  char *socket;     // Will be allocated by the parser
+  double delta;
+  int batch_size;
+  bool check;
+  bool output;
+  bool reorder;
+  bool parents;
+  bool giant;
+  bool pipeline;
+  bool perf;
+  bool memory;
+  bool free_graph;
+} AppArgs;
+
+/**
+ * Bytes of the arrays of a CSR graph.
+ */
+static uint64_t csr_bytes(const mmio_csr_u32_f32_t *graph) {
+  uint64_t bytes = ((uint64_t)graph->nrows + 1) * sizeof(uint32_t);
+  if (graph->col_idx != NULL) {
+    bytes += (uint64_t)graph->nnz * sizeof(uint32_t);
+  }
+  if (graph->val != NULL) {
+    bytes += (uint64_t)graph->nnz * sizeof(float);
+  }
+  return graph->row_ptr != NULL ? bytes : 0;
+}
+
+/**
+ * Frees the arrays of a CSR graph, keeping its sizes.
+ */
+static void free_csr(mmio_csr_u32_f32_t *graph) {
+  free(graph->row_ptr);
+  free(graph->col_idx);
+  free(graph->val);
+  graph->row_ptr = NULL;
+  graph->col_idx = NULL;
+  graph->val = NULL;
+}
+
+// Merged CSR attached with --attach, NULL if the graph is loaded
+static SharedGraph *shared_graph = NULL;
+
+/**
+ * Starts the engine of the bfs, khop and diameter modes, on the attached
+ * shared graph if there is one.
+ */
+static void prepare_engine(const mmio_csr_u32_f32_t *graph) {
+  if (shared_graph != NULL) {
+    initialize_bfs_shared(shared_graph);
+  } else {
+    initialize_bfs(graph);
+  }
+}
+
+/**
+ * CSR of an attached shared graph with only the row pointers, recovered from
+ * the merged ones: the degrees are all that the modes need outside of the
+ * checks. col_idx is NULL.
+ */
+static mmio_csr_u32_f32_t *shared_graph_degrees(const SharedGraph *shared) {
+  const MergedCSR *merged = &shared->csr;
+  mmio_csr_u32_f32_t *graph =
+      (mmio_csr_u32_f32_t *)malloc(sizeof(mmio_csr_u32_f32_t));
+  graph->nrows = merged->num_vertices;
+  graph->ncols = merged->num_vertices;
+  graph->nnz = merged->num_edges;
+  graph->row_ptr = (uint32_t *)malloc(((size_t)graph->nrows + 1) *
+                                      sizeof(uint32_t));
+  for (uint32_t i = 0; i <= graph->nrows; i++) {
+    graph->row_ptr[i] = (merged->row_ptr[i] - i * METADATA_SIZE) / DATA_SIZE;
+  }
+  graph->col_idx = NULL;
+  graph->val = NULL;
+  return graph;
+}
+
+/**
+ * Number of directed edges scanned by a BFS: the degrees of the reached
+ * vertices (distances and parents are both UINT32_MAX for the others).
+ */
+static uint64_t traversed_edges(const mmio_csr_u32_f32_t *graph,
+                                const uint32_t *distances) {
+  uint64_t edges = 0;
+  for (uint32_t i = 0; i < graph->nrows; i++) {
+    if (distances[i] != UINT32_MAX) {
+      edges += graph->row_ptr[i + 1] - graph->row_ptr[i];
+    }
+  }
+  return edges;
+}
+
+/**
+ * Default mode: one parallel BFS per source.
+ */
+void run_bfs(mmio_csr_u32_f32_t *graph, const uint32_t *sources,
+             const AppArgs *args) {
+  distances = (uint32_t *)malloc(graph->nrows * sizeof(uint32_t));
+  memset(distances, UINT32_MAX, graph->nrows * sizeof(uint32_t));
+  reorder_frontier = args->reorder;
+  compute_parents = args->parents;
+  pipeline_levels = args->pipeline;
+  if (args->perf && perf_counters_init()) {
+    perf_begin(PERF_MAIN_THREAD, PERF_BUILD);
+  }
+  prepare_engine(graph);
+  if (perf_enabled) {
+    perf_end(PERF_MAIN_THREAD, PERF_BUILD);
+  }
+  if (args->free_graph) {
+    // Only the checks need the original CSR, the traversal uses the merged one
+    printf("Freed the source CSR (%.2f MiB) after building the merged CSR\n",
+           csr_bytes(graph) / (1024.0 * 1024.0));
+    free_csr(graph);
+  }
+#ifdef INSTRUMENT
+  // The per-level counters go to a CSV file, or to a JSON array if the file
+  // name ends in .json
+  FILE *instrument_file = NULL;
+  bool instrument_json = false;
+  if (args->instrument != NULL) {
+    instrument_file = fopen(args->instrument, "w");
+    if (instrument_file == NULL) {
+      printf("Failed to open instrumentation file [%s]\n", args->instrument);
+    }
+    size_t length = strlen(args->instrument);
+    instrument_json =
+        length >= 5 && strcmp(args->instrument + length - 5, ".json") == 0;
+    if (instrument_file != NULL && instrument_json) {
+      fprintf(instrument_file, "[");
+    }
+  }
+#endif
+#ifdef TRACE
+  FILE *trace_file = NULL;
+  if (args->trace != NULL) {
+    trace_file = fopen(args->trace, "w");
+    if (trace_file == NULL) {
+      printf("Failed to open trace file [%s]\n", args->trace);
+    } else {
+      trace_init();
+    }
+  }
+#endif
+  EnergyMeter *meter =
+      args->powercap != NULL ? energy_meter_create(args->powercap) : NULL;
+
+  struct timespec start, end;
+  double elapsed;
+  for (int i = 0; i < args->runs; i++) {
+    INSTRUMENT_ONLY(instrument_reset();)
+    if (meter != NULL) {
+      energy_meter_start(meter);
+    }
+    #ifndef USE_PAPI
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    #endif
+    TRACE_ONLY(uint64_t trace_start = monotonic_ns();)
+    bfs(sources[i]);
+    TRACE_ONLY(trace_event(MAX_THREADS, TRACE_RUN, 0, i, trace_start);)
+    #ifndef USE_PAPI
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double joules = meter != NULL ? energy_meter_stop(meter) : 0;
+    long seconds = end.tv_sec - start.tv_sec;
+    long nanoseconds = end.tv_nsec - start.tv_nsec;
+    elapsed = seconds + nanoseconds * 1e-9;
+
+    printf("run_id=%d,diameter=%d,threads=%d,chunk_size=%d,max_chunks=%d,"
+           "source=%d,",
+           i, distance, MAX_THREADS, CHUNK_SIZE, max_chunks, sources[i]);
+    if (meter != NULL) {
+      // GTEPS per watt is the number of (billion) edges per joule
+      double gteps_per_watt =
+          joules > 0 ? traversed_edges(graph, distances) * 1e-9 / joules : 0;
+      printf("joules=%.4f,gteps_per_watt=%.6f,", joules, gteps_per_watt);
+    }
+    printf("%.4f\n", elapsed);
+    if (perf_enabled) {
+      // The merged CSR is built once, its counters come with the first run
+      if (i == 0) {
+        perf_print(i, PERF_BUILD);
+      }
+      perf_print(i, PERF_TRAVERSAL);
+      perf_print(i, PERF_FINALIZE);
+      perf_reset();
+    }
+#ifdef INSTRUMENT
+    if (instrument_file != NULL) {
+      instrument_write(instrument_file, i, instrument_json, i == 0);
+    }
+#endif
+
+    if (args->check) {
+      if (compute_parents) {
+        validate_parents(graph, distances, sources[i]);
+      } else {
+        validate_distances(graph, distances, sources[i]);
+      }
+    }
+
+    memset(distances, UINT32_MAX, graph->nrows * sizeof(uint32_t));
+    #endif
+  }
+#ifdef INSTRUMENT
+  if (instrument_file != NULL) {
+    if (instrument_json) {
+      fprintf(instrument_file, "\n]\n");
+    }
+    fclose(instrument_file);
+  }
+  instrument_destroy();
+#endif
+#ifdef TRACE
+  if (trace_file != NULL) {
+    trace_write(trace_file);
+    fclose(trace_file);
+    printf("Trace written to %s\n", args->trace);
+  }
+  trace_destroy();
+#endif
+  if (args->memory) {
+    MemoryItem items[MAX_MEMORY_ITEMS];
+    int num_items = 0;
+    items[num_items++] = (MemoryItem){"csr", csr_bytes(graph)};
+    num_items += bfs_memory_usage(items + num_items);
+    items[num_items++] = (MemoryItem){
+        "distances", (uint64_t)graph->nrows * sizeof(uint32_t)};
+    memory_report(items, num_items, graph->nnz);
+  }
+  if (perf_enabled) {
+    perf_counters_destroy();
+  }
+  if (meter != NULL) {
+    energy_meter_destroy(meter);
+  }
+  destroy_bfs();
+  free(distances);
+}
+
+/**
+ * Server mode: keeps the engine started and answers the queries sent to the
+ * socket given with -S until interrupted (see server.h).
+ */
+void run_server(mmio_csr_u32_f32_t *graph, const AppArgs *args) {
+  prepare_engine(graph);
+  if (args->free_graph) {
+    printf("Freed the source CSR (%.2f MiB) after building the merged CSR\n",
+           csr_bytes(graph) / (1024.0 * 1024.0));
+    free_csr(graph);
+  }
+  serve(args->socket, graph->nrows, graph->nnz, args->reorder,
+        args->pipeline);
+  destroy_bfs();
+}
+
+/**
+ * Asynchronous mode: one barrier-free label-correcting BFS per run.
+ */
+void run_async(const mmio_csr_u32_f32_t *graph, const uint32_t *sources,
+               const AppArgs *args) {
+  distances = (uint32_t *)malloc(graph->nrows * sizeof(uint32_t));
+  initialize_async_bfs(graph);
+
+  struct timespec start, end;
+  for (int i = 0; i < args->runs; i++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t updates = async_bfs(sources[i], distances);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long seconds = end.tv_sec - start.tv_sec;
+    long nanoseconds = end.tv_nsec - start.tv_nsec;
+    double elapsed = seconds + nanoseconds * 1e-9;
+
+    printf("run_id=%d,updates=%lu,threads=%d,chunk_size=%d,source=%d,%.4f\n",
+           i, (unsigned long)updates, MAX_THREADS, CHUNK_SIZE, sources[i],
+           elapsed);
+
+    if (args->check) {
+      validate_distances(graph, distances, sources[i]);
+    }
+  }
+  destroy_async_bfs();
+  free(distances);
+}
+
+/**
+ * k-hop mode: one depth-bounded parallel BFS per run.
+ */
+void run_khop(const mmio_csr_u32_f32_t *graph, const uint32_t *sources,
+              const AppArgs *args) {
+  uint32_t *ids = (uint32_t *)malloc(graph->nrows * sizeof(uint32_t));
+  uint32_t *depths = (uint32_t *)malloc(graph->nrows * sizeof(uint32_t));
+  prepare_engine(graph);
+
+  struct timespec start, end;
+  for (int i = 0; i < args->runs; i++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t reached = bfs_bounded(sources[i], args->depth, ids, depths);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long seconds = end.tv_sec - start.tv_sec;
+    long nanoseconds = end.tv_nsec - start.tv_nsec;
+    double elapsed = seconds + nanoseconds * 1e-9;
+
+    printf("run_id=%d,depth=%d,reached=%u,threads=%d,source=%d,%.6f\n", i,
+           args->depth, reached, MAX_THREADS, sources[i], elapsed);
+
+    if (args->check) {
+      check_khop(graph, ids, depths, reached, sources[i], args->depth);
+    }
+  }
+  destroy_bfs();
+  free(ids);
+  free(depths);
+}
+
+/**
+ * Runs one BFS of the diameter estimation, tightening the bounds with the
+ * eccentricity of `source` (diam >= ecc(source) and diam <= 2 * ecc(source)).
+ */
+static uint32_t diameter_step(uint32_t source, uint32_t *farthest, int *runs,
+                              uint32_t *lower, uint32_t *upper) {
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  uint32_t eccentricity = bfs_eccentricity(source, farthest);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  long seconds = end.tv_sec - start.tv_sec;
+  long nanoseconds = end.tv_nsec - start.tv_nsec;
+  double elapsed = seconds + nanoseconds * 1e-9;
+
+  if (eccentricity > *lower) {
+    *lower = eccentricity;
+  }
+  if (2 * eccentricity < *upper) {
+    *upper = 2 * eccentricity;
+  }
+  printf("run_id=%d,source=%u,eccentricity=%u,lower=%u,upper=%u,%.4f\n",
+         (*runs)++, source, eccentricity, *lower, *upper, elapsed);
+  return eccentricity;
+}
+
+/**
+ * Diameter mode: computes the diameter of the component of the first source
+ * by chaining BFSs on the engine (the merged CSR is prepared once). A double
+ * sweep gives a lower bound and a vertex in the middle of a long shortest
+ * path; iFUB then runs BFSs from the vertices farthest from that vertex, one
+ * level at a time, until the lower and upper bounds meet.
+ */
+void run_diameter(const mmio_csr_u32_f32_t *graph, const uint32_t *sources,
+                  const AppArgs *args) {
+  uint32_t n = graph->nrows;
+  distances = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *saved = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *fringe = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *level_starts = (uint32_t *)calloc(n + 2, sizeof(uint32_t));
+  compute_parents = false;
+  prepare_engine(graph);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int runs = 0;
+  uint32_t lower = 0, upper = UINT32_MAX;
+
+  // Double sweep: a is far from the source, b is far from a
+  uint32_t a, b, farthest;
+  diameter_step(sources[0], &a, &runs, &lower, &upper);
+  uint32_t ecc_a = diameter_step(a, &b, &runs, &lower, &upper);
+  memcpy(saved, distances, n * sizeof(uint32_t));
+  diameter_step(b, &farthest, &runs, &lower, &upper);
+  // Middle of the a-b shortest path: on the path (d_a + d_b = d(a, b)) and
+  // halfway from a
+  uint32_t u = a;
+  for (uint32_t v = 0; v < n; v++) {
+    if (saved[v] == ecc_a / 2 && distances[v] != UINT32_MAX &&
+        saved[v] + distances[v] == ecc_a) {
+      u = v;
+      break;
+    }
+  }
+
+  // iFUB from u: group the vertices by their distance from u
+  uint32_t ecc_u = diameter_step(u, &farthest, &runs, &lower, &upper);
+  for (uint32_t v = 0; v < n; v++) {
+    if (distances[v] != UINT32_MAX) {
+      level_starts[distances[v] + 1]++;
+    }
+  }
+  for (uint32_t i = 1; i <= ecc_u + 1; i++) {
+    level_starts[i] += level_starts[i - 1];
+  }
+  memcpy(saved, level_starts, (ecc_u + 2) * sizeof(uint32_t));
+  for (uint32_t v = 0; v < n; v++) {
+    if (distances[v] != UINT32_MAX) {
+      fringe[saved[distances[v]]++] = v;
+    }
+  }
+
+  // Two vertices closer to u than level i are at most 2(i - 1) apart, so
+  // once a vertex of level i has a larger eccentricity it is the diameter
+  for (uint32_t i = ecc_u; i > 0 && lower < upper; i--) {
+    for (uint32_t k = level_starts[i]; k < level_starts[i + 1]; k++) {
+      diameter_step(fringe[k], &farthest, &runs, &lower, &upper);
+      if (lower > 2 * (i - 1)) {
+        break;
+      }
+    }
+    if (lower > 2 * (i - 1)) {
+      upper = lower;
+    } else if (2 * (i - 1) < upper) {
+      upper = 2 * (i - 1);
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  long seconds = end.tv_sec - start.tv_sec;
+  long nanoseconds = end.tv_nsec - start.tv_nsec;
+  double elapsed = seconds + nanoseconds * 1e-9;
+  printf("diameter=%u,bfs_runs=%d,threads=%d,source=%u,%.4f\n", lower, runs,
+         MAX_THREADS, sources[0], elapsed);
+
+  if (args->check) {
+    check_diameter(graph, sources[0], lower);
+  }
+
+  destroy_bfs();
+  free(distances);
+  free(saved);
+  free(fringe);
+  free(level_starts);
+}
+
+/**
+ * Dynamic mode: computes the distances from the first source once, then
+ * inserts one batch of random edges per run and repairs the distances
+ * incrementally.
+ */
+void run_dynamic(const mmio_csr_u32_f32_t *graph, const uint32_t *sources,
+                 const AppArgs *args) {
+  uint32_t *edges = (uint32_t *)malloc((size_t)args->runs * args->batch_size *
+                                       2 * sizeof(uint32_t));
+  uint32_t *current = (uint32_t *)malloc(graph->nrows * sizeof(uint32_t));
+  initialize_dynamic(graph);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  DynamicStats stats = dynamic_bfs(sources[0]);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  long seconds = end.tv_sec - start.tv_sec;
+  long nanoseconds = end.tv_nsec - start.tv_nsec;
+  double elapsed = seconds + nanoseconds * 1e-9;
+  printf("initial,rounds=%u,reached=%u,threads=%d,source=%u,%.4f\n",
+         stats.rounds, stats.updated, MAX_THREADS, sources[0], elapsed);
+
+  // A different seed than the sources, so that edges are not biased towards
+  // them
+  init_genrand64(SEED + 1);
+  for (int i = 0; i < args->runs; i++) {
+    uint32_t *batch = &edges[(size_t)i * args->batch_size * 2];
+    for (int k = 0; k < 2 * args->batch_size; k++) {
+      batch[k] = (uint32_t)genrand64_int64() % graph->nrows;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    stats = dynamic_insert(batch, args->batch_size);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = end.tv_sec - start.tv_sec;
+    nanoseconds = end.tv_nsec - start.tv_nsec;
+    elapsed = seconds + nanoseconds * 1e-9;
+
+    printf("run_id=%d,inserted=%d,rounds=%u,updated=%u,threads=%d,source=%u,"
+           "%.6f\n",
+           i, args->batch_size, stats.rounds, stats.updated, MAX_THREADS,
+           sources[0], elapsed);
+
+    if (args->check) {
+      dynamic_distances(current);
+      check_dynamic(graph, edges, (uint32_t)(i + 1) * args->batch_size,
+                    current, sources[0]);
+    }
+  }
+  destroy_dynamic();
+  free(edges);
+  free(current);
+}
+
+/**
+ * Multi-source mode: the sources are traversed in batches of
+ * MSBFS_BATCH_SIZE, each batch in a single MS-BFS.
+ */
+void run_msbfs(const mmio_csr_u32_f32_t *graph, const uint32_t *sources,
+               const AppArgs *args) {
+  uint32_t *batch_distances = (uint32_t *)malloc(
+      (size_t)MSBFS_BATCH_SIZE * graph->nrows * sizeof(uint32_t));
+  initialize_msbfs(graph);
+
+  struct timespec start, end;
+  for (int i = 0; i < args->runs; i += MSBFS_BATCH_SIZE) {
+    int batch_size = args->runs - i < MSBFS_BATCH_SIZE ? args->runs - i
+                                                       : MSBFS_BATCH_SIZE;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int levels = msbfs(&sources[i], batch_size, batch_distances);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long seconds = end.tv_sec - start.tv_sec;
+    long nanoseconds = end.tv_nsec - start.tv_nsec;
+    double elapsed = seconds + nanoseconds * 1e-9;
+
+    printf("batch_id=%d,sources=%d,levels=%d,threads=%d,chunk_size=%d,%.4f\n",
+           i / MSBFS_BATCH_SIZE, batch_size, levels, MAX_THREADS, CHUNK_SIZE,
+           elapsed);
+
+    if (args->check) {
+      for (int k = 0; k < batch_size; k++) {
+        validate_distances(graph, &batch_distances[(size_t)k * graph->nrows],
+                           sources[i + k]);
+      }
+    }
+  }
+  destroy_msbfs();
+  free(batch_distances);
+}
+
+static void check_query(int query, const uint32_t *distances, void *ctx) {
+  const mmio_csr_u32_f32_t *graph = ((void **)ctx)[0];
+  const uint32_t *sources = ((void **)ctx)[1];
+  check_bfs_correctness(graph, distances, sources[query]);
+}
+
+/**
+ * Throughput mode: the runs are independent queries answered concurrently, one
+ * sequential BFS per worker. Reports the latency of each query and the overall
+ * throughput.
+ */
+void run_throughput(const mmio_csr_u32_f32_t *graph, const uint32_t *sources,
+                    const AppArgs *args) {
+  MergedCSR *throughput_csr = to_merged_csr(graph);
+  QueryStats *stats = (QueryStats *)malloc(args->runs * sizeof(QueryStats));
+  initialize_throughput(throughput_csr);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  throughput_run(sources, NULL, args->runs, stats, NULL, NULL);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  long seconds = end.tv_sec - start.tv_sec;
+  long nanoseconds = end.tv_nsec - start.tv_nsec;
+  double elapsed = seconds + nanoseconds * 1e-9;
+
+  double total_latency = 0;
+  for (int i = 0; i < args->runs; i++) {
+    printf("run_id=%d,diameter=%u,visited=%u,source=%d,%.6f\n", i,
+           stats[i].levels, stats[i].visited, sources[i], stats[i].latency);
+    total_latency += stats[i].latency;
+  }
+  printf("queries=%d,threads=%d,qps=%.2f,avg_latency=%.6f,%.4f\n", args->runs,
+         MAX_THREADS, args->runs / elapsed,
+         args->runs > 0 ? total_latency / args->runs : 0, elapsed);
+
+  if (args->check) {
+    // The check runs on the workers after each query, so the queries are
+    // answered again, outside of the timed run
+    const void *ctx[] = {graph, sources};
+    throughput_run(sources, NULL, args->runs, stats, check_query,
+                   (void *)ctx);
+  }
+
+  destroy_throughput();
+  free(stats);
+  destroy_merged_csr(throughput_csr);
+}
+
+/**
+ * Point-to-point mode: one bidirectional shortest path query per run. Without
+ * an explicit target, targets are drawn from the same random sequence as the
+ * sources.
+ */
+void run_p2p(const mmio_csr_u32_f32_t *graph, const uint32_t *sources,
+             const uint32_t *components, uint32_t component,
+             const AppArgs *args) {
+  uint32_t *targets =
+      generate_sources(graph, 2 * args->runs, graph->nrows, args->target_id,
+                       components, component);
+  uint32_t *path = (uint32_t *)malloc(graph->nrows * sizeof(uint32_t));
+  initialize_p2p(graph);
+
+  struct timespec start, end;
+  for (int i = 0; i < args->runs; i++) {
+    uint32_t target = targets[args->runs + i];
+    uint32_t explored;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int hops = p2p_shortest_path(sources[i], target, path, &explored);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long seconds = end.tv_sec - start.tv_sec;
+    long nanoseconds = end.tv_nsec - start.tv_nsec;
+    double elapsed = seconds + nanoseconds * 1e-9;
+
+    printf("run_id=%d,hops=%d,explored=%u,threads=%d,source=%d,target=%d,%.6f\n",
+           i, hops, explored, MAX_THREADS, sources[i], target, elapsed);
+
+    if (args->check) {
+      check_path(graph, path, hops, sources[i], target);
+    }
+  }
+  destroy_p2p();
+  free(path);
+  free(targets);
+}
+
+/**
+ * SSSP mode: one delta-stepping shortest paths computation per run, on the
+ * edge weights of the graph (1 for pattern graphs).
+ */
+void run_sssp(const mmio_csr_u32_f32_t *graph, const uint32_t *sources,
+              const AppArgs *args) {
+  float *weighted_distances = (float *)malloc(graph->nrows * sizeof(float));
+  initialize_sssp(graph);
+  float delta = args->delta > 0 ? args->delta : sssp_average_weight();
+
+  struct timespec start, end;
+  for (int i = 0; i < args->runs; i++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t phases = sssp(sources[i], delta, weighted_distances);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long seconds = end.tv_sec - start.tv_sec;
+    long nanoseconds = end.tv_nsec - start.tv_nsec;
+    double elapsed = seconds + nanoseconds * 1e-9;
+
+    printf("run_id=%d,phases=%u,delta=%.4f,threads=%d,chunk_size=%d,source=%d,"
+           "%.4f\n",
+           i, phases, delta, MAX_THREADS, CHUNK_SIZE, sources[i], elapsed);
+
+    if (args->check) {
+      check_sssp(graph, weighted_distances, sources[i]);
+    }
+  }
+  destroy_sssp();
+  free(weighted_distances);
+}
+
+/**
+ * Connected components mode: one Afforest run per run. Reports the number of
+ * components and the size of the largest one.
+ */
+void run_cc(const mmio_csr_u32_f32_t *graph, const AppArgs *args) {
+  uint32_t *components = (uint32_t *)malloc(graph->nrows * sizeof(uint32_t));
+  uint32_t *sizes = (uint32_t *)malloc(graph->nrows * sizeof(uint32_t));
+  initialize_cc(graph);
+
+  struct timespec start, end;
+  for (int i = 0; i < args->runs; i++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t num_components = cc(components);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long seconds = end.tv_sec - start.tv_sec;
+    long nanoseconds = end.tv_nsec - start.tv_nsec;
+    double elapsed = seconds + nanoseconds * 1e-9;
+
+    memset(sizes, 0, graph->nrows * sizeof(uint32_t));
+    uint32_t largest = 0;
+    for (uint32_t v = 0; v < graph->nrows; v++) {
+      if (++sizes[components[v]] > largest) {
+        largest = sizes[components[v]];
+      }
+    }
+    printf("run_id=%d,components=%u,largest=%u,threads=%d,%.4f\n", i,
+           num_components, largest, MAX_THREADS, elapsed);
+
+    if (args->check) {
+      check_components(graph, components, num_components);
+    }
+  }
+  destroy_cc();
+  free(components);
+  free(sizes);
+}
+
+/**
+ * Betweenness centrality mode: accumulates the dependencies of the sampled
+ * sources (one Brandes iteration per run) into a single score per vertex.
+ */
+void run_bc(const mmio_csr_u32_f32_t *graph, const uint32_t *sources,
+            const AppArgs *args) {
+  float *scores = (float *)calloc(graph->nrows, sizeof(float));
+  initialize_bc(graph);
+
+  struct timespec start, end;
+  double total = 0;
+  for (int i = 0; i < args->runs; i++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t depth = bc(sources[i], scores);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long seconds = end.tv_sec - start.tv_sec;
+    long nanoseconds = end.tv_nsec - start.tv_nsec;
+    double elapsed = seconds + nanoseconds * 1e-9;
+    total += elapsed;
+
+    printf("run_id=%d,diameter=%u,threads=%d,chunk_size=%d,source=%d,%.4f\n",
+           i, depth, MAX_THREADS, CHUNK_SIZE, sources[i], elapsed);
+  }
+  uint32_t top = 0;
+  for (uint32_t v = 1; v < graph->nrows; v++) {
+    if (scores[v] > scores[top]) {
+      top = v;
+    }
+  }
+  printf("sources=%d,threads=%d,top_vertex=%u,top_score=%.2f,%.4f\n",
+         args->runs, MAX_THREADS, top, graph->nrows > 0 ? scores[top] : 0,
+         total);
+
+  if (args->check) {
+    check_bc(graph, scores, sources, args->runs);
+  }
+  destroy_bc();
+  free(scores);
+}
+
+static void check_khop_query(int query, const uint32_t *distances,
+                             void *ctx) {
+  const mmio_csr_u32_f32_t *graph = ((void **)ctx)[0];
+  const uint32_t *sources = ((void **)ctx)[1];
+  const uint32_t *depths = ((void **)ctx)[2];
+  check_khop_distances(graph, distances, sources[query], depths[query]);
+}
+
+/**
+ * Reads (source, depth) pairs, one per line, from a text file. Returns the
+ * number of pairs read and allocates `sources` and `depths`.
+ */
+int read_khop_queries(const char *filename, uint32_t **sources,
+                      uint32_t **depths, uint32_t num_vertices) {
+  FILE *file = fopen(filename, "r");
+  if (file == NULL) {
+    return -1;
+  }
+  int count = 0, capacity = 1024;
+  *sources = (uint32_t *)malloc(capacity * sizeof(uint32_t));
+  *depths = (uint32_t *)malloc(capacity * sizeof(uint32_t));
+  uint32_t source, depth;
+  while (fscanf(file, "%u %u", &source, &depth) == 2) {
+    if (source >= num_vertices) {
+      printf("Skipping query with out of bounds source %u\n", source);
+      continue;
+    }
+    if (count == capacity) {
+      capacity *= 2;
+      *sources = (uint32_t *)realloc(*sources, capacity * sizeof(uint32_t));
+      *depths = (uint32_t *)realloc(*depths, capacity * sizeof(uint32_t));
+    }
+    (*sources)[count] = source;
+    (*depths)[count] = depth;
+    count++;
+  }
+  fclose(file);
+  return count;
+}
+
+/**
+ * Batched k-hop mode: many (source, depth) queries answered concurrently, one
+ * sequential depth-bounded BFS per worker. Queries are read from the file
+ * given with -q, or are the random sources with the depth given with -k.
+ */
+void run_khop_batch(const mmio_csr_u32_f32_t *graph, const uint32_t *sources,
+                    const AppArgs *args) {
+  uint32_t *query_sources, *query_depths;
+  int num_queries = args->runs;
+  if (args->queries != NULL) {
+    num_queries = read_khop_queries(args->queries, &query_sources,
+                                    &query_depths, graph->nrows);
+    if (num_queries < 0) {
+      printf("Failed to read queries from file [%s]\n", args->queries);
+      return;
+    }
+  } else {
+    query_sources = (uint32_t *)malloc(num_queries * sizeof(uint32_t));
+    query_depths = (uint32_t *)malloc(num_queries * sizeof(uint32_t));
+    for (int i = 0; i < num_queries; i++) {
+      query_sources[i] = sources[i];
+      query_depths[i] = args->depth;
+    }
+  }
+  MergedCSR *throughput_csr = to_merged_csr(graph);
+  QueryStats *stats = (QueryStats *)malloc(num_queries * sizeof(QueryStats));
+  initialize_throughput(throughput_csr);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  throughput_run(query_sources, query_depths, num_queries, stats, NULL, NULL);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  long seconds = end.tv_sec - start.tv_sec;
+  long nanoseconds = end.tv_nsec - start.tv_nsec;
+  double elapsed = seconds + nanoseconds * 1e-9;
+
+  double total_latency = 0;
+  for (int i = 0; i < num_queries; i++) {
+    printf("run_id=%d,depth=%u,reached=%u,source=%u,%.6f\n", i,
+           query_depths[i], stats[i].visited, query_sources[i],
+           stats[i].latency);
+    total_latency += stats[i].latency;
+  }
+  printf("queries=%d,threads=%d,qps=%.2f,avg_latency=%.6f,%.4f\n",
+         num_queries, MAX_THREADS, num_queries / elapsed,
+         num_queries > 0 ? total_latency / num_queries : 0, elapsed);
+
+  if (args->check) {
+    // Checked outside of the timed run, as in the throughput mode
+    const void *ctx[] = {graph, query_sources, query_depths};
+    throughput_run(query_sources, query_depths, num_queries, stats,
+                   check_khop_query, (void *)ctx);
+  }
+
+  destroy_throughput();
+  free(stats);
+  destroy_merged_csr(throughput_csr);
+  free(query_sources);
+  free(query_depths);
+}
+
+int main(int argc, char **argv) {
+  AppArgs args = {.filename = NULL,
+                  .generator = NULL,
+                  .mode = NULL,
+                  .runs = 1,
+                  .source_id = -1,
+                  .target_id = -1,
+                  .depth = 1,
+                  .queries = NULL,
+                  .instrument = NULL,
+                  .trace = NULL,
+                  .powercap = NULL,
+                  .publish = NULL,
+                  .attach = NULL,
+                  .socket = NULL,
+                  .delta = 0,
+                  .batch_size = 1024,
+                  .check = false,
+                  .output = true,
+                  .reorder = false,
+                  .parents = false,
+                  .giant = false,
+                  .pipeline = false,
+                  .perf = false,
+                  .memory = false,
+                  .free_graph = false};
+  const CliOption options[] = {
+      {'f', "file", "Load graph from file", ARG_TYPE_STRING, &args.filename,
+       false},
+      {'G', "generate",
+       "Generate the graph instead of loading it: 'kron:scale=S,ef=E', "
+       "'uniform:scale=S,ef=E', 'grid:x=X,y=Y,z=Z,drop=P' or "
+       "'rgg:scale=S,r=R', each with an optional seed=N",
+       ARG_TYPE_STRING, &args.generator, false},
+      {'P', "publish",
+       "Build the merged CSR of the graph into this shared memory segment "
+       "(a /dev/shm name, or a file path e.g. on hugetlbfs) and exit",
+       ARG_TYPE_STRING, &args.publish, false},
+      {'A', "attach",
+       "Use the merged CSR published in this segment instead of loading a "
+       "graph, read-only with per-process visit state (bfs, khop, diameter "
+       "and server modes; not compatible with -c, -g and -F)",
+       ARG_TYPE_STRING, &args.attach, false},
+      {'S', "socket",
+       "Unix domain socket on which the server mode answers queries",
+       ARG_TYPE_STRING, &args.socket, false},
+      {'n', "runs", "Number of runs", ARG_TYPE_INT, &args.runs, false},
+      {'s', "source", "ID of source vertex", ARG_TYPE_INT, &args.source_id,
+       false},
+      {'t', "target", "ID of target vertex (p2p mode)", ARG_TYPE_INT,
+       &args.target_id, false},
+      {'k', "depth", "Maximum depth of the k-hop modes (1 by default)",
+       ARG_TYPE_INT, &args.depth, false},
+      {'q', "queries",
+       "File with one 'source depth' query per line (khop-batch mode)",
+       ARG_TYPE_STRING, &args.queries, false},
+      {'d', "delta",
+       "Bucket width of the sssp mode (average edge weight by default)",
+       ARG_TYPE_DOUBLE, &args.delta, false},
+      {'b', "batch",
+       "Edges inserted per run in the dynamic mode (1024 by default)",
+       ARG_TYPE_INT, &args.batch_size, false},
+      {'i', "instrument",
+       "Write per-level, per-thread counters of the bfs mode to a CSV file "
+       "(JSON if it ends in .json); needs a build with INSTRUMENT=1",
+       ARG_TYPE_STRING, &args.instrument, false},
+      {'T', "trace",
+       "Write a Chrome trace of the per-thread activity of the bfs mode "
+       "(chunks, steals, barriers, swaps) to this file, to be opened in "
+       "Perfetto; needs a build with TRACE=1",
+       ARG_TYPE_STRING, &args.trace, false},
+      {'e', "perf",
+       "Print cycles, instructions, LLC and dTLB misses and stalled cycles of "
+       "each thread per phase of the bfs mode (perf_event_open)",
+       ARG_TYPE_BOOL, &args.perf, false},
+      {'j', "powercap",
+       "Measure the energy of each run of the bfs mode from the RAPL zones "
+       "under this powercap root (e.g. /sys/class/powercap)",
+       ARG_TYPE_STRING, &args.powercap, false},
+      {'M', "memory",
+       "Print the bytes (and bytes per edge) of each structure of the bfs "
+       "mode after the runs, with the current and peak resident set size",
+       ARG_TYPE_BOOL, &args.memory, false},
+      {'F', "free-graph",
+       "Free the source CSR once the merged CSR of the bfs (or server) mode "
+       "is built (not compatible with -c and -j, which need it)",
+       ARG_TYPE_BOOL, &args.free_graph, false},
+      {'c', "check", "Checks BFS correctness", ARG_TYPE_BOOL, &args.check,
+       false},
+      {'r', "reorder",
+       "Sort large frontiers by merged CSR offset to improve locality",
+       ARG_TYPE_BOOL, &args.reorder, false},
+      {'p', "parents", "Output the BFS tree (parents) instead of distances",
+       ARG_TYPE_BOOL, &args.parents, false},
+      {'l', "pipeline",
+       "Let threads that finished a level expand completed chunks of the next "
+       "one",
+       ARG_TYPE_BOOL, &args.pipeline, false},
+      {'g', "giant",
+       "Pick random sources (and p2p targets) in the largest connected "
+       "component",
+       ARG_TYPE_BOOL, &args.giant, false},
+      {'m', "mode",
+       "Traversal mode: 'bfs' (one BFS per run, default), 'msbfs' (batches of "
+       "64 sources traversed together), 'throughput' (one sequential BFS per "
+       "worker), 'p2p' (bidirectional source-target shortest paths), 'khop' "
+       "(vertices within -k hops), 'khop-batch' (many k-hop queries, one per "
+       "worker), 'sssp' (delta-stepping weighted shortest paths), 'cc' "
+       "(connected components), 'bc' (betweenness centrality from the -n "
+       "sampled sources), 'diameter' (double sweep and iFUB from the first "
+       "source), 'dynamic' (random edge batches inserted after a BFS from the "
+       "first source, distances repaired incrementally), 'async' "
+       "(barrier-free label-correcting BFS), 'server' (answers the distance, "
+       "parent and k-hop queries of clients of the -S socket until "
+       "interrupted)",
+       ARG_TYPE_STRING, &args.mode, false}};
+  int num_options = sizeof(options) / sizeof(options[0]);
+  const char *app_description =
+      "An optimized BFS algorithm for large-diameter graphs.";
+  int parse_result =
+      cli_parse(argc, argv, options, num_options, app_description);
+
+  // Check the result: 0 is success, 1 means help was printed, -1 is an error.
+  if (parse_result != 0) {
+    if (args.filename)
+      free(args.filename);
+    return (parse_result == 1) ? 0 : 1;
+  }
+  if ((args.filename != NULL) + (args.generator != NULL) +
+          (args.attach != NULL) !=
+      1) {
+    printf("Exactly one of --file, --generate and --attach is needed\n");
+    return 1;
+  }
+  if (args.pipeline && args.parents) {
+    printf("Pipelined levels need distances and cannot compute parents\n");
+    return 1;
+  }
+#ifndef INSTRUMENT
+  if (args.instrument != NULL) {
+    printf("Instrumentation is compiled out, rebuild with INSTRUMENT=1\n");
+    return 1;
+  }
+#endif
+#ifndef TRACE
+  if (args.trace != NULL) {
+    printf("Tracing is compiled out, rebuild with TRACE=1\n");
+    return 1;
+  }
+#endif
+  if (args.free_graph && (args.check || args.powercap != NULL)) {
+    printf("The source CSR is needed by --check and --powercap and cannot be "
+           "freed\n");
+    return 1;
+  }
+  if (args.batch_size < 0) {
+    printf("The batch size must be non-negative\n");
+    return 1;
+  }
+  if (args.delta < 0) {
+    printf("The delta must be non-negative\n");
+    return 1;
+  }
+  if (args.depth < 0) {
+    printf("The depth must be non-negative\n");
+    return 1;
+  }
+  const char *modes[] = {"bfs",  "msbfs",      "throughput", "p2p",
+                         "khop", "khop-batch", "sssp",       "cc",
+                         "bc",   "diameter",   "dynamic",    "async",
+                         "server"};
+  const char *mode = args.mode != NULL ? args.mode : "bfs";
+  bool valid_mode = false;
+  for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+    valid_mode |= strcmp(mode, modes[i]) == 0;
+  }
+  if (!valid_mode) {
+    printf("Unknown mode [%s]\n", mode);
+    return 1;
+  }
+  if (strcmp(mode, "server") == 0 && args.socket == NULL) {
+    printf("The server mode needs a --socket\n");
+    return 1;
+  }
+  if (strcmp(mode, "diameter") == 0 && args.runs < 1) {
+    printf("The diameter mode needs at least one run (-n) for its source\n");
+    return 1;
+  }
+  if (args.attach != NULL) {
+    // The shared graph only has the merged CSR, without the neighbor lists
+    // that the checks, the giant component and the other engines read
+    if (strcmp(mode, "bfs") != 0 && strcmp(mode, "khop") != 0 &&
+        strcmp(mode, "diameter") != 0 && strcmp(mode, "server") != 0) {
+      printf("Mode [%s] cannot run on a shared graph\n", mode);
+      return 1;
+    }
+    if (args.check || args.giant || args.free_graph) {
+      printf("--check, --giant and --free-graph need the source CSR, which a "
+             "shared graph does not have\n");
+      return 1;
+    }
+  }
+
+  mmio_csr_u32_f32_t *graph;
+  if (args.attach != NULL) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    shared_graph = shared_graph_attach(args.attach);
+    if (shared_graph == NULL) {
+      return 1;
+    }
+    graph = shared_graph_degrees(shared_graph);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Attached shared graph [%s]: %u vertices, %u edges in %.4f s\n",
+           args.attach, graph->nrows, graph->nnz,
+           (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9);
+  } else if (args.generator != NULL) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    graph = generate_graph(args.generator);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (graph == NULL) {
+      return 1;
+    }
+    printf("Generated %s: %u vertices, %u edges in %.4f s\n", args.generator,
+           graph->nrows, graph->nnz,
+           (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9);
+  } else {
+    graph = mmio_read_csr_u32_f32(args.filename, false);
+    if (graph == NULL) {
+      printf("Failed to import graph from file [%s]\n", args.filename);
+      return -1;
+    }
+  }
+  if (args.publish != NULL) {
+    int result = shared_graph_publish(args.publish, graph);
+    free_csr(graph);
+    free(graph);
+    return result == 0 ? 0 : 1;
+  }
+
+  // Restricting the sources to the giant component avoids timing traversals
+  // of tiny components
+  uint32_t *components = NULL;
+  uint32_t giant = 0;
+  if (args.giant) {
+    components = (uint32_t *)malloc(graph->nrows * sizeof(uint32_t));
+    uint32_t giant_size;
+    giant = giant_component(graph, components, &giant_size);
+    printf("giant_component=%u,size=%u\n", giant, giant_size);
+  }
+  // At least one source: with -n 0 the dynamic mode still runs the initial
+  // BFS from the first one, without insertion batches
+  uint32_t *sources =
+      generate_sources(graph, args.runs > 0 ? args.runs : 1, graph->nrows,
+                       args.source_id, components, giant);
+
+  if (strcmp(mode, "msbfs") == 0) {
+    run_msbfs(graph, sources, &args);
+  } else if (strcmp(mode, "throughput") == 0) {
+    run_throughput(graph, sources, &args);
+  } else if (strcmp(mode, "p2p") == 0) {
+    run_p2p(graph, sources, components, giant, &args);
+  } else if (strcmp(mode, "khop") == 0) {
+    run_khop(graph, sources, &args);
+  } else if (strcmp(mode, "khop-batch") == 0) {
+    run_khop_batch(graph, sources, &args);
+  } else if (strcmp(mode, "sssp") == 0) {
+    run_sssp(graph, sources, &args);
+  } else if (strcmp(mode, "cc") == 0) {
+    run_cc(graph, &args);
+  } else if (strcmp(mode, "bc") == 0) {
+    run_bc(graph, sources, &args);
+  } else if (strcmp(mode, "diameter") == 0) {
+    run_diameter(graph, sources, &args);
+  } else if (strcmp(mode, "dynamic") == 0) {
+    run_dynamic(graph, sources, &args);
+  } else if (strcmp(mode, "async") == 0) {
+    run_async(graph, sources, &args);
+  } else if (strcmp(mode, "server") == 0) {
+    run_server(graph, &args);
+  } else {
+    run_bfs(graph, sources, &args);
+  }
+
+  free(sources);
+  free(components);
+  free_csr(graph);
+  free(graph);
+  if (shared_graph != NULL) {
+    shared_graph_detach(shared_graph);
+  }
+
+  return 0;
+}
@@ -0,0 +1,49 @@
+#define _GNU_SOURCE
+#include "memory_report.h"
+#include <stdio.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+static void print_item(const char *name, uint64_t bytes, uint64_t edges) {
+  printf("memory_structure=%s,bytes=%lu,mib=%.2f,bytes_per_edge=%.2f\n", name,
+         (unsigned long)bytes, bytes / (1024.0 * 1024.0),
+         edges > 0 ? (double)bytes / edges : 0);
+}
+
+// Resident pages from /proc/self/statm, 0 if it cannot be read
+static uint64_t current_rss() {
+  FILE *f = fopen("/proc/self/statm", "r");
+  if (f == NULL) {
+    return 0;
+  }
+  unsigned long size, resident;
+  int read = fscanf(f, "%lu %lu", &size, &resident);
+  fclose(f);
+  return read == 2 ? (uint64_t)resident * sysconf(_SC_PAGESIZE) : 0;
+}
+
+static uint64_t peak_rss() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  // Kilobytes on Linux
+  return (uint64_t)usage.ru_maxrss * 1024;
+}
+
+void memory_report(const MemoryItem *items, int num_items, uint64_t edges) {
+  uint64_t total = 0;
+  for (int i = 0; i < num_items; i++) {
+    if (items[i].bytes > 0) {
+      print_item(items[i].name, items[i].bytes, edges);
+      total += items[i].bytes;
+    }
+  }
+  print_item("total", total, edges);
+  // ru_maxrss is updated lazily and can trail the resident pages of statm, so
+  // the peak is at least the current RSS
+  uint64_t rss = current_rss();
+  uint64_t peak = peak_rss();
+  print_item("rss", rss, edges);
+  print_item("peak_rss", peak > rss ? peak : rss, edges);
+}
@@ -0,0 +1,32 @@
+#ifndef MEMORY_REPORT_H
+#define MEMORY_REPORT_H
+
+/**
+ * @brief Memory footprint report of the prepared structures.
+ *
+ * The sizes are computed from the allocation sizes of each structure (not
+ * from the allocator), so they do not include malloc overhead; the resident
+ * set size of the process is reported next to them for comparison. Each
+ * structure is printed as a `memory_structure=` line with its bytes and bytes
+ * per (directed) edge of the graph.
+ */
+
+#include <stdint.h>
+
+typedef struct {
+  const char *name;
+  uint64_t bytes;
+} MemoryItem;
+
+/**
+ * Most MemoryItems a report is built from.
+ */
+#define MAX_MEMORY_ITEMS 16
+
+/**
+ * Prints the items (skipping the empty ones), their total, the current and
+ * the peak resident set size of the process.
+ */
+void memory_report(const MemoryItem *items, int num_items, uint64_t edges);
+
+#endif // MEMORY_REPORT_H
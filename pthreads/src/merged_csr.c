@@ -1,17 +1,17 @@
 #include "merged_csr.h"
+#include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
-MergedCSR *to_merged_csr(const mmio_csr_u32_f32_t *graph) {
-  MergedCSR *merged_csr = (MergedCSR *)malloc(sizeof(MergedCSR));
-
-  merged_csr->num_edges = graph->nnz;
-  merged_csr->num_vertices = graph->nrows;
-  merged_csr->row_ptr =
-      (mer_t *)malloc((merged_csr->num_vertices + 1) * sizeof(mer_t));
-  merged_csr->merged = (mer_t *)malloc(
-      ((merged_csr->num_edges) * DATA_SIZE + (merged_csr->num_vertices) * METADATA_SIZE) *
-      sizeof(mer_t));
+uint64_t merged_csr_words(const mmio_csr_u32_f32_t *graph) {
+  return (uint64_t)graph->nnz * DATA_SIZE +
+         (uint64_t)graph->nrows * METADATA_SIZE;
+}
 
+void fill_merged_csr(const mmio_csr_u32_f32_t *graph, mer_t *row_ptr,
+                     mer_t *merged) {
+  MergedCSR view = {graph->nrows, graph->nnz, row_ptr, merged};
+  MergedCSR *merged_csr = &view;
   for (mer_t i = 0; i < merged_csr->num_vertices; i++) {
     mer_t merged_pos = graph->row_ptr[i] * DATA_SIZE + i * METADATA_SIZE;
     uint32_t degree = graph->row_ptr[i + 1] - graph->row_ptr[i];
@@ -31,6 +31,52 @@ MergedCSR *to_merged_csr(const mmio_csr_u32_f32_t *graph) {
   for (mer_t i = 0; i < merged_csr->num_vertices + 1; i++) {
     merged_csr->row_ptr[i] = graph->row_ptr[i] * DATA_SIZE + i * METADATA_SIZE;
   }
+}
+
+MergedCSR *to_merged_csr(const mmio_csr_u32_f32_t *graph) {
+  MergedCSR *merged_csr = (MergedCSR *)malloc(sizeof(MergedCSR));
+
+  merged_csr->num_edges = graph->nnz;
+  merged_csr->num_vertices = graph->nrows;
+  merged_csr->row_ptr =
+      (mer_t *)malloc((merged_csr->num_vertices + 1) * sizeof(mer_t));
+  merged_csr->merged =
+      (mer_t *)malloc(merged_csr_words(graph) * sizeof(mer_t));
+  fill_merged_csr(graph, merged_csr->row_ptr, merged_csr->merged);
+  return merged_csr;
+}
+
+MergedCSR *to_weighted_merged_csr(const mmio_csr_u32_f32_t *graph) {
+  MergedCSR *merged_csr = (MergedCSR *)malloc(sizeof(MergedCSR));
+
+  merged_csr->num_edges = graph->nnz;
+  merged_csr->num_vertices = graph->nrows;
+  merged_csr->row_ptr =
+      (mer_t *)malloc((merged_csr->num_vertices + 1) * sizeof(mer_t));
+  merged_csr->merged = (mer_t *)malloc(
+      ((merged_csr->num_edges) * WEIGHTED_DATA_SIZE +
+       (merged_csr->num_vertices) * METADATA_SIZE) *
+      sizeof(mer_t));
+
+  for (mer_t i = 0; i < merged_csr->num_vertices; i++) {
+    mer_t merged_pos = graph->row_ptr[i] * WEIGHTED_DATA_SIZE + i * METADATA_SIZE;
+    uint32_t degree = graph->row_ptr[i + 1] - graph->row_ptr[i];
+    DEGREE(merged_csr, merged_pos) = degree;
+    DISTANCE(merged_csr, merged_pos) = UINT32_MAX;
+    ID(merged_csr, merged_pos) = i;
+    merged_pos += METADATA_SIZE;
+    for (mer_t j = graph->row_ptr[i]; j < graph->row_ptr[i + 1]; j++) {
+      merged_csr->merged[merged_pos++] =
+          graph->row_ptr[graph->col_idx[j]] * WEIGHTED_DATA_SIZE +
+          graph->col_idx[j] * METADATA_SIZE;
+      float weight = graph->val != NULL ? fabsf(graph->val[j]) : 1.0f;
+      memcpy(&merged_csr->merged[merged_pos++], &weight, sizeof(float));
+    }
+  }
+  for (mer_t i = 0; i < merged_csr->num_vertices + 1; i++) {
+    merged_csr->row_ptr[i] =
+        graph->row_ptr[i] * WEIGHTED_DATA_SIZE + i * METADATA_SIZE;
+  }
   return merged_csr;
 }
 
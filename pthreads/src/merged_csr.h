@@ -13,9 +13,15 @@ typedef struct {
 
 #define METADATA_SIZE 3
 #define DATA_SIZE 1
+#define WEIGHTED_DATA_SIZE 2
 #define DEGREE(mer, i) mer->merged[i]
 #define DISTANCE(mer, i) mer->merged[i + 1]
 #define ID(mer, i) mer->merged[i+2]
+// When computing parents, the DISTANCE slot holds the ID of the parent instead
+#define PARENT(mer, i) mer->merged[i + 1]
+// When computing connected components, the DISTANCE slot holds the merged
+// offset of the representative of the vertex's component instead
+#define COMPONENT(mer, i) mer->merged[i + 1]
 
 /**
  * Converts the CSR graph into a modified merged CSR format with embedded
@@ -25,6 +31,28 @@ typedef struct {
  */
 MergedCSR *to_merged_csr(const mmio_csr_u32_f32_t *graph); 
 
+/**
+ * Number of words of the merged array of to_merged_csr.
+ */
+uint64_t merged_csr_words(const mmio_csr_u32_f32_t *graph);
+
+/**
+ * Writes the merged row pointers (num_vertices + 1 words) and the merged array
+ * (merged_csr_words words) of to_merged_csr into caller-provided memory, e.g.
+ * a shared memory segment.
+ */
+void fill_merged_csr(const mmio_csr_u32_f32_t *graph, mer_t *row_ptr,
+                     mer_t *merged);
+
+/**
+ * Converts the weighted CSR graph into a merged CSR where each neighbor offset
+ * is followed by the weight of the edge (the bits of a float), i.e. each edge
+ * takes WEIGHTED_DATA_SIZE words. Vertex metadata is the same as in
+ * to_merged_csr, and row_ptr accounts for the larger edges. Weights are taken
+ * in absolute value; if the graph has no values, all weights are 1.
+ */
+MergedCSR *to_weighted_merged_csr(const mmio_csr_u32_f32_t *graph);
+
 void destroy_merged_csr(MergedCSR *merged_csr); 
 
 #endif // MERGEDCSR_H
@@ -0,0 +1,235 @@
+#include "msbfs.h"
+#include "barrier.h"
+#include "frontier.h"
+#include "thread_pool.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+static MSMergedCSR *ms_csr;
+static Frontier *ms_f1, *ms_f2;
+static uint32_t *ms_distances;
+static int ms_num_sources;
+static Barrier ms_barrier;
+
+static volatile bool ms_exploration_done;
+static volatile int ms_level;
+
+MSMergedCSR *to_msbfs_merged_csr(const mmio_csr_u32_f32_t *graph) {
+  MSMergedCSR *merged_csr = (MSMergedCSR *)malloc(sizeof(MSMergedCSR));
+
+  merged_csr->num_edges = graph->nnz;
+  merged_csr->num_vertices = graph->nrows;
+  merged_csr->row_ptr =
+      (mer_t *)malloc((merged_csr->num_vertices + 1) * sizeof(mer_t));
+  merged_csr->merged = (uint64_t *)malloc(
+      ((uint64_t)merged_csr->num_edges +
+       (uint64_t)merged_csr->num_vertices * MS_METADATA_SIZE) *
+      sizeof(uint64_t));
+
+  for (mer_t i = 0; i < merged_csr->num_vertices; i++) {
+    mer_t merged_pos = graph->row_ptr[i] + i * MS_METADATA_SIZE;
+    MS_DEGREE(merged_csr, merged_pos) = graph->row_ptr[i + 1] - graph->row_ptr[i];
+    MS_ID(merged_csr, merged_pos) = i;
+    MS_SEEN(merged_csr, merged_pos) = 0;
+    MS_VISIT(merged_csr, merged_pos) = 0;
+    MS_VISIT_NEXT(merged_csr, merged_pos) = 0;
+    merged_pos += MS_METADATA_SIZE;
+    for (mer_t j = graph->row_ptr[i]; j < graph->row_ptr[i + 1];
+         j++, merged_pos++) {
+      merged_csr->merged[merged_pos] =
+          graph->row_ptr[graph->col_idx[j]] +
+          graph->col_idx[j] * MS_METADATA_SIZE;
+    }
+  }
+  for (mer_t i = 0; i < merged_csr->num_vertices + 1; i++) {
+    merged_csr->row_ptr[i] = graph->row_ptr[i] + i * MS_METADATA_SIZE;
+  }
+  return merged_csr;
+}
+
+void destroy_msbfs_merged_csr(MSMergedCSR *merged_csr) {
+  free(merged_csr->merged);
+  free(merged_csr->row_ptr);
+  free(merged_csr);
+}
+
+/**
+ * Expands the vertices of a chunk for all the sources in their `visit` mask.
+ * Every neighbor receives the sources it has not seen yet in its `visit_next`
+ * mask; the first thread setting a bit of an empty `visit_next` mask pushes
+ * the neighbor into the next frontier.
+ */
+static void expand_chunk(Frontier *next, Chunk *c, Chunk **dest,
+                         int thread_id) {
+  mer_t v = VERT_MAX;
+  while ((v = chunk_pop_vertex(c)) != VERT_MAX) {
+    msbfs_mask_t visit = MS_VISIT(ms_csr, v);
+    mer_t end = v + MS_DEGREE(ms_csr, v) + MS_METADATA_SIZE;
+    for (mer_t i = v + MS_METADATA_SIZE; i < end; i++) {
+      mer_t neighbor = ms_csr->merged[i];
+      msbfs_mask_t new_sources = visit & ~MS_SEEN(ms_csr, neighbor);
+      if (new_sources == 0) {
+        continue;
+      }
+      // Skip the atomic operation if the sources are already scheduled
+      msbfs_mask_t *visit_next = &MS_VISIT_NEXT(ms_csr, neighbor);
+      if ((__atomic_load_n(visit_next, __ATOMIC_RELAXED) & new_sources) ==
+          new_sources) {
+        continue;
+      }
+      if (__atomic_fetch_or(visit_next, new_sources, __ATOMIC_RELAXED) == 0) {
+        if (*dest == NULL || (*dest)->next_free_index >= CHUNK_SIZE) {
+          *dest = frontier_create_chunk(next, thread_id);
+        }
+        chunk_push_vertex(*dest, neighbor);
+      }
+    }
+    MS_VISIT(ms_csr, v) = 0;
+  }
+}
+
+/**
+ * Expands the current frontier, first consuming the chunks of this thread and
+ * then stealing from the other threads (same scheme as top_down in bfs.c).
+ */
+static void expand(Frontier *current, Frontier *next, int thread_id) {
+  Chunk *c = NULL;
+  Chunk *next_chunk = NULL;
+  while ((c = frontier_remove_chunk(current, thread_id)) != NULL) {
+    expand_chunk(next, c, &next_chunk, thread_id);
+  }
+  bool work_to_do = true;
+  while (work_to_do) {
+    work_to_do = false;
+    for (int i = 0; i < MAX_THREADS; i++) {
+      if (current->thread_chunks[i]->top_chunk > 1) {
+        work_to_do = true;
+        if ((c = frontier_remove_chunk(current, i)) != NULL) {
+          expand_chunk(next, c, &next_chunk, thread_id);
+        }
+        i--;
+      }
+    }
+  }
+}
+
+/**
+ * Commits the next frontier produced by this thread: the sources in
+ * `visit_next` become seen and form the `visit` mask of the next level, and
+ * the distances of the newly reached vertices are recorded. Chunks are only
+ * read, so they can be expanded after the frontier swap.
+ */
+static void commit(Frontier *next, int level, int thread_id) {
+  ThreadChunks *thread = next->thread_chunks[thread_id];
+  uint32_t num_vertices = ms_csr->num_vertices;
+  for (int i = 0; i < thread->top_chunk; i++) {
+    Chunk *c = thread->chunks[i];
+    for (int j = 0; j < c->next_free_index; j++) {
+      mer_t v = c->vertices[j];
+      msbfs_mask_t new_sources = MS_VISIT_NEXT(ms_csr, v);
+      MS_SEEN(ms_csr, v) |= new_sources;
+      MS_VISIT(ms_csr, v) = new_sources;
+      MS_VISIT_NEXT(ms_csr, v) = 0;
+      uint64_t id = MS_ID(ms_csr, v);
+      while (new_sources) {
+        int source = __builtin_ctzll(new_sources);
+        new_sources &= new_sources - 1;
+        ms_distances[source * (uint64_t)num_vertices + id] = level;
+      }
+    }
+  }
+}
+
+static void swap_frontiers(void *arg) {
+  (void)arg;
+  Frontier *temp = ms_f2;
+  ms_f2 = ms_f1;
+  ms_f1 = temp;
+  if (frontier_get_total_chunks(ms_f1) == 0) {
+    ms_exploration_done = true;
+  }
+  ms_level++;
+}
+
+static void notify_parent(void *arg) {
+  (void)arg;
+  thread_pool_notify_parent(&tp);
+}
+
+static void *msbfs_thread_main(void *arg) {
+  int thread_id = *(int *)arg;
+  uint32_t num_vertices = ms_csr->num_vertices;
+  mer_t chunk_size = num_vertices / MAX_THREADS;
+  mer_t start = thread_id * chunk_size;
+  mer_t end = (thread_id == MAX_THREADS - 1) ? num_vertices
+                                             : (thread_id + 1) * chunk_size;
+
+  // Reset this thread's share of the output
+  for (int s = 0; s < ms_num_sources; s++) {
+    for (mer_t i = start; i < end; i++) {
+      ms_distances[s * (uint64_t)num_vertices + i] = UINT32_MAX;
+    }
+  }
+  barrier_wait(&ms_barrier, NULL, NULL);
+
+  // The sources are pushed into the next frontier by msbfs(), so every level
+  // starts by committing the next frontier
+  while (true) {
+    commit(ms_f2, ms_level, thread_id);
+    barrier_wait(&ms_barrier, swap_frontiers, NULL);
+    if (ms_exploration_done) {
+      break;
+    }
+    expand(ms_f1, ms_f2, thread_id);
+    barrier_wait(&ms_barrier, NULL, NULL);
+  }
+
+  // Clear the seen masks for the next batch
+  for (mer_t i = start; i < end; i++) {
+    MS_SEEN(ms_csr, ms_csr->row_ptr[i]) = 0;
+  }
+  barrier_wait(&ms_barrier, notify_parent, NULL);
+  return NULL;
+}
+
+void initialize_msbfs(const mmio_csr_u32_f32_t *graph) {
+  ms_csr = to_msbfs_merged_csr(graph);
+  ms_f1 = frontier_create();
+  ms_f2 = frontier_create();
+  barrier_init(&ms_barrier);
+  init_thread_pool(&tp, msbfs_thread_main);
+  thread_pool_create(&tp);
+}
+
+int msbfs(const uint32_t *sources, int num_sources, uint32_t *distances) {
+  assert(num_sources <= MSBFS_BATCH_SIZE && "Too many sources for a batch!");
+  ms_distances = distances;
+  ms_num_sources = num_sources;
+  Chunk *c = NULL;
+  for (int k = 0; k < num_sources; k++) {
+    mer_t v = ms_csr->row_ptr[sources[k]];
+    // The same vertex may appear more than once in a batch
+    if (MS_VISIT_NEXT(ms_csr, v) == 0) {
+      if (c == NULL || c->next_free_index >= CHUNK_SIZE) {
+        c = frontier_create_chunk(ms_f2, 0);
+      }
+      chunk_push_vertex(c, v);
+    }
+    MS_VISIT_NEXT(ms_csr, v) |= (msbfs_mask_t)1 << k;
+  }
+  ms_exploration_done = false;
+  ms_level = 0;
+  atomic_thread_fence(memory_order_seq_cst);
+  thread_pool_start_wait(&tp);
+  // The last level is empty
+  return ms_level - 1;
+}
+
+void destroy_msbfs() {
+  thread_pool_terminate(&tp);
+  destroy_thread_pool(&tp);
+  frontier_destroy(ms_f1);
+  frontier_destroy(ms_f2);
+  destroy_msbfs_merged_csr(ms_csr);
+}
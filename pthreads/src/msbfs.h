@@ -0,0 +1,72 @@
+#ifndef MSBFS_H
+#define MSBFS_H
+
+/**
+ * @brief Batched multi-source BFS (MS-BFS).
+ *
+ * Runs up to MSBFS_BATCH_SIZE BFS traversals at the same time. Every vertex
+ * carries three bit masks, one bit per source of the batch:
+ * - `seen`: sources that have already reached the vertex,
+ * - `visit`: sources for which the vertex is in the current frontier,
+ * - `visit_next`: sources for which the vertex is in the next frontier.
+ * A frontier vertex is expanded once for all the sources in its `visit` mask,
+ * so each edge is traversed once per level per batch instead of once per
+ * source.
+ *
+ * The masks are stored in the vertex metadata of a merged CSR, right before the
+ * adjacency list, exactly like the distance in MergedCSR. Since masks are
+ * 64-bit wide, the merged array uses 64-bit words; neighbors are still stored
+ * as offsets of their metadata block. Frontiers are the chunked per-thread
+ * Frontier with work stealing used by the single-source engine.
+ */
+
+#include "config.h"
+#include "mmio_c_wrapper.h"
+#include <stdint.h>
+
+#define MSBFS_BATCH_SIZE 64
+
+typedef uint64_t msbfs_mask_t;
+
+typedef struct {
+  uint32_t num_vertices;
+  uint32_t num_edges;
+  mer_t *row_ptr;
+  uint64_t *merged;
+} MSMergedCSR;
+
+#define MS_METADATA_SIZE 5
+#define MS_DEGREE(mer, i) mer->merged[i]
+#define MS_ID(mer, i) mer->merged[i + 1]
+#define MS_SEEN(mer, i) mer->merged[i + 2]
+#define MS_VISIT(mer, i) mer->merged[i + 3]
+#define MS_VISIT_NEXT(mer, i) mer->merged[i + 4]
+
+/**
+ * Converts the CSR graph into the merged layout used by MS-BFS, with all the
+ * bit masks cleared.
+ */
+MSMergedCSR *to_msbfs_merged_csr(const mmio_csr_u32_f32_t *graph);
+
+void destroy_msbfs_merged_csr(MSMergedCSR *merged_csr);
+
+/**
+ * Builds the MS-BFS data structures and starts the thread pool with the MS-BFS
+ * worker routine.
+ */
+void initialize_msbfs(const mmio_csr_u32_f32_t *graph);
+
+/**
+ * Runs a BFS from each of the `num_sources` (at most MSBFS_BATCH_SIZE) sources
+ * at the same time. The distances from `sources[k]` are written to
+ * `distances[k * num_vertices .. (k + 1) * num_vertices)` (UINT32_MAX for
+ * unreachable vertices). Returns the number of levels of the traversal.
+ */
+int msbfs(const uint32_t *sources, int num_sources, uint32_t *distances);
+
+/**
+ * Stops the thread pool and frees the MS-BFS data structures.
+ */
+void destroy_msbfs();
+
+#endif // MSBFS_H
@@ -0,0 +1,256 @@
+#include "p2p.h"
+#include "barrier.h"
+#include "frontier.h"
+#include "merged_csr.h"
+#include "thread_pool.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define FORWARD 0
+#define BACKWARD 1
+// Slot value of a vertex reached from `side` through the vertex `parent_id`
+#define P2P_LABEL(parent_id, side) (((mer_t)(parent_id) << 1) | (side))
+#define P2P_PARENT(label) ((label) >> 1)
+#define P2P_SIDE(label) ((label) & 1)
+#define P2P_UNVISITED UINT32_MAX
+
+static MergedCSR *p2p_csr;
+static Frontier *p2p_frontiers[2]; // Current frontier of each side
+static Frontier *p2p_next;         // Next frontier of the side being expanded
+static uint32_t p2p_sizes[2];      // Vertices in the frontier of each side
+static uint32_t p2p_pushed[MAX_THREADS];
+static VertexLog p2p_touched[MAX_THREADS];
+static Barrier p2p_barrier;
+
+static volatile int p2p_side;
+static volatile bool p2p_done;
+static atomic_bool p2p_met;
+// Meeting edge: p2p_meet_from was reached by the side that found the edge
+static mer_t p2p_meet_from, p2p_meet_to;
+
+static uint32_t *p2p_path;
+static int p2p_hops;
+
+static void expand_chunk(Chunk *c, Chunk **dest, int side, int thread_id) {
+  VertexLog *touched = &p2p_touched[thread_id];
+  mer_t v = VERT_MAX;
+  while ((v = chunk_pop_vertex(c)) != VERT_MAX) {
+    mer_t label = P2P_LABEL(ID(p2p_csr, v), side);
+    mer_t end = v + DEGREE(p2p_csr, v) + METADATA_SIZE;
+    for (mer_t i = v + METADATA_SIZE; i < end; i++) {
+      mer_t neighbor = p2p_csr->merged[i];
+      mer_t neighbor_label = DISTANCE(p2p_csr, neighbor);
+      // Claim the vertex, so that only one thread logs it; a failed claim
+      // leaves the winner's label in neighbor_label
+      if (neighbor_label == P2P_UNVISITED &&
+          __atomic_compare_exchange_n(&DISTANCE(p2p_csr, neighbor),
+                                      &neighbor_label, label, false,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        vertex_log_push(touched, neighbor);
+        if (DEGREE(p2p_csr, neighbor) != 1) {
+          if (*dest == NULL || (*dest)->next_free_index >= CHUNK_SIZE) {
+            *dest = frontier_create_chunk(p2p_next, thread_id);
+          }
+          chunk_push_vertex(*dest, neighbor);
+          p2p_pushed[thread_id]++;
+        }
+      } else if (P2P_SIDE(neighbor_label) != (mer_t)side) {
+        // The two searches met: the first thread to notice records the edge
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&p2p_met, &expected, true)) {
+          p2p_meet_from = v;
+          p2p_meet_to = neighbor;
+        }
+        c->next_free_index = 0;
+        return;
+      }
+    }
+  }
+}
+
+/**
+ * Expands the current frontier of `side` with the same own-chunks-first,
+ * then work-stealing scheme as top_down in bfs.c. Stops early once the
+ * searches have met.
+ */
+static void expand(Frontier *current, int side, int thread_id) {
+  Chunk *c = NULL;
+  Chunk *next_chunk = NULL;
+  while (!p2p_met && (c = frontier_remove_chunk(current, thread_id)) != NULL) {
+    expand_chunk(c, &next_chunk, side, thread_id);
+  }
+  bool work_to_do = true;
+  while (work_to_do && !p2p_met) {
+    work_to_do = false;
+    for (int i = 0; i < MAX_THREADS && !p2p_met; i++) {
+      if (current->thread_chunks[i]->top_chunk > 1) {
+        work_to_do = true;
+        if ((c = frontier_remove_chunk(current, i)) != NULL) {
+          expand_chunk(c, &next_chunk, side, thread_id);
+        }
+        i--;
+      }
+    }
+  }
+}
+
+/**
+ * Serial section at the end of each step: installs the new frontier of the
+ * expanded side and picks the side with the smaller frontier for the next
+ * step.
+ */
+static void end_step(void *arg) {
+  (void)arg;
+  int side = p2p_side;
+  Frontier *temp = p2p_frontiers[side];
+  p2p_frontiers[side] = p2p_next;
+  p2p_next = temp;
+  // Chunks left over by an early exit
+  frontier_clear(p2p_next);
+
+  p2p_sizes[side] = 0;
+  for (int i = 0; i < MAX_THREADS; i++) {
+    p2p_sizes[side] += p2p_pushed[i];
+    p2p_pushed[i] = 0;
+  }
+  if (p2p_met || p2p_sizes[side] == 0) {
+    p2p_done = true;
+  }
+  p2p_side = p2p_sizes[FORWARD] <= p2p_sizes[BACKWARD] ? FORWARD : BACKWARD;
+}
+
+/**
+ * Walks the parents from the merged CSR offset `v` up to the root of its side,
+ * writing the IDs to `out`. Returns the number of vertices written.
+ */
+static uint32_t walk_to_root(mer_t v, uint32_t *out) {
+  uint32_t count = 0;
+  while (true) {
+    mer_t id = ID(p2p_csr, v);
+    out[count++] = id;
+    mer_t parent = P2P_PARENT(DISTANCE(p2p_csr, v));
+    if (parent == id) {
+      return count;
+    }
+    v = p2p_csr->row_ptr[parent];
+  }
+}
+
+/**
+ * Serial section run once the search is over, before the slots are reset:
+ * reconstructs the path through the meeting edge.
+ */
+static void build_path(void *arg) {
+  (void)arg;
+  frontier_clear(p2p_frontiers[FORWARD]);
+  frontier_clear(p2p_frontiers[BACKWARD]);
+  if (!p2p_met) {
+    p2p_hops = -1;
+    return;
+  }
+  mer_t forward = p2p_meet_from, backward = p2p_meet_to;
+  if (P2P_SIDE(DISTANCE(p2p_csr, forward)) == BACKWARD) {
+    forward = p2p_meet_to;
+    backward = p2p_meet_from;
+  }
+  // Forward half: walk to the source, then reverse it in place
+  uint32_t length = walk_to_root(forward, p2p_path);
+  for (uint32_t i = 0; i < length / 2; i++) {
+    uint32_t temp = p2p_path[i];
+    p2p_path[i] = p2p_path[length - 1 - i];
+    p2p_path[length - 1 - i] = temp;
+  }
+  // Backward half: walk to the target
+  length += walk_to_root(backward, &p2p_path[length]);
+  p2p_hops = length - 1;
+}
+
+static void notify_parent(void *arg) {
+  (void)arg;
+  thread_pool_notify_parent(&tp);
+}
+
+static void *p2p_thread_main(void *arg) {
+  int thread_id = *(int *)arg;
+  while (!p2p_done) {
+    expand(p2p_frontiers[p2p_side], p2p_side, thread_id);
+    barrier_wait(&p2p_barrier, end_step, NULL);
+  }
+  barrier_wait(&p2p_barrier, build_path, NULL);
+
+  // Reset only the slots touched by this thread
+  VertexLog *touched = &p2p_touched[thread_id];
+  for (uint32_t i = 0; i < touched->size; i++) {
+    DISTANCE(p2p_csr, touched->vertices[i]) = P2P_UNVISITED;
+  }
+  barrier_wait(&p2p_barrier, notify_parent, NULL);
+  return NULL;
+}
+
+void initialize_p2p(const mmio_csr_u32_f32_t *graph) {
+  assert(graph->nrows < (1u << 31) &&
+         "Point-to-point queries support up to 2^31 - 1 vertices!");
+  p2p_csr = to_merged_csr(graph);
+  p2p_frontiers[FORWARD] = frontier_create();
+  p2p_frontiers[BACKWARD] = frontier_create();
+  p2p_next = frontier_create();
+  for (int i = 0; i < MAX_THREADS; i++) {
+    vertex_log_init(&p2p_touched[i]);
+  }
+  barrier_init(&p2p_barrier);
+  init_thread_pool(&tp, p2p_thread_main);
+  thread_pool_create(&tp);
+}
+
+int p2p_shortest_path(uint32_t source, uint32_t target, uint32_t *path,
+                      uint32_t *explored) {
+  if (source == target) {
+    path[0] = source;
+    if (explored != NULL) {
+      *explored = 1;
+    }
+    return 0;
+  }
+  mer_t endpoints[2] = {p2p_csr->row_ptr[source], p2p_csr->row_ptr[target]};
+  for (int side = FORWARD; side <= BACKWARD; side++) {
+    mer_t v = endpoints[side];
+    DISTANCE(p2p_csr, v) = P2P_LABEL(ID(p2p_csr, v), side);
+    vertex_log_push(&p2p_touched[0], v);
+    chunk_push_vertex(frontier_create_chunk(p2p_frontiers[side], 0), v);
+    p2p_sizes[side] = 1;
+  }
+  for (int i = 0; i < MAX_THREADS; i++) {
+    p2p_pushed[i] = 0;
+  }
+  p2p_path = path;
+  p2p_side = FORWARD;
+  p2p_done = false;
+  p2p_met = false;
+  atomic_thread_fence(memory_order_seq_cst);
+  thread_pool_start_wait(&tp);
+
+  if (explored != NULL) {
+    *explored = 0;
+    for (int i = 0; i < MAX_THREADS; i++) {
+      *explored += p2p_touched[i].size;
+    }
+  }
+  for (int i = 0; i < MAX_THREADS; i++) {
+    p2p_touched[i].size = 0;
+  }
+  return p2p_hops;
+}
+
+void destroy_p2p() {
+  thread_pool_terminate(&tp);
+  destroy_thread_pool(&tp);
+  frontier_destroy(p2p_frontiers[FORWARD]);
+  frontier_destroy(p2p_frontiers[BACKWARD]);
+  frontier_destroy(p2p_next);
+  for (int i = 0; i < MAX_THREADS; i++) {
+    vertex_log_destroy(&p2p_touched[i]);
+  }
+  destroy_merged_csr(p2p_csr);
+}
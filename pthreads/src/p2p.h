@@ -0,0 +1,44 @@
+#ifndef P2P_H
+#define P2P_H
+
+/**
+ * @brief Bidirectional point-to-point shortest path queries.
+ *
+ * Runs a BFS from both endpoints of the query and, at every step, expands the
+ * side with the smaller frontier. The search stops as soon as the two searches
+ * meet, so the cost of a query is proportional to the explored region rather
+ * than to the size of the graph.
+ *
+ * The DISTANCE slot of each vertex stores the ID of its parent together with
+ * the side (forward from the source, backward from the target) that reached
+ * it. Frontiers are the chunked per-thread Frontier with work stealing, and
+ * every thread logs the vertices it touches so that only those slots are
+ * reset at the end of the query (no finalize pass over the whole graph).
+ */
+
+#include "config.h"
+#include "mmio_c_wrapper.h"
+#include <stdint.h>
+
+/**
+ * Builds the merged CSR and the frontiers used by the queries and starts the
+ * thread pool with the point-to-point worker routine.
+ */
+void initialize_p2p(const mmio_csr_u32_f32_t *graph);
+
+/**
+ * Computes a shortest path from `source` to `target`. The vertex IDs of the
+ * path (source and target included) are written to `path`, which must have
+ * room for the number of vertices of the graph. Returns the number of hops
+ * of the path, or -1 if the target is not reachable. If `explored` is not
+ * NULL, it receives the number of vertices touched by the query.
+ */
+int p2p_shortest_path(uint32_t source, uint32_t target, uint32_t *path,
+                      uint32_t *explored);
+
+/**
+ * Stops the thread pool and frees the point-to-point data structures.
+ */
+void destroy_p2p();
+
+#endif // P2P_H
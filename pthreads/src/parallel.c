@@ -0,0 +1,38 @@
+#include "parallel.h"
+#include "config.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+typedef struct {
+  void (*routine)(uint64_t begin, uint64_t end, void *arg);
+  void *arg;
+  uint64_t n;
+  atomic_uint_fast64_t next;
+} ParallelFor;
+
+static void *parallel_for_thread(void *arg) {
+  ParallelFor *loop = (ParallelFor *)arg;
+  uint64_t begin;
+  while ((begin = atomic_fetch_add(&loop->next, PARALLEL_FOR_BLOCK)) <
+         loop->n) {
+    uint64_t end = begin + PARALLEL_FOR_BLOCK;
+    loop->routine(begin, end < loop->n ? end : loop->n, loop->arg);
+  }
+  return NULL;
+}
+
+void parallel_for(uint64_t n, void (*routine)(uint64_t begin, uint64_t end,
+                                              void *arg),
+                  void *arg) {
+  ParallelFor loop = {.routine = routine, .arg = arg, .n = n};
+  atomic_init(&loop.next, 0);
+  pthread_t threads[MAX_THREADS];
+  // The calling thread takes part as the last worker
+  for (int t = 0; t < MAX_THREADS - 1; t++) {
+    pthread_create(&threads[t], NULL, parallel_for_thread, &loop);
+  }
+  parallel_for_thread(&loop);
+  for (int t = 0; t < MAX_THREADS - 1; t++) {
+    pthread_join(threads[t], NULL);
+  }
+}
@@ -0,0 +1,24 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/**
+ * @brief Parallel loops for the serial parts of the program (graph generation
+ * and result validation), which run while the BFS thread pool is idle or not
+ * created yet. MAX_THREADS short-lived threads take blocks of
+ * PARALLEL_FOR_BLOCK indices from a shared counter, so that skewed iterations
+ * (e.g. the hubs of a power-law graph) are balanced.
+ */
+
+#include <stdint.h>
+
+#define PARALLEL_FOR_BLOCK 4096
+
+/**
+ * Runs `routine` on consecutive ranges [begin, end) covering [0, n), in
+ * parallel and in no particular order. Returns once all ranges are done.
+ */
+void parallel_for(uint64_t n, void (*routine)(uint64_t begin, uint64_t end,
+                                              void *arg),
+                  void *arg);
+
+#endif // PARALLEL_H
@@ -0,0 +1,195 @@
+#define _GNU_SOURCE
+#include "perf_counters.h"
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+bool perf_enabled = false;
+
+static const char *event_names[PERF_NUM_EVENTS] = {
+    "cycles", "instructions", "llc_misses", "dtlb_misses", "stalled_cycles"};
+static const char *phase_names[PERF_NUM_PHASES] = {"build", "traversal",
+                                                   "finalize"};
+
+// Value read with PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING
+typedef struct {
+  uint64_t value;
+  uint64_t enabled;
+  uint64_t running;
+} PerfReading;
+
+typedef struct {
+  int fds[PERF_NUM_EVENTS]; // -1 if the event is not available
+  bool opened;
+  bool active[PERF_NUM_PHASES]; // Phase entered since the last reset
+  PerfReading start[PERF_NUM_EVENTS];
+  double counts[PERF_NUM_PHASES][PERF_NUM_EVENTS];
+} ThreadCounters;
+
+static ThreadCounters counters[MAX_THREADS + 1];
+
+static void event_attr(PerfEvent event, struct perf_event_attr *attr) {
+  memset(attr, 0, sizeof(*attr));
+  attr->size = sizeof(*attr);
+  attr->type = PERF_TYPE_HARDWARE;
+  switch (event) {
+  case PERF_CYCLES:
+    attr->config = PERF_COUNT_HW_CPU_CYCLES;
+    break;
+  case PERF_INSTRUCTIONS:
+    attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+    break;
+  case PERF_LLC_MISSES:
+    attr->config = PERF_COUNT_HW_CACHE_MISSES;
+    break;
+  case PERF_DTLB_MISSES:
+    attr->type = PERF_TYPE_HW_CACHE;
+    attr->config = PERF_COUNT_HW_CACHE_DTLB |
+                   (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    break;
+  default:
+    attr->config = PERF_COUNT_HW_STALLED_CYCLES_BACKEND;
+    break;
+  }
+  attr->read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // User space only, which is allowed with the default perf_event_paranoid
+  attr->exclude_kernel = 1;
+  attr->exclude_hv = 1;
+}
+
+/**
+ * Opens the events for the calling thread. Returns the number of events
+ * that could be opened.
+ */
+static int open_counters(ThreadCounters *t) {
+  int opened = 0;
+  for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+    struct perf_event_attr attr;
+    event_attr(e, &attr);
+    t->fds[e] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    opened += t->fds[e] >= 0;
+  }
+  t->opened = true;
+  return opened;
+}
+
+static void read_counters(const ThreadCounters *t, PerfReading *readings) {
+  for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+    if (t->fds[e] < 0 ||
+        read(t->fds[e], &readings[e], sizeof(PerfReading)) !=
+            sizeof(PerfReading)) {
+      memset(&readings[e], 0, sizeof(PerfReading));
+    }
+  }
+}
+
+bool perf_counters_init() {
+  ThreadCounters *t = &counters[PERF_MAIN_THREAD];
+  if (open_counters(t) == 0) {
+    printf("Hardware counters unavailable (%s), check "
+           "/proc/sys/kernel/perf_event_paranoid\n",
+           strerror(errno));
+    t->opened = false;
+    return false;
+  }
+  perf_enabled = true;
+  perf_reset();
+  return true;
+}
+
+void perf_begin(int thread_id, PerfPhase phase) {
+  ThreadCounters *t = &counters[thread_id];
+  if (!t->opened) {
+    open_counters(t);
+  }
+  t->active[phase] = true;
+  read_counters(t, t->start);
+}
+
+void perf_end(int thread_id, PerfPhase phase) {
+  ThreadCounters *t = &counters[thread_id];
+  PerfReading end[PERF_NUM_EVENTS];
+  read_counters(t, end);
+  for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+    uint64_t running = end[e].running - t->start[e].running;
+    if (running > 0) {
+      t->counts[phase][e] += (double)(end[e].value - t->start[e].value) *
+                             (end[e].enabled - t->start[e].enabled) / running;
+    }
+  }
+}
+
+void perf_reset() {
+  for (int i = 0; i <= MAX_THREADS; i++) {
+    memset(counters[i].active, 0, sizeof(counters[i].active));
+    memset(counters[i].counts, 0, sizeof(counters[i].counts));
+  }
+}
+
+static void print_counts(int run_id, PerfPhase phase, const char *thread,
+                         const double *counts, const bool *available) {
+  printf("perf_run_id=%d,phase=%s,thread=%s", run_id, phase_names[phase],
+         thread);
+  for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+    if (available[e]) {
+      printf(",%s=%.0f", event_names[e], counts[e]);
+    } else {
+      printf(",%s=n/a", event_names[e]);
+    }
+  }
+  if (available[PERF_CYCLES] && available[PERF_INSTRUCTIONS] &&
+      counts[PERF_CYCLES] > 0) {
+    printf(",ipc=%.3f", counts[PERF_INSTRUCTIONS] / counts[PERF_CYCLES]);
+  }
+  printf("\n");
+}
+
+void perf_print(int run_id, PerfPhase phase) {
+  double total[PERF_NUM_EVENTS] = {0};
+  bool available[PERF_NUM_EVENTS] = {false};
+  int threads = 0;
+  for (int i = 0; i <= MAX_THREADS; i++) {
+    const ThreadCounters *t = &counters[i];
+    if (!t->active[phase]) {
+      continue;
+    }
+    bool thread_available[PERF_NUM_EVENTS];
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+      thread_available[e] = t->fds[e] >= 0;
+      available[e] |= thread_available[e];
+      total[e] += t->counts[phase][e];
+    }
+    char name[16];
+    if (i == PERF_MAIN_THREAD) {
+      snprintf(name, sizeof(name), "main");
+    } else {
+      snprintf(name, sizeof(name), "%d", i);
+    }
+    print_counts(run_id, phase, name, t->counts[phase], thread_available);
+    threads++;
+  }
+  if (threads > 1) {
+    print_counts(run_id, phase, "all", total, available);
+  }
+}
+
+void perf_counters_destroy() {
+  for (int i = 0; i <= MAX_THREADS; i++) {
+    ThreadCounters *t = &counters[i];
+    if (!t->opened) {
+      continue;
+    }
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+      if (t->fds[e] >= 0) {
+        close(t->fds[e]);
+      }
+    }
+    t->opened = false;
+  }
+  perf_enabled = false;
+}
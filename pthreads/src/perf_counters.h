@@ -0,0 +1,70 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+/**
+ * @brief Hardware counters of each thread, read with perf_event_open.
+ *
+ * Every thread opens its own counters (they count only the calling thread)
+ * the first time it enters a phase, and accumulates the difference between
+ * the readings at the start and at the end of each phase. Events are opened
+ * one by one, so that an event missing on the CPU (or in a VM) is reported
+ * as n/a without losing the others; multiplexed events are scaled by the
+ * fraction of time they were actually counting.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_LLC_MISSES,
+  PERF_DTLB_MISSES,
+  PERF_STALLED_CYCLES,
+  PERF_NUM_EVENTS
+} PerfEvent;
+
+typedef enum {
+  PERF_BUILD,     // Construction of the merged CSR (main thread)
+  PERF_TRAVERSAL, // Top-down steps and barriers
+  PERF_FINALIZE,  // Write-back of the distances
+  PERF_NUM_PHASES
+} PerfPhase;
+
+// Slot of the main thread, after the workers
+#define PERF_MAIN_THREAD MAX_THREADS
+
+extern bool perf_enabled;
+
+/**
+ * Checks that at least one event can be opened by the calling thread and
+ * enables the counters. Otherwise prints why and returns false, leaving them
+ * disabled.
+ */
+bool perf_counters_init();
+
+/**
+ * Starts (or ends) `phase` for the calling thread, which uses slot
+ * `thread_id` (PERF_MAIN_THREAD for the main thread).
+ */
+void perf_begin(int thread_id, PerfPhase phase);
+void perf_end(int thread_id, PerfPhase phase);
+
+/**
+ * Clears the counts accumulated by all threads.
+ */
+void perf_reset();
+
+/**
+ * Prints the counts of `phase`, one line per thread that took part in it
+ * and one with the total.
+ */
+void perf_print(int run_id, PerfPhase phase);
+
+/**
+ * Closes the counters of all threads.
+ */
+void perf_counters_destroy();
+
+#endif // PERF_COUNTERS_H
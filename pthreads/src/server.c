@@ -0,0 +1,590 @@
+#define _GNU_SOURCE
+#include "server.h"
+#include "bfs.h"
+#include "config.h"
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+  int fd;
+  int refs;    // The connection and its queued requests, under `lock`
+  bool failed; // A send failed or timed out, later results are dropped;
+               // under `lock`
+  // Request being read
+  ServerRequest header;
+  size_t header_bytes;
+  uint32_t *sources;
+  size_t source_bytes;
+} Client;
+
+typedef struct Request {
+  Client *client;
+  ServerRequest header;
+  uint32_t *sources;
+  uint32_t status;  // SERVER_BAD_REQUEST for a malformed header
+  uint32_t pending; // Results not sent yet, under `lock`
+  struct Request *next;
+} Request;
+
+typedef struct {
+  Request *request;
+  uint32_t query;     // Index of the source in the request
+  uint32_t next_same; // Next identical query of the batch, UINT32_MAX if none
+  bool duplicate;     // Answered with an earlier identical query
+} BatchQuery;
+
+typedef struct {
+  bool full;      // Computed and not sent yet, under `lock`
+  uint32_t first; // First query of the batch that asked for this result
+  ServerResult result;
+  uint32_t *values; // Distances, parents or k-hop IDs
+  uint32_t *depths; // k-hop distances
+} ResultSlot;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t slot_cond = PTHREAD_COND_INITIALIZER;
+static Request *queue_head, *queue_tail;
+static bool stopping;    // The reader exited, under `lock`
+static bool sender_done; // No more results, under `lock`
+static volatile sig_atomic_t stop_requested;
+
+// Results are computed into one slot while the other is being sent; both
+// sides go through the slots in turn, starting from next_slot
+static ResultSlot slots[2];
+static int next_slot;
+static BatchQuery *batch;
+static uint32_t server_vertices;
+static uint32_t server_edges;
+
+static void handle_stop(int signal) {
+  (void)signal;
+  stop_requested = 1;
+}
+
+static bool send_all(int fd, const void *buffer, size_t length) {
+  const char *data = (const char *)buffer;
+  while (length > 0) {
+    ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += sent;
+    length -= sent;
+  }
+  return true;
+}
+
+// Must be called with `lock` held
+static void unref_client(Client *client) {
+  if (--client->refs == 0) {
+    close(client->fd);
+    free(client->sources);
+    free(client);
+  }
+}
+
+// Results a request gets: one per source, or a single error
+static uint32_t request_results(const Request *request) {
+  return request->status == SERVER_OK ? request->header.num_sources : 1;
+}
+
+static void enqueue(Client *client, uint32_t status, uint32_t *sources) {
+  Request *request = (Request *)malloc(sizeof(Request));
+  request->client = client;
+  request->header = client->header;
+  request->sources = sources;
+  request->status = status;
+  request->pending = request_results(request);
+  request->next = NULL;
+  pthread_mutex_lock(&lock);
+  client->refs++;
+  if (queue_tail != NULL) {
+    queue_tail->next = request;
+  } else {
+    queue_head = request;
+  }
+  queue_tail = request;
+  pthread_cond_signal(&queue_cond);
+  pthread_mutex_unlock(&lock);
+}
+
+static Client *accept_client(int listen_fd) {
+  int fd = accept(listen_fd, NULL, NULL);
+  if (fd < 0) {
+    return NULL;
+  }
+  // A client that stops reading its results would stall every other one
+  struct timeval timeout = {SERVER_SEND_TIMEOUT, 0};
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  ServerHello hello = {SERVER_MAGIC, SERVER_VERSION, server_vertices,
+                       server_edges};
+  if (!send_all(fd, &hello, sizeof(hello))) {
+    close(fd);
+    return NULL;
+  }
+  Client *client = (Client *)calloc(1, sizeof(Client));
+  client->fd = fd;
+  client->refs = 1;
+  return client;
+}
+
+/**
+ * Reads what is available of the request of `client`, queueing it once
+ * complete. Returns false if the connection is closed or the request is
+ * malformed, so that the client is not read anymore.
+ */
+static bool read_client(Client *client) {
+  ServerRequest *header = &client->header;
+  ssize_t bytes;
+  if (client->header_bytes < sizeof(ServerRequest)) {
+    bytes = recv(client->fd, (char *)header + client->header_bytes,
+                 sizeof(ServerRequest) - client->header_bytes, MSG_DONTWAIT);
+    if (bytes <= 0) {
+      return bytes < 0 && (errno == EAGAIN || errno == EINTR);
+    }
+    client->header_bytes += bytes;
+    if (client->header_bytes < sizeof(ServerRequest)) {
+      return true;
+    }
+    if (header->magic != SERVER_MAGIC || header->mode > SERVER_KHOP ||
+        header->num_sources > SERVER_MAX_SOURCES) {
+      enqueue(client, SERVER_BAD_REQUEST, NULL);
+      return false;
+    }
+    client->sources =
+        (uint32_t *)malloc((size_t)header->num_sources * sizeof(uint32_t));
+    client->source_bytes = 0;
+  } else {
+    bytes = recv(client->fd, (char *)client->sources + client->source_bytes,
+                 header->num_sources * sizeof(uint32_t) - client->source_bytes,
+                 MSG_DONTWAIT);
+    if (bytes <= 0) {
+      return bytes < 0 && (errno == EAGAIN || errno == EINTR);
+    }
+    client->source_bytes += bytes;
+  }
+  if (client->source_bytes == header->num_sources * sizeof(uint32_t)) {
+    if (header->num_sources > 0) {
+      enqueue(client, SERVER_OK, client->sources);
+    } else {
+      free(client->sources);
+    }
+    client->sources = NULL;
+    client->header_bytes = 0;
+  }
+  return true;
+}
+
+static void *reader_main(void *arg) {
+  int listen_fd = *(int *)arg;
+  struct pollfd fds[SERVER_MAX_CLIENTS + 1];
+  Client *clients[SERVER_MAX_CLIENTS + 1];
+  int num_fds = 1;
+  fds[0] = (struct pollfd){listen_fd, POLLIN, 0};
+  while (!stop_requested) {
+    // The timeout bounds the delay to notice a stop request
+    if (poll(fds, num_fds, 100) <= 0) {
+      continue;
+    }
+    if (fds[0].revents & POLLIN) {
+      Client *client = accept_client(listen_fd);
+      if (client != NULL && num_fds == SERVER_MAX_CLIENTS + 1) {
+        printf("Refused a client, %d are connected\n", SERVER_MAX_CLIENTS);
+        pthread_mutex_lock(&lock);
+        unref_client(client);
+        pthread_mutex_unlock(&lock);
+      } else if (client != NULL) {
+        fds[num_fds] = (struct pollfd){client->fd, POLLIN, 0};
+        clients[num_fds++] = client;
+      }
+    }
+    // Backwards, so that the last client can take the place of a closed one
+    for (int i = num_fds - 1; i >= 1; i--) {
+      if (fds[i].revents == 0 || read_client(clients[i])) {
+        continue;
+      }
+      pthread_mutex_lock(&lock);
+      unref_client(clients[i]);
+      pthread_mutex_unlock(&lock);
+      num_fds--;
+      fds[i] = fds[num_fds];
+      clients[i] = clients[num_fds];
+    }
+  }
+  pthread_mutex_lock(&lock);
+  for (int i = 1; i < num_fds; i++) {
+    unref_client(clients[i]);
+  }
+  stopping = true;
+  pthread_cond_signal(&queue_cond);
+  pthread_mutex_unlock(&lock);
+  return NULL;
+}
+
+// Only the sender sets `failed`, so it can read it without `lock`
+static void send_result(const ResultSlot *slot, const BatchQuery *query) {
+  Client *client = query->request->client;
+  if (client->failed) {
+    return;
+  }
+  ServerResult result = slot->result;
+  result.request_id = query->request->header.request_id;
+  result.query = query->query;
+  result.source = query->request->sources != NULL
+                      ? query->request->sources[query->query]
+                      : UINT32_MAX;
+  size_t payload = (size_t)result.count * sizeof(uint32_t);
+  bool khop = query->request->header.mode == SERVER_KHOP;
+  if (!send_all(client->fd, &result, sizeof(result)) ||
+      !send_all(client->fd, slot->values, payload) ||
+      (khop && !send_all(client->fd, slot->depths, payload))) {
+    printf("Dropped a client that stopped reading its results\n");
+    pthread_mutex_lock(&lock);
+    client->failed = true;
+    pthread_mutex_unlock(&lock);
+  }
+}
+
+static void *sender_main(void *arg) {
+  (void)arg;
+  for (int k = next_slot;; k = 1 - k) {
+    ResultSlot *slot = &slots[k];
+    pthread_mutex_lock(&lock);
+    while (!slot->full && !sender_done) {
+      pthread_cond_wait(&slot_cond, &lock);
+    }
+    bool full = slot->full;
+    pthread_mutex_unlock(&lock);
+    if (!full) {
+      return NULL;
+    }
+    for (uint32_t i = slot->first; i != UINT32_MAX; i = batch[i].next_same) {
+      send_result(slot, &batch[i]);
+      Request *request = batch[i].request;
+      pthread_mutex_lock(&lock);
+      if (--request->pending == 0) {
+        unref_client(request->client);
+        free(request->sources);
+        free(request);
+      }
+      pthread_mutex_unlock(&lock);
+    }
+    pthread_mutex_lock(&lock);
+    slot->full = false;
+    pthread_cond_broadcast(&slot_cond);
+    pthread_mutex_unlock(&lock);
+  }
+}
+
+// Mode, depth (k-hop only) and source of a query; malformed requests have
+// no key and are never identical to another query
+static bool query_key(const BatchQuery *query, uint32_t key[3]) {
+  const Request *request = query->request;
+  if (request->status != SERVER_OK) {
+    return false;
+  }
+  key[0] = request->header.mode;
+  key[1] = request->header.mode == SERVER_KHOP ? request->header.max_depth : 0;
+  key[2] = request->sources[query->query];
+  return true;
+}
+
+// Orders the queries by key, then by position: identical queries are
+// adjacent, the earliest first
+static int compare_queries(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  uint32_t x_key[3], y_key[3];
+  bool x_valid = query_key(&batch[x], x_key);
+  bool y_valid = query_key(&batch[y], y_key);
+  if (x_valid != y_valid) {
+    return x_valid ? -1 : 1;
+  }
+  for (int i = 0; x_valid && i < 3; i++) {
+    if (x_key[i] != y_key[i]) {
+      return x_key[i] < y_key[i] ? -1 : 1;
+    }
+  }
+  return x < y ? -1 : x > y;
+}
+
+static bool same_query(uint32_t x, uint32_t y) {
+  uint32_t x_key[3], y_key[3];
+  return query_key(&batch[x], x_key) && query_key(&batch[y], y_key) &&
+         memcmp(x_key, y_key, sizeof(x_key)) == 0;
+}
+
+// Whether a client is still reading the results of a query or of one of its
+// duplicates; must be called with `lock` held
+static bool has_recipients(uint32_t index) {
+  for (uint32_t i = index; i != UINT32_MAX; i = batch[i].next_same) {
+    if (!batch[i].request->client->failed) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void run_query(ResultSlot *slot, uint32_t index, bool reorder,
+                      bool pipeline) {
+  const Request *request = batch[index].request;
+  ServerResult *result = &slot->result;
+  slot->first = index;
+  result->status = request->status;
+  result->count = 0;
+  result->levels = 0;
+  result->elapsed_ns = 0;
+  pthread_mutex_lock(&lock);
+  bool wanted = has_recipients(index);
+  pthread_mutex_unlock(&lock);
+  if (request->status != SERVER_OK || !wanted) {
+    return;
+  }
+  uint32_t source = request->sources[batch[index].query];
+  if (source >= server_vertices) {
+    result->status = SERVER_BAD_SOURCE;
+    return;
+  }
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  reorder_frontier = reorder;
+  distances = slot->values;
+  if (request->header.mode == SERVER_DISTANCES) {
+    pipeline_levels = pipeline;
+    compute_parents = false;
+    uint32_t farthest;
+    result->levels = bfs_eccentricity(source, &farthest);
+    result->count = server_vertices;
+  } else if (request->header.mode == SERVER_PARENTS) {
+    pipeline_levels = false;
+    compute_parents = true;
+    bfs(source);
+    result->count = server_vertices;
+  } else {
+    pipeline_levels = false;
+    compute_parents = false;
+    // No vertex is farther than num_vertices - 1 hops
+    uint32_t depth = request->header.max_depth < server_vertices
+                         ? request->header.max_depth
+                         : server_vertices;
+    result->count = bfs_bounded(source, depth, slot->values, slot->depths);
+    // The slot buffers hold one entry per vertex, which bfs_bounded logs once
+    assert(result->count <= server_vertices &&
+           "k-hop query returned more vertices than the graph has");
+    for (uint32_t i = 0; i < result->count; i++) {
+      if (slot->depths[i] > result->levels) {
+        result->levels = slot->depths[i];
+      }
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  result->elapsed_ns = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ull +
+                       (end.tv_nsec - start.tv_nsec);
+}
+
+/**
+ * Answers the queries of `requests` (a list of `num_requests` requests with
+ * `num_queries` queries in total), each distinct query once.
+ */
+static void run_batch(Request *requests, uint32_t num_requests,
+                      uint32_t num_queries, int batch_id, bool reorder,
+                      bool pipeline) {
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  batch = (BatchQuery *)malloc(num_queries * sizeof(BatchQuery));
+  uint32_t *order = (uint32_t *)malloc(num_queries * sizeof(uint32_t));
+  uint32_t n = 0;
+  for (Request *request = requests; n < num_queries;
+       request = request->next) {
+    for (uint32_t q = 0; q < request_results(request); q++, n++) {
+      batch[n] = (BatchQuery){request, q, UINT32_MAX, false};
+      order[n] = n;
+    }
+  }
+  qsort(order, num_queries, sizeof(uint32_t), compare_queries);
+  // The first of each run of identical queries is answered, and its result
+  // sent along the run
+  uint32_t unique = num_queries;
+  for (uint32_t k = 1; k < num_queries; k++) {
+    if (same_query(order[k - 1], order[k])) {
+      batch[order[k - 1]].next_same = order[k];
+      batch[order[k]].duplicate = true;
+      unique--;
+    }
+  }
+
+  for (uint32_t i = 0; i < num_queries; i++) {
+    if (batch[i].duplicate) {
+      continue;
+    }
+    ResultSlot *slot = &slots[next_slot];
+    next_slot = 1 - next_slot;
+    pthread_mutex_lock(&lock);
+    while (slot->full) {
+      pthread_cond_wait(&slot_cond, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+    run_query(slot, i, reorder, pipeline);
+    pthread_mutex_lock(&lock);
+    slot->full = true;
+    pthread_cond_broadcast(&slot_cond);
+    pthread_mutex_unlock(&lock);
+  }
+  pthread_mutex_lock(&lock);
+  while (slots[0].full || slots[1].full) {
+    pthread_cond_wait(&slot_cond, &lock);
+  }
+  pthread_mutex_unlock(&lock);
+  free(order);
+  free(batch);
+  batch = NULL;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  long seconds = end.tv_sec - start.tv_sec;
+  long nanoseconds = end.tv_nsec - start.tv_nsec;
+  double elapsed = seconds + nanoseconds * 1e-9;
+  printf("batch_id=%d,requests=%u,queries=%u,unique=%u,threads=%d,%.4f\n",
+         batch_id, num_requests, num_queries, unique, MAX_THREADS, elapsed);
+  fflush(stdout);
+}
+
+/**
+ * Binds the socket at `path`, replacing a stale socket file left by a server
+ * that did not exit cleanly. Returns the listening socket, or -1.
+ */
+static int listen_socket(const char *path) {
+  struct sockaddr_un address = {.sun_family = AF_UNIX};
+  if (strlen(path) >= sizeof(address.sun_path)) {
+    printf("Socket path [%s] is too long\n", path);
+    return -1;
+  }
+  strcpy(address.sun_path, path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    printf("Cannot create socket: %s\n", strerror(errno));
+    return -1;
+  }
+  int bound = bind(fd, (struct sockaddr *)&address, sizeof(address));
+  if (bound != 0 && errno == EADDRINUSE) {
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool alive =
+        connect(probe, (struct sockaddr *)&address, sizeof(address)) == 0;
+    close(probe);
+    if (alive) {
+      printf("Another server is listening on [%s]\n", path);
+      close(fd);
+      return -1;
+    }
+    unlink(path);
+    bound = bind(fd, (struct sockaddr *)&address, sizeof(address));
+  }
+  if (bound != 0) {
+    printf("Cannot bind [%s]: %s\n", path, strerror(errno));
+    close(fd);
+    return -1;
+  }
+  if (listen(fd, SERVER_MAX_CLIENTS) != 0) {
+    printf("Cannot listen on [%s]: %s\n", path, strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int serve(const char *socket_path, uint32_t num_vertices, uint32_t num_edges,
+          bool reorder, bool pipeline) {
+  server_vertices = num_vertices;
+  server_edges = num_edges;
+  int listen_fd = listen_socket(socket_path);
+  if (listen_fd < 0) {
+    return -1;
+  }
+  // No SA_RESTART, so that the reader's poll is interrupted
+  struct sigaction action = {.sa_handler = handle_stop};
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  for (int k = 0; k < 2; k++) {
+    slots[k].full = false;
+    slots[k].values = (uint32_t *)malloc(num_vertices * sizeof(uint32_t));
+    slots[k].depths = (uint32_t *)malloc(num_vertices * sizeof(uint32_t));
+  }
+  next_slot = 0;
+  stop_requested = 0;
+  stopping = false;
+  sender_done = false;
+  pthread_t reader, sender;
+  pthread_create(&reader, NULL, reader_main, &listen_fd);
+  pthread_create(&sender, NULL, sender_main, NULL);
+  printf("Listening on [%s]: %u vertices, %u edges, %d threads\n",
+         socket_path, num_vertices, num_edges, MAX_THREADS);
+  fflush(stdout);
+
+  int batches = 0;
+  uint64_t queries = 0;
+  while (true) {
+    pthread_mutex_lock(&lock);
+    while (queue_head == NULL && !stopping) {
+      pthread_cond_wait(&queue_cond, &lock);
+    }
+    if (stopping) {
+      pthread_mutex_unlock(&lock);
+      break;
+    }
+    // Every queued request joins the batch, up to SERVER_MAX_BATCH queries
+    Request *requests = queue_head;
+    uint32_t num_requests = 0, num_queries = 0;
+    while (queue_head != NULL &&
+           (num_requests == 0 ||
+            num_queries + request_results(queue_head) <= SERVER_MAX_BATCH)) {
+      num_queries += request_results(queue_head);
+      num_requests++;
+      queue_head = queue_head->next;
+    }
+    if (queue_head == NULL) {
+      queue_tail = NULL;
+    }
+    pthread_mutex_unlock(&lock);
+    run_batch(requests, num_requests, num_queries, batches++, reorder,
+              pipeline);
+    queries += num_queries;
+  }
+
+  pthread_mutex_lock(&lock);
+  sender_done = true;
+  pthread_cond_broadcast(&slot_cond);
+  // Requests still queued are dropped
+  while (queue_head != NULL) {
+    Request *request = queue_head;
+    queue_head = request->next;
+    unref_client(request->client);
+    free(request->sources);
+    free(request);
+  }
+  queue_tail = NULL;
+  pthread_mutex_unlock(&lock);
+  pthread_join(sender, NULL);
+  pthread_join(reader, NULL);
+  for (int k = 0; k < 2; k++) {
+    free(slots[k].values);
+    free(slots[k].depths);
+  }
+  close(listen_fd);
+  unlink(socket_path);
+  printf("Server stopped after %d batches, %lu queries\n", batches,
+         (unsigned long)queries);
+  return 0;
+}
@@ -0,0 +1,89 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+/**
+ * @brief Long-running query server over a Unix domain socket (server mode).
+ *
+ * The graph is loaded (or attached) and the BFS engine started once; clients
+ * then connect to the socket and send batches of queries. Three threads share
+ * the work:
+ *  - the reader accepts connections and reads the requests into a queue;
+ *  - the executor (the caller of serve) takes every queued request at once as
+ *    a batch, runs identical queries of the batch (same mode, depth and
+ *    source, from any client) once, and runs the queries back to back on the
+ *    engine, so the workers do not wait for the clients in between;
+ *  - the sender streams each result to the clients that asked for it while
+ *    the executor runs the next query (results are double-buffered).
+ *
+ * The protocol is binary, in the byte order of the host. On connection the
+ * server sends a ServerHello. A request is a ServerRequest followed by
+ * `num_sources` uint32_t sources; a client can send several requests without
+ * waiting. Each query is answered with a ServerResult followed by its payload:
+ *  - SERVER_DISTANCES: `count` = num_vertices distances (UINT32_MAX for
+ *    unreached vertices);
+ *  - SERVER_PARENTS: `count` = num_vertices parents (the source is its own
+ *    parent);
+ *  - SERVER_KHOP: the `count` vertices within `max_depth` hops, as `count`
+ *    IDs followed by their `count` distances, in no particular order.
+ * Results carry the request ID and the index of the query in the request,
+ * and can come in any order: the identical queries of a batch are answered
+ * together, with the first of them. A query with an out of range source gets
+ * SERVER_BAD_SOURCE and no payload; a malformed request gets a single
+ * SERVER_BAD_REQUEST result, after which the connection is not read anymore.
+ * pthreads/scripts/bfs_client.py is a client.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SERVER_MAGIC 0x53534642u // "BFSS"
+#define SERVER_VERSION 1
+
+typedef enum {
+  SERVER_DISTANCES = 0,
+  SERVER_PARENTS = 1,
+  SERVER_KHOP = 2
+} ServerMode;
+
+typedef enum {
+  SERVER_OK = 0,
+  SERVER_BAD_SOURCE = 1,
+  SERVER_BAD_REQUEST = 2
+} ServerStatus;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t num_vertices;
+  uint32_t num_edges;
+} ServerHello;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t request_id; // Chosen by the client, echoed in the results
+  uint32_t mode;       // ServerMode
+  uint32_t max_depth;  // Levels of the SERVER_KHOP queries
+  uint32_t num_sources;
+} ServerRequest;
+
+typedef struct {
+  uint32_t request_id;
+  uint32_t query;  // Index of the source in the request
+  uint32_t source;
+  uint32_t status; // ServerStatus
+  uint32_t count;  // Vertices in the payload
+  uint32_t levels; // Eccentricity of the source (deepest reached level for
+                   // SERVER_KHOP, 0 for SERVER_PARENTS)
+  uint64_t elapsed_ns; // Time of the traversal
+} ServerResult;
+
+/**
+ * Serves queries on the socket `socket_path` with the prepared engine (see
+ * initialize_bfs) until SIGINT or SIGTERM; `reorder` and `pipeline` are the
+ * options of the distance queries. Prints one line per batch. Returns 0, or
+ * -1 if the socket cannot be created.
+ */
+int serve(const char *socket_path, uint32_t num_vertices, uint32_t num_edges,
+          bool reorder, bool pipeline);
+
+#endif // SERVER_H
@@ -0,0 +1,162 @@
+#define _GNU_SOURCE
+#include "shared_graph.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+#define SHARED_GRAPH_MAGIC 0x4850524753464231ull // "1BFSGRPH"
+#define SHARED_GRAPH_VERSION 1
+// The merged array starts on a cache line
+#define SHARED_GRAPH_ALIGNMENT 64
+
+typedef struct {
+  uint64_t magic; // Written last, once the segment is complete
+  uint32_t version;
+  uint32_t mer_size;      // sizeof(mer_t) of the publisher
+  uint32_t metadata_size; // METADATA_SIZE of the publisher
+  uint32_t num_vertices;
+  uint32_t num_edges;
+  uint32_t reserved;
+  uint64_t row_ptr_offset; // Offsets from the start of the segment
+  uint64_t merged_offset;
+  uint64_t used; // Bytes used, the segment is rounded up to its page size
+} __attribute__((aligned(SHARED_GRAPH_ALIGNMENT))) SharedGraphHeader;
+
+static uint64_t align_up(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// Names containing '/' are files (e.g. on hugetlbfs), the others POSIX shared
+// memory objects
+static int open_segment(const char *name, int flags, mode_t mode) {
+  if (strchr(name, '/') != NULL) {
+    return open(name, flags, mode);
+  }
+  char shm_name[256];
+  snprintf(shm_name, sizeof(shm_name), "/%s", name);
+  return shm_open(shm_name, flags, mode);
+}
+
+static void unlink_segment(const char *name) {
+  if (strchr(name, '/') != NULL) {
+    unlink(name);
+  } else {
+    char shm_name[256];
+    snprintf(shm_name, sizeof(shm_name), "/%s", name);
+    shm_unlink(shm_name);
+  }
+}
+
+int shared_graph_publish(const char *name, const mmio_csr_u32_f32_t *graph) {
+  uint64_t words = merged_csr_words(graph);
+  if (words > UINT32_MAX) {
+    printf("The merged CSR has %lu words, more than its offsets can address\n",
+           (unsigned long)words);
+    return -1;
+  }
+  uint64_t row_ptr_offset = sizeof(SharedGraphHeader);
+  uint64_t merged_offset =
+      align_up(row_ptr_offset + ((uint64_t)graph->nrows + 1) * sizeof(mer_t),
+               SHARED_GRAPH_ALIGNMENT);
+  uint64_t used = merged_offset + words * sizeof(mer_t);
+
+  int fd = open_segment(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0) {
+    printf("Cannot create shared graph [%s]: %s\n", name, strerror(errno));
+    return -1;
+  }
+  // Files on hugetlbfs must be a multiple of the huge page size, which is the
+  // block size of the file system
+  struct statfs fs;
+  uint64_t page = fstatfs(fd, &fs) == 0 && fs.f_bsize > 0 ? fs.f_bsize : 4096;
+  size_t size = align_up(used, page);
+  void *base = MAP_FAILED;
+  // Reserving the pages up front fails now, instead of with a SIGBUS while
+  // writing, if /dev/shm or the huge page pool is too small
+  int error = ftruncate(fd, size) != 0 ? errno : posix_fallocate(fd, 0, size);
+  if (error == 0 || error == EOPNOTSUPP || error == EINVAL) {
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    error = base == MAP_FAILED ? errno : 0;
+  }
+  close(fd);
+  if (base == MAP_FAILED) {
+    printf("Cannot allocate %.2f MiB for shared graph [%s]: %s\n",
+           size / (1024.0 * 1024.0), name, strerror(error));
+    unlink_segment(name);
+    return -1;
+  }
+
+  SharedGraphHeader *header = (SharedGraphHeader *)base;
+  header->version = SHARED_GRAPH_VERSION;
+  header->mer_size = sizeof(mer_t);
+  header->metadata_size = METADATA_SIZE;
+  header->num_vertices = graph->nrows;
+  header->num_edges = graph->nnz;
+  header->reserved = 0;
+  header->row_ptr_offset = row_ptr_offset;
+  header->merged_offset = merged_offset;
+  header->used = used;
+  fill_merged_csr(graph, (mer_t *)((char *)base + row_ptr_offset),
+                  (mer_t *)((char *)base + merged_offset));
+  __atomic_store_n(&header->magic, SHARED_GRAPH_MAGIC, __ATOMIC_RELEASE);
+  munmap(base, size);
+  printf("Published shared graph [%s]: %u vertices, %u edges, %.2f MiB\n",
+         name, graph->nrows, graph->nnz, size / (1024.0 * 1024.0));
+  return 0;
+}
+
+SharedGraph *shared_graph_attach(const char *name) {
+  int fd = open_segment(name, O_RDONLY, 0);
+  if (fd < 0) {
+    printf("Cannot open shared graph [%s]: %s\n", name, strerror(errno));
+    return NULL;
+  }
+  struct stat st;
+  void *base = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(SharedGraphHeader)) {
+    base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (base == MAP_FAILED) {
+    printf("Cannot map shared graph [%s]\n", name);
+    return NULL;
+  }
+
+  const SharedGraphHeader *header = (const SharedGraphHeader *)base;
+  const char *problem = NULL;
+  if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) !=
+      SHARED_GRAPH_MAGIC) {
+    problem = "is not a shared graph, or is still being published";
+  } else if (header->version != SHARED_GRAPH_VERSION ||
+             header->mer_size != sizeof(mer_t) ||
+             header->metadata_size != METADATA_SIZE) {
+    problem = "was published by an incompatible build";
+  } else if (header->used > (uint64_t)st.st_size) {
+    problem = "is truncated";
+  }
+  if (problem != NULL) {
+    printf("Shared graph [%s] %s\n", name, problem);
+    munmap(base, st.st_size);
+    return NULL;
+  }
+
+  SharedGraph *shared = (SharedGraph *)malloc(sizeof(SharedGraph));
+  shared->base = base;
+  shared->size = st.st_size;
+  shared->csr.num_vertices = header->num_vertices;
+  shared->csr.num_edges = header->num_edges;
+  shared->csr.row_ptr = (mer_t *)((char *)base + header->row_ptr_offset);
+  shared->csr.merged = (mer_t *)((char *)base + header->merged_offset);
+  return shared;
+}
+
+void shared_graph_detach(SharedGraph *shared) {
+  munmap(shared->base, shared->size);
+  free(shared);
+}
@@ -0,0 +1,43 @@
+#ifndef SHARED_GRAPH_H
+#define SHARED_GRAPH_H
+
+/**
+ * @brief Merged CSR shared between the processes of a host.
+ *
+ * A publisher builds the merged CSR of a graph once, directly into a named
+ * segment: a POSIX shared memory object (/dev/shm) for a plain name, or a
+ * file for a name containing '/', e.g. on a hugetlbfs mount to back the
+ * graph with huge pages. The segment outlives the publisher and holds a
+ * header, the merged row pointers and the merged array. Other processes
+ * attach it read-only with mmap, so the graph is loaded, converted and kept
+ * in memory once per host; the mutable visit state (the DISTANCE slots of a
+ * private merged CSR) is kept per process by the engine, indexed by vertex ID
+ * (see initialize_bfs_shared). The segment is removed with `rm` (under
+ * /dev/shm for a plain name).
+ */
+
+#include "merged_csr.h"
+#include "mmio_c_wrapper.h"
+#include <stddef.h>
+
+typedef struct SharedGraph {
+  void *base;    // Mapping of the whole segment
+  size_t size;   // Size of the mapping
+  MergedCSR csr; // Points into the mapping, which is read-only
+} SharedGraph;
+
+/**
+ * Creates the segment `name` (which must not exist) and builds the merged CSR
+ * of `graph` into it. Returns 0, or -1 after printing why.
+ */
+int shared_graph_publish(const char *name, const mmio_csr_u32_f32_t *graph);
+
+/**
+ * Maps the segment `name` read-only. Returns NULL, after printing why, if it
+ * does not exist or was published by an incompatible build.
+ */
+SharedGraph *shared_graph_attach(const char *name);
+
+void shared_graph_detach(SharedGraph *shared);
+
+#endif // SHARED_GRAPH_H
@@ -0,0 +1,239 @@
+#include "sssp.h"
+#include "barrier.h"
+#include "frontier.h"
+#include "merged_csr.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Distances are non-negative floats: comparing their bits as unsigned
+// integers gives the same order, and the UINT32_MAX initial value of the
+// DISTANCE slot is larger than any of them
+#define SSSP_UNREACHED UINT32_MAX
+#define NO_BUCKET SIZE_MAX
+
+typedef struct {
+  VertexLog *bins; // bins[i] holds the vertices relaxed into bucket i
+  size_t num_bins;
+} ThreadBins;
+
+static MergedCSR *sssp_csr;
+static Frontier *sssp_frontier;
+static ThreadBins sssp_bins[MAX_THREADS];
+static Barrier sssp_barrier;
+static float *sssp_distances;
+static float sssp_delta;
+
+static volatile size_t current_bucket;
+static atomic_size_t next_bucket;
+static uint32_t processed_buckets;
+
+static inline float to_float(mer_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof(float));
+  return value;
+}
+
+static inline mer_t to_bits(float value) {
+  mer_t bits = 0;
+  memcpy(&bits, &value, sizeof(float));
+  return bits;
+}
+
+/**
+ * Bucket of a distance. Both the binning and the settled check of relax_chunk
+ * go through here, so that they agree despite the float rounding.
+ */
+static inline size_t bucket_of(float distance) {
+  float bucket = distance / sssp_delta;
+  return bucket < SSSP_MAX_BUCKETS - 1 ? (size_t)bucket : SSSP_MAX_BUCKETS - 1;
+}
+
+static void bin_push(ThreadBins *thread_bins, size_t bucket, mer_t v) {
+  if (bucket >= thread_bins->num_bins) {
+    size_t num_bins = thread_bins->num_bins == 0 ? 64 : thread_bins->num_bins;
+    while (num_bins <= bucket) {
+      num_bins *= 2;
+    }
+    thread_bins->bins = (VertexLog *)realloc(thread_bins->bins,
+                                             num_bins * sizeof(VertexLog));
+    for (size_t i = thread_bins->num_bins; i < num_bins; i++) {
+      vertex_log_init(&thread_bins->bins[i]);
+    }
+    thread_bins->num_bins = num_bins;
+  }
+  vertex_log_push(&thread_bins->bins[bucket], v);
+}
+
+/**
+ * Relaxes the edges of the vertices of a chunk. Vertices whose distance has
+ * decreased below the current bucket since they were queued have already been
+ * settled and are skipped.
+ */
+static void relax_chunk(Chunk *c, int thread_id) {
+  mer_t v = VERT_MAX;
+  while ((v = chunk_pop_vertex(c)) != VERT_MAX) {
+    float distance = to_float(DISTANCE(sssp_csr, v));
+    if (bucket_of(distance) < current_bucket) {
+      continue;
+    }
+    mer_t end = v + METADATA_SIZE + DEGREE(sssp_csr, v) * WEIGHTED_DATA_SIZE;
+    for (mer_t i = v + METADATA_SIZE; i < end; i += WEIGHTED_DATA_SIZE) {
+      mer_t neighbor = sssp_csr->merged[i];
+      float new_distance = distance + to_float(sssp_csr->merged[i + 1]);
+      mer_t new_bits = to_bits(new_distance);
+      mer_t old_bits =
+          __atomic_load_n(&DISTANCE(sssp_csr, neighbor), __ATOMIC_RELAXED);
+      while (new_bits < old_bits) {
+        if (__atomic_compare_exchange_n(&DISTANCE(sssp_csr, neighbor),
+                                        &old_bits, new_bits, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+          bin_push(&sssp_bins[thread_id], bucket_of(new_distance), neighbor);
+          break;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Processes the current bucket: chunks of this thread first, then stealing
+ * from the other threads (same scheme as top_down in bfs.c).
+ */
+static void process_bucket(int thread_id) {
+  Chunk *c = NULL;
+  while ((c = frontier_remove_chunk(sssp_frontier, thread_id)) != NULL) {
+    relax_chunk(c, thread_id);
+  }
+  bool work_to_do = true;
+  while (work_to_do) {
+    work_to_do = false;
+    for (int i = 0; i < MAX_THREADS; i++) {
+      if (sssp_frontier->thread_chunks[i]->top_chunk > 1) {
+        work_to_do = true;
+        if ((c = frontier_remove_chunk(sssp_frontier, i)) != NULL) {
+          relax_chunk(c, thread_id);
+        }
+        i--;
+      }
+    }
+  }
+}
+
+static void select_bucket(void *arg) {
+  (void)arg;
+  current_bucket = atomic_load(&next_bucket);
+  atomic_store(&next_bucket, NO_BUCKET);
+  if (current_bucket != NO_BUCKET) {
+    processed_buckets++;
+  }
+}
+
+static void notify_parent(void *arg) {
+  (void)arg;
+  thread_pool_notify_parent(&tp);
+}
+
+static void *sssp_thread_main(void *arg) {
+  int thread_id = *(int *)arg;
+  ThreadBins *thread_bins = &sssp_bins[thread_id];
+
+  while (current_bucket != NO_BUCKET) {
+    process_bucket(thread_id);
+
+    // Propose the smallest non-empty local bin (the current bucket may have
+    // been refilled by the relaxations)
+    for (size_t i = current_bucket; i < thread_bins->num_bins; i++) {
+      if (thread_bins->bins[i].size > 0) {
+        size_t proposed = atomic_load(&next_bucket);
+        while (i < proposed &&
+               !atomic_compare_exchange_weak(&next_bucket, &proposed, i))
+          ;
+        break;
+      }
+    }
+    barrier_wait(&sssp_barrier, select_bucket, NULL);
+
+    // Move the local bin of the selected bucket into this thread's chunks
+    if (current_bucket != NO_BUCKET &&
+        current_bucket < thread_bins->num_bins) {
+      VertexLog *bin = &thread_bins->bins[current_bucket];
+      Chunk *dest = NULL;
+      for (uint32_t i = 0; i < bin->size; i++) {
+        if (dest == NULL || dest->next_free_index >= CHUNK_SIZE) {
+          dest = frontier_create_chunk(sssp_frontier, thread_id);
+        }
+        chunk_push_vertex(dest, bin->vertices[i]);
+      }
+      bin->size = 0;
+    }
+    barrier_wait(&sssp_barrier, NULL, NULL);
+  }
+
+  // Write distances to the output array and reset them
+  mer_t chunk_size = sssp_csr->num_vertices / MAX_THREADS;
+  mer_t start = thread_id * chunk_size;
+  mer_t end = (thread_id == MAX_THREADS - 1) ? sssp_csr->num_vertices
+                                             : (thread_id + 1) * chunk_size;
+  for (mer_t i = start; i < end; i++) {
+    mer_t bits = DISTANCE(sssp_csr, sssp_csr->row_ptr[i]);
+    sssp_distances[i] = bits == SSSP_UNREACHED ? INFINITY : to_float(bits);
+    DISTANCE(sssp_csr, sssp_csr->row_ptr[i]) = SSSP_UNREACHED;
+  }
+  barrier_wait(&sssp_barrier, notify_parent, NULL);
+  return NULL;
+}
+
+void initialize_sssp(const mmio_csr_u32_f32_t *graph) {
+  sssp_csr = to_weighted_merged_csr(graph);
+  sssp_frontier = frontier_create();
+  for (int i = 0; i < MAX_THREADS; i++) {
+    sssp_bins[i].bins = NULL;
+    sssp_bins[i].num_bins = 0;
+  }
+  barrier_init(&sssp_barrier);
+  init_thread_pool(&tp, sssp_thread_main);
+  thread_pool_create(&tp);
+}
+
+uint32_t sssp(uint32_t source, float delta, float *distances) {
+  mer_t v = sssp_csr->row_ptr[source];
+  DISTANCE(sssp_csr, v) = to_bits(0.0f);
+  chunk_push_vertex(frontier_create_chunk(sssp_frontier, 0), v);
+  sssp_distances = distances;
+  sssp_delta = delta;
+  current_bucket = 0;
+  next_bucket = NO_BUCKET;
+  processed_buckets = 1;
+  atomic_thread_fence(memory_order_seq_cst);
+  thread_pool_start_wait(&tp);
+  return processed_buckets;
+}
+
+float sssp_average_weight() {
+  double total = 0;
+  for (mer_t i = 0; i < sssp_csr->num_vertices; i++) {
+    mer_t v = sssp_csr->row_ptr[i];
+    mer_t end = v + METADATA_SIZE + DEGREE(sssp_csr, v) * WEIGHTED_DATA_SIZE;
+    for (mer_t j = v + METADATA_SIZE; j < end; j += WEIGHTED_DATA_SIZE) {
+      total += to_float(sssp_csr->merged[j + 1]);
+    }
+  }
+  return sssp_csr->num_edges > 0 ? total / sssp_csr->num_edges : 1.0f;
+}
+
+void destroy_sssp() {
+  thread_pool_terminate(&tp);
+  destroy_thread_pool(&tp);
+  frontier_destroy(sssp_frontier);
+  for (int i = 0; i < MAX_THREADS; i++) {
+    for (size_t j = 0; j < sssp_bins[i].num_bins; j++) {
+      vertex_log_destroy(&sssp_bins[i].bins[j]);
+    }
+    free(sssp_bins[i].bins);
+  }
+  destroy_merged_csr(sssp_csr);
+}
@@ -0,0 +1,47 @@
+#ifndef SSSP_H
+#define SSSP_H
+
+/**
+ * @brief Parallel delta-stepping single-source shortest paths.
+ *
+ * Works on the weighted merged CSR (see to_weighted_merged_csr), where the
+ * weight of each edge is stored right after the neighbor offset, and keeps the
+ * tentative distance (a float) in the DISTANCE slot of each vertex.
+ *
+ * Vertices are grouped in buckets of width delta. The current bucket is a
+ * chunked per-thread Frontier, processed with the same own-chunks-first, then
+ * work-stealing scheme as the BFS. Relaxed vertices go to thread-local bins,
+ * one per bucket; once the current bucket is empty, the threads agree on the
+ * smallest non-empty bucket and each one moves its own bin into its chunk
+ * pool of the Frontier.
+ */
+
+#include "config.h"
+#include "mmio_c_wrapper.h"
+#include <stdint.h>
+
+/**
+ * Builds the weighted merged CSR and the frontier and starts the thread pool
+ * with the delta-stepping worker routine.
+ */
+void initialize_sssp(const mmio_csr_u32_f32_t *graph);
+
+/**
+ * Computes the weighted distances from `source` to all vertices, with bucket
+ * width `delta`, writing them to `distances` (INFINITY for unreachable
+ * vertices). Returns the number of bucket phases (a bucket that is refilled
+ * by its own relaxations is processed in more than one phase).
+ */
+uint32_t sssp(uint32_t source, float delta, float *distances);
+
+/**
+ * Gets the average edge weight of the graph, a reasonable default for delta.
+ */
+float sssp_average_weight();
+
+/**
+ * Stops the thread pool and frees the SSSP data structures.
+ */
+void destroy_sssp();
+
+#endif // SSSP_H
@@ -24,6 +24,8 @@ void init_thread_pool(thread_pool_t *tp, void *(*routine)(void *)) {
   tp->stop_threads = false;
   tp->children_done = false;
   tp->routine = routine;
+  tp->next_task = 0;
+  tp->num_tasks = 0;
 }
 
 int wait_for_work(thread_pool_t *tp, uint *run_id) {
@@ -171,6 +173,17 @@ void thread_pool_start_wait(thread_pool_t *tp) {
   pthread_mutex_unlock(&tp->mutex_parent);
 }
 
+void thread_pool_start_tasks_wait(thread_pool_t *tp, int num_tasks) {
+  tp->num_tasks = num_tasks;
+  atomic_store(&tp->next_task, 0);
+  thread_pool_start_wait(tp);
+}
+
+int thread_pool_next_task(thread_pool_t *tp) {
+  int task = atomic_fetch_add(&tp->next_task, 1);
+  return task < tp->num_tasks ? task : -1;
+}
+
 void thread_pool_notify_parent(thread_pool_t *tp) {
   pthread_mutex_lock(&tp->mutex_parent);
   tp->children_done = true;
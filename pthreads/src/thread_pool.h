@@ -31,6 +31,9 @@ typedef struct {
   pthread_mutex_t mutex_parent;
 
   void *(*routine)(void *); // Store the worker function pointer
+
+  atomic_int next_task; // Next task to hand out in throughput mode
+  int num_tasks;        // Number of tasks of the current throughput cycle
 } thread_pool_t;
 
 extern thread_pool_t tp;
@@ -87,6 +90,28 @@ void thread_pool_create(thread_pool_t *tp);
  */
 void thread_pool_start_wait(thread_pool_t *tp);
 
+/**
+ * @brief Starts a work cycle in throughput mode and waits for its completion.
+ *
+ * Instead of cooperating on a single task, the workers pull `num_tasks`
+ * independent tasks (indices 0 to num_tasks-1) from a shared queue with
+ * `thread_pool_next_task` until it is empty. As for
+ * `thread_pool_start_wait`, the routine must call `thread_pool_notify_parent`
+ * once all workers are done.
+ *
+ * @param tp Pointer to the thread_pool_t structure.
+ * @param num_tasks Number of tasks in the queue.
+ */
+void thread_pool_start_tasks_wait(thread_pool_t *tp, int num_tasks);
+
+/**
+ * @brief Takes the next task from the queue of the current throughput cycle.
+ *
+ * @param tp Pointer to the thread_pool_t structure.
+ * @return The index of the task, or -1 if the queue is empty.
+ */
+int thread_pool_next_task(thread_pool_t *tp);
+
 /**
  * @brief Signals all worker threads to stop and waits for their termination.
  *
@@ -0,0 +1,122 @@
+#define _GNU_SOURCE
+#include "throughput.h"
+#include "thread_pool.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const MergedCSR *tp_csr;
+static VisitSlab *slabs[MAX_THREADS];
+
+static const uint32_t *tp_sources;
+static const uint32_t *tp_max_depths;
+static QueryStats *tp_stats;
+static query_callback_t tp_callback;
+static void *tp_callback_ctx;
+static atomic_int tp_active_threads;
+
+VisitSlab *visit_slab_create(uint32_t num_vertices) {
+  VisitSlab *slab = (VisitSlab *)malloc(sizeof(VisitSlab));
+  slab->distances = (uint32_t *)malloc(num_vertices * sizeof(uint32_t));
+  memset(slab->distances, UINT32_MAX, num_vertices * sizeof(uint32_t));
+  slab->queue = (mer_t *)malloc(num_vertices * sizeof(mer_t));
+  return slab;
+}
+
+void visit_slab_destroy(VisitSlab *slab) {
+  free(slab->distances);
+  free(slab->queue);
+  free(slab);
+}
+
+uint32_t slab_bfs(const MergedCSR *merged_csr, VisitSlab *slab,
+                  uint32_t source, uint32_t max_depth, uint32_t *levels) {
+  uint32_t head = 0, tail = 0;
+  slab->distances[source] = 0;
+  slab->queue[tail++] = merged_csr->row_ptr[source];
+  uint32_t distance = 0;
+  while (head < tail) {
+    mer_t v = slab->queue[head++];
+    distance = slab->distances[ID(merged_csr, v)];
+    // The queue is ordered by distance, nothing left to expand
+    if (distance >= max_depth) {
+      break;
+    }
+    mer_t end = v + DEGREE(merged_csr, v) + METADATA_SIZE;
+    for (mer_t i = v + METADATA_SIZE; i < end; i++) {
+      mer_t neighbor = merged_csr->merged[i];
+      uint32_t *d = &slab->distances[ID(merged_csr, neighbor)];
+      if (*d == UINT32_MAX) {
+        *d = distance + 1;
+        slab->queue[tail++] = neighbor;
+      }
+    }
+  }
+  *levels = distance;
+  return tail;
+}
+
+void visit_slab_reset(const MergedCSR *merged_csr, VisitSlab *slab,
+                      uint32_t visited) {
+  for (uint32_t i = 0; i < visited; i++) {
+    slab->distances[ID(merged_csr, slab->queue[i])] = UINT32_MAX;
+  }
+}
+
+static void *throughput_thread_main(void *arg) {
+  int thread_id = *(int *)arg;
+  VisitSlab *slab = slabs[thread_id];
+  struct timespec start, end;
+  int query;
+  while ((query = thread_pool_next_task(&tp)) != -1) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t levels;
+    uint32_t max_depth =
+        tp_max_depths != NULL ? tp_max_depths[query] : UINT32_MAX;
+    uint32_t visited =
+        slab_bfs(tp_csr, slab, tp_sources[query], max_depth, &levels);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    tp_stats[query].latency =
+        (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    tp_stats[query].levels = levels;
+    tp_stats[query].visited = visited;
+    if (tp_callback != NULL) {
+      tp_callback(query, slab->distances, tp_callback_ctx);
+    }
+    visit_slab_reset(tp_csr, slab, visited);
+  }
+  if (atomic_fetch_sub(&tp_active_threads, 1) == 1) {
+    thread_pool_notify_parent(&tp);
+  }
+  return NULL;
+}
+
+void initialize_throughput(const MergedCSR *merged_csr) {
+  tp_csr = merged_csr;
+  for (int i = 0; i < MAX_THREADS; i++) {
+    slabs[i] = visit_slab_create(merged_csr->num_vertices);
+  }
+  init_thread_pool(&tp, throughput_thread_main);
+  thread_pool_create(&tp);
+}
+
+void throughput_run(const uint32_t *sources, const uint32_t *max_depths,
+                    int num_queries, QueryStats *stats,
+                    query_callback_t callback, void *ctx) {
+  tp_sources = sources;
+  tp_max_depths = max_depths;
+  tp_stats = stats;
+  tp_callback = callback;
+  tp_callback_ctx = ctx;
+  tp_active_threads = MAX_THREADS;
+  thread_pool_start_tasks_wait(&tp, num_queries);
+}
+
+void destroy_throughput() {
+  thread_pool_terminate(&tp);
+  destroy_thread_pool(&tp);
+  for (int i = 0; i < MAX_THREADS; i++) {
+    visit_slab_destroy(slabs[i]);
+  }
+}
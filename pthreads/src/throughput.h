@@ -0,0 +1,84 @@
+#ifndef THROUGHPUT_H
+#define THROUGHPUT_H
+
+/**
+ * @brief Throughput mode: one independent BFS per worker.
+ *
+ * For graphs that fit in the last-level cache, the level barriers of the
+ * parallel BFS cost more than the parallelism saves. In throughput mode the
+ * thread pool hands out whole queries from a shared queue, and each worker
+ * runs them with a sequential BFS over the (read-only) merged CSR. The visit
+ * state lives in a per-worker slab indexed by vertex ID, so concurrent queries
+ * never touch the metadata slots of the merged CSR. Slabs are reset through
+ * the BFS queue, so the cost of a query is proportional to the visited part
+ * of the graph.
+ */
+
+#include "config.h"
+#include "merged_csr.h"
+#include <stdint.h>
+
+typedef struct {
+  uint32_t *distances; // Distance of each vertex ID, UINT32_MAX if not reached
+  mer_t *queue;        // BFS queue (merged CSR offsets)
+} VisitSlab;
+
+typedef struct {
+  double latency;   // Time to answer the query (seconds)
+  uint32_t levels;  // Distance of the farthest reached vertex
+  uint32_t visited; // Number of reached vertices
+} QueryStats;
+
+/**
+ * Called by the worker that answered query `query`, while `distances` (indexed
+ * by vertex ID) still holds its result.
+ */
+typedef void (*query_callback_t)(int query, const uint32_t *distances,
+                                 void *ctx);
+
+/**
+ * Allocates a visit slab for a graph with `num_vertices` vertices.
+ */
+VisitSlab *visit_slab_create(uint32_t num_vertices);
+
+void visit_slab_destroy(VisitSlab *slab);
+
+/**
+ * Runs a sequential BFS from `source` using the visit state in `slab`,
+ * stopping after `max_depth` levels (UINT32_MAX for a full BFS).
+ * Returns the number of reached vertices, which are stored in `slab->queue`.
+ * The distances of the reached vertices stay in the slab until
+ * visit_slab_reset is called.
+ */
+uint32_t slab_bfs(const MergedCSR *merged_csr, VisitSlab *slab,
+                  uint32_t source, uint32_t max_depth, uint32_t *levels);
+
+/**
+ * Clears the distances of the `visited` vertices reached by the last query.
+ */
+void visit_slab_reset(const MergedCSR *merged_csr, VisitSlab *slab,
+                      uint32_t visited);
+
+/**
+ * Allocates one slab per worker and starts the thread pool with the
+ * throughput worker routine.
+ */
+void initialize_throughput(const MergedCSR *merged_csr);
+
+/**
+ * Answers one BFS query per source, distributing the queries among the
+ * workers. If `max_depths` is not NULL, query i only explores the vertices
+ * within `max_depths[i]` hops of its source (k-hop neighborhood). Fills
+ * `stats[i]` for each query and, if `callback` is not NULL, calls it after
+ * each query.
+ */
+void throughput_run(const uint32_t *sources, const uint32_t *max_depths,
+                    int num_queries, QueryStats *stats,
+                    query_callback_t callback, void *ctx);
+
+/**
+ * Stops the thread pool and frees the slabs.
+ */
+void destroy_throughput();
+
+#endif // THROUGHPUT_H
@@ -0,0 +1,99 @@
+#define _GNU_SOURCE
+#include "trace.h"
+
+#ifdef TRACE
+#include "config.h"
+#include "utils.h"
+#include <stdlib.h>
+
+typedef struct {
+  TraceEvent *events; // Ring of TRACE_BUFFER_EVENTS events, NULL if disabled
+  uint64_t count;     // Events recorded since trace_init
+} __attribute__((aligned(64))) TraceBuffer;
+
+// One buffer per worker, plus the main thread
+static TraceBuffer buffers[MAX_THREADS + 1];
+static uint64_t epoch;
+
+static const char *names[TRACE_NUM_TYPES] = {
+    "chunk", "stolen_chunk", "early_chunk", "barrier",
+    "swap",  "finalize",     "run"};
+// Name of the argument of each type, NULL if it has none
+static const char *arg_names[TRACE_NUM_TYPES] = {
+    "vertices", "victim", "victim", NULL, "chunks", NULL, "run_id"};
+
+void trace_init() {
+  for (int i = 0; i <= MAX_THREADS; i++) {
+    buffers[i].events =
+        (TraceEvent *)malloc(TRACE_BUFFER_EVENTS * sizeof(TraceEvent));
+    buffers[i].count = 0;
+  }
+  epoch = monotonic_ns();
+}
+
+void trace_event(int thread_id, TraceType type, uint32_t level, uint32_t arg,
+                 uint64_t start_ns) {
+  TraceBuffer *b = &buffers[thread_id];
+  if (b->events == NULL) {
+    return;
+  }
+  TraceEvent *e = &b->events[b->count++ % TRACE_BUFFER_EVENTS];
+  e->start_ns = start_ns;
+  e->end_ns = monotonic_ns();
+  e->level = level;
+  e->arg = arg;
+  e->type = type;
+}
+
+void trace_write(FILE *f) {
+  fprintf(f, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+  for (int t = 0; t <= MAX_THREADS; t++) {
+    TraceBuffer *b = &buffers[t];
+    char name[32];
+    if (t == MAX_THREADS) {
+      snprintf(name, sizeof(name), "main");
+    } else {
+      snprintf(name, sizeof(name), "worker %d", t);
+    }
+    fprintf(f,
+            "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, "
+            "\"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+            t == 0 ? "" : ",", t, name);
+    if (b->events == NULL) {
+      continue;
+    }
+    uint64_t first = 0;
+    if (b->count > TRACE_BUFFER_EVENTS) {
+      first = b->count - TRACE_BUFFER_EVENTS;
+      printf("Trace buffer of thread %d overflowed, only its last %d events "
+             "are written\n",
+             t, TRACE_BUFFER_EVENTS);
+    }
+    for (uint64_t i = first; i < b->count; i++) {
+      TraceEvent *e = &b->events[i % TRACE_BUFFER_EVENTS];
+      // Timestamps and durations are in microseconds
+      fprintf(f,
+              ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, "
+              "\"ts\": %.3f, \"dur\": %.3f, \"args\": {",
+              names[e->type], t, (e->start_ns - epoch) / 1e3,
+              (e->end_ns - e->start_ns) / 1e3);
+      if (e->type != TRACE_RUN && e->type != TRACE_FINALIZE) {
+        fprintf(f, "\"level\": %u%s", e->level,
+                arg_names[e->type] != NULL ? ", " : "");
+      }
+      if (arg_names[e->type] != NULL) {
+        fprintf(f, "\"%s\": %u", arg_names[e->type], e->arg);
+      }
+      fprintf(f, "}}");
+    }
+  }
+  fprintf(f, "\n]}\n");
+}
+
+void trace_destroy() {
+  for (int i = 0; i <= MAX_THREADS; i++) {
+    free(buffers[i].events);
+    buffers[i].events = NULL;
+  }
+}
+#endif
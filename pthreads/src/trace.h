@@ -0,0 +1,66 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/**
+ * @brief Timeline of the per-thread activity of the level-synchronous BFS.
+ *
+ * Needs `make TRACE=1`. Each thread (the workers and, with id MAX_THREADS,
+ * the main thread) records timestamped events into its own ring buffer of
+ * TRACE_BUFFER_EVENTS entries, so recording needs no synchronization; when a
+ * buffer is full the oldest events are overwritten. The timeline is written
+ * as Chrome trace JSON, which can be opened in Perfetto (ui.perfetto.dev) or
+ * chrome://tracing.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef TRACE
+#define TRACE_ONLY(...) __VA_ARGS__
+
+typedef enum {
+  TRACE_CHUNK,        // Expansion of a chunk of the thread's own pool
+  TRACE_STOLEN_CHUNK, // Expansion of a chunk stolen from another thread
+  TRACE_EARLY_CHUNK,  // Expansion of a chunk of the next level while waiting
+  TRACE_BARRIER,      // Wait for the other threads at the end of a level
+  TRACE_SWAP,         // Frontier swap by the last thread to finish a level
+  TRACE_FINALIZE,     // Write-back of the distances (or parents)
+  TRACE_RUN,          // A whole BFS, on the main thread
+  TRACE_NUM_TYPES
+} TraceType;
+
+typedef struct {
+  uint64_t start_ns;
+  uint64_t end_ns;
+  uint32_t level; // 0 for the source's neighbors
+  uint32_t arg;   // Vertices, victim thread, chunks or run, by type
+  uint32_t type;
+} TraceEvent;
+
+/**
+ * Allocates the ring buffers and starts the timeline. Events recorded before
+ * (or without) trace_init are dropped.
+ */
+void trace_init();
+
+/**
+ * Records an event of `thread_id` from `start_ns` to now. Must be called by
+ * thread `thread_id` only.
+ */
+void trace_event(int thread_id, TraceType type, uint32_t level, uint32_t arg,
+                 uint64_t start_ns);
+
+/**
+ * Writes the recorded events of all threads to `f` as a Chrome trace.
+ */
+void trace_write(FILE *f);
+
+/**
+ * Frees the ring buffers; later events are dropped until the next trace_init.
+ */
+void trace_destroy();
+#else
+#define TRACE_ONLY(...)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,20 @@
+#ifndef UTILS_H
+#define UTILS_H
+
+/**
+ * @brief Small helpers shared by the modules of the engine.
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * Monotonic clock in nanoseconds.
+ */
+static inline uint64_t monotonic_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+#endif // UTILS_H
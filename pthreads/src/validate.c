@@ -0,0 +1,243 @@
+#include "validate.h"
+#include "parallel.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+  const mmio_csr_u32_f32_t *graph;
+  const uint32_t *parents; // NULL when validating distances
+  const uint32_t *depth;   // The distances, or the depths of the BFS tree
+  uint32_t source;
+  // Pointer jumping: after round k, ancestor[v] is the 2^k-th ancestor of v
+  // (or the source) and hops[v] its distance from v
+  uint32_t *ancestor, *hops, *next_ancestor, *next_hops;
+  atomic_bool changed;
+  atomic_uint errors;
+  pthread_mutex_t print_lock;
+} Validation;
+
+static void report(Validation *val, const char *format, ...) {
+  if (atomic_fetch_add(&val->errors, 1) >= MAX_REPORTED_ERRORS) {
+    return;
+  }
+  pthread_mutex_lock(&val->print_lock);
+  va_list args;
+  va_start(args, format);
+  printf("Error: ");
+  vprintf(format, args);
+  va_end(args);
+  pthread_mutex_unlock(&val->print_lock);
+}
+
+static bool too_many_errors(Validation *val) {
+  return atomic_load_explicit(&val->errors, memory_order_relaxed) >=
+         MAX_REPORTED_ERRORS;
+}
+
+// Checks 1, 3, 4 and 5 for the vertices in [begin, end)
+static void check_edges(uint64_t begin, uint64_t end, void *arg) {
+  Validation *val = (Validation *)arg;
+  const mmio_csr_u32_f32_t *graph = val->graph;
+  const uint32_t *depth = val->depth;
+  for (uint32_t u = begin; u < end && !too_many_errors(val); u++) {
+    uint32_t depth_u = depth[u];
+    if (u == val->source && depth_u != 0) {
+      report(val, "Distance to source vertex %u must be 0 (got %u)\n", u,
+             depth_u);
+    } else if (u != val->source && depth_u == 0) {
+      report(val, "Vertex %u has distance 0 but is not the source vertex %u\n",
+             u, val->source);
+    }
+    bool found_predecessor = false;
+    for (uint32_t i = graph->row_ptr[u]; i < graph->row_ptr[u + 1]; i++) {
+      uint32_t v = graph->col_idx[i];
+      if (v >= graph->nrows) {
+        report(val, "Neighbor index %u for vertex %u is out of bounds\n", v,
+               u);
+        return;
+      }
+      uint32_t depth_v = depth[v];
+      if (depth_u == UINT32_MAX) {
+        if (depth_v != UINT32_MAX) {
+          report(val,
+                 "Vertex %u is unreached, but has a reached neighbor %u "
+                 "(depth %u)\n",
+                 u, v, depth_v);
+        }
+        continue;
+      }
+      // Also catches a reached vertex with an unreached neighbor
+      if (depth_v > depth_u + 1) {
+        report(val,
+               "Edge {%u, %u} connects vertices at depths %u and %u, more "
+               "than one level apart\n",
+               u, v, depth_u, depth_v);
+      }
+      if (val->parents != NULL ? v == val->parents[u]
+                               : depth_u > 0 && depth_v == depth_u - 1) {
+        found_predecessor = true;
+      }
+    }
+    if (depth_u != UINT32_MAX && u != val->source && !found_predecessor) {
+      if (val->parents != NULL) {
+        report(val, "Couldn't find edge from parent %u to vertex %u\n",
+               val->parents[u], u);
+      } else {
+        report(val,
+               "Reachable vertex %u (dist=%u) has no predecessor neighbor "
+               "with distance %u\n",
+               u, depth_u, depth_u - 1);
+      }
+    }
+  }
+}
+
+static void init_ancestors(uint64_t begin, uint64_t end, void *arg) {
+  Validation *val = (Validation *)arg;
+  uint32_t n = val->graph->nrows;
+  for (uint32_t v = begin; v < end; v++) {
+    uint32_t parent = val->parents[v];
+    val->ancestor[v] = UINT32_MAX;
+    val->hops[v] = UINT32_MAX;
+    if (v == val->source) {
+      if (parent != v) {
+        report(val, "Parent of source vertex %u must be itself (got %u)\n", v,
+               parent);
+      }
+      val->ancestor[v] = v;
+      val->hops[v] = 0;
+    } else if (parent == UINT32_MAX) {
+      continue;
+    } else if (parent >= n) {
+      report(val, "Parent %u of vertex %u is out of bounds\n", parent, v);
+    } else if (val->parents[parent] == UINT32_MAX) {
+      report(val, "Parent %u of vertex %u is not in the BFS tree\n", parent,
+             v);
+    } else {
+      val->ancestor[v] = parent;
+      val->hops[v] = 1;
+    }
+  }
+}
+
+static void jump_ancestors(uint64_t begin, uint64_t end, void *arg) {
+  Validation *val = (Validation *)arg;
+  bool changed = false;
+  for (uint32_t v = begin; v < end; v++) {
+    uint32_t a = val->ancestor[v];
+    if (a == UINT32_MAX || a == val->source) {
+      val->next_ancestor[v] = a;
+      val->next_hops[v] = val->hops[v];
+    } else {
+      val->next_ancestor[v] = val->ancestor[a];
+      val->next_hops[v] = val->hops[v] + val->hops[a];
+      changed = true;
+    }
+  }
+  if (changed) {
+    atomic_store_explicit(&val->changed, true, memory_order_relaxed);
+  }
+}
+
+// Check 2: after the jumps, every reached vertex has the source as ancestor
+static void check_roots(uint64_t begin, uint64_t end, void *arg) {
+  Validation *val = (Validation *)arg;
+  for (uint32_t v = begin; v < end && !too_many_errors(val); v++) {
+    if (val->ancestor[v] != UINT32_MAX && val->ancestor[v] != val->source) {
+      report(val,
+             "Vertex %u does not reach the source %u by following its "
+             "parents (cycle in the BFS tree)\n",
+             v, val->source);
+    }
+  }
+}
+
+static void init_validation(Validation *val, const mmio_csr_u32_f32_t *graph,
+                            uint32_t source) {
+  val->graph = graph;
+  val->source = source;
+  val->parents = NULL;
+  val->depth = NULL;
+  atomic_init(&val->changed, false);
+  atomic_init(&val->errors, 0);
+  pthread_mutex_init(&val->print_lock, NULL);
+}
+
+static int finish_validation(Validation *val, const char *passed) {
+  pthread_mutex_destroy(&val->print_lock);
+  unsigned errors = atomic_load(&val->errors);
+  if (errors > MAX_REPORTED_ERRORS) {
+    printf("Error: %u more errors not shown\n", errors - MAX_REPORTED_ERRORS);
+  }
+  if (errors == 0) {
+    printf("%s for source vertex %u.\n", passed, val->source);
+  }
+  return errors == 0;
+}
+
+int validate_distances(const mmio_csr_u32_f32_t *graph,
+                       const uint32_t *distances, uint32_t source) {
+  if (source >= graph->nrows) {
+    printf("Error: Source vertex %u is out of bounds (num_vertices=%u)\n",
+           source, graph->nrows);
+    return 0;
+  }
+  Validation val;
+  init_validation(&val, graph, source);
+  val.depth = distances;
+  parallel_for(graph->nrows, check_edges, &val);
+  return finish_validation(&val, "BFS result verification passed");
+}
+
+int validate_parents(const mmio_csr_u32_f32_t *graph, const uint32_t *parents,
+                     uint32_t source) {
+  if (source >= graph->nrows) {
+    printf("Error: Source vertex %u is out of bounds (num_vertices=%u)\n",
+           source, graph->nrows);
+    return 0;
+  }
+  uint32_t n = graph->nrows;
+  Validation val;
+  init_validation(&val, graph, source);
+  val.parents = parents;
+  val.ancestor = (uint32_t *)malloc(n * sizeof(uint32_t));
+  val.hops = (uint32_t *)malloc(n * sizeof(uint32_t));
+  val.next_ancestor = (uint32_t *)malloc(n * sizeof(uint32_t));
+  val.next_hops = (uint32_t *)malloc(n * sizeof(uint32_t));
+  parallel_for(n, init_ancestors, &val);
+
+  if (atomic_load(&val.errors) == 0) {
+    // A path of length L reaches the source in ceil(log2(L)) rounds, vertices
+    // on a cycle never do
+    int max_rounds = 1;
+    while ((1ULL << max_rounds) < n) {
+      max_rounds++;
+    }
+    atomic_store(&val.changed, true);
+    for (int round = 0; round <= max_rounds && atomic_load(&val.changed);
+         round++) {
+      atomic_store(&val.changed, false);
+      parallel_for(n, jump_ancestors, &val);
+      uint32_t *temp = val.ancestor;
+      val.ancestor = val.next_ancestor;
+      val.next_ancestor = temp;
+      temp = val.hops;
+      val.hops = val.next_hops;
+      val.next_hops = temp;
+    }
+    parallel_for(n, check_roots, &val);
+  }
+  if (atomic_load(&val.errors) == 0) {
+    val.depth = val.hops;
+    parallel_for(n, check_edges, &val);
+  }
+  free(val.ancestor);
+  free(val.hops);
+  free(val.next_ancestor);
+  free(val.next_hops);
+  return finish_validation(&val, "BFS tree verification passed");
+}
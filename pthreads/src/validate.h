@@ -0,0 +1,44 @@
+#ifndef VALIDATE_H
+#define VALIDATE_H
+
+/**
+ * @brief Parallel, Graph500-style validation of BFS results.
+ *
+ * Unlike check_bfs_correctness and check_parents in debug_utils.h, which are
+ * serial (and the latter runs a BFS of its own), every check here is local to
+ * a vertex and its edges, so the validation is a few parallel sweeps over the
+ * graph (see parallel.h). The checks are those of the Graph500 validation:
+ *  1. the source is at depth 0 (and is its own parent) and is the only vertex
+ *     at depth 0;
+ *  2. the BFS tree is a tree rooted at the source: parent pointers are
+ *     followed by pointer jumping, which also yields the depth of each vertex,
+ *     and every reached vertex must end up at the source (no cycles);
+ *  3. every edge connects vertices whose depths differ by at most one;
+ *  4. the result spans a whole connected component: no edge connects a
+ *     reached vertex to an unreached one;
+ *  5. every vertex is joined to its parent by an edge of the graph (for
+ *     distances: every reached vertex but the source has a neighbor one level
+ *     closer to the source).
+ * At most MAX_REPORTED_ERRORS errors are printed.
+ */
+
+#include "mmio_c_wrapper.h"
+#include <stdint.h>
+
+#define MAX_REPORTED_ERRORS 10
+
+/**
+ * Validates the distances of a BFS from `source` (UINT32_MAX for unreached
+ * vertices). Returns 1 if they are correct, 0 otherwise.
+ */
+int validate_distances(const mmio_csr_u32_f32_t *graph,
+                       const uint32_t *distances, uint32_t source);
+
+/**
+ * Validates the BFS tree of a BFS from `source` (the parent of each vertex,
+ * UINT32_MAX for unreached vertices). Returns 1 if it is correct, 0 otherwise.
+ */
+int validate_parents(const mmio_csr_u32_f32_t *graph, const uint32_t *parents,
+                     uint32_t source);
+
+#endif // VALIDATE_H
@@ -0,0 +1,92 @@
+// Test of the k-hop queries of the library (bfs_engine_khop) with all the
+// MAX_THREADS workers: vertices reached by several threads in the same level
+// must be reported once, so for every source and depth the returned count
+// must equal the number of distinct returned vertices, and the vertices and
+// their depths must be those within `depth` hops according to a full BFS
+// (bfs_engine_distances). A Kronecker graph has hubs that most threads reach
+// at the same time, which makes duplicates likely if the claim races.
+// Usage: bin/khop_test [graph spec, default kron:scale=16] [sources]
+#include "bfs_api.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const uint32_t DEPTHS[] = {1, 2, 3, UINT32_MAX};
+#define NUM_DEPTHS (sizeof(DEPTHS) / sizeof(DEPTHS[0]))
+
+// Checks one query against the full distances; prints the first error
+static bool check_query(uint32_t n, uint32_t source, uint32_t depth,
+                        int64_t count, const uint32_t *ids,
+                        const uint32_t *depths, const uint32_t *distances,
+                        uint8_t *seen) {
+  int64_t expected = 0;
+  for (uint32_t v = 0; v < n; v++) {
+    expected += distances[v] != UINT32_MAX && distances[v] <= depth;
+    seen[v] = 0;
+  }
+  if (count != expected) {
+    printf("Error: source %u, depth %u: %ld vertices returned, expected %ld\n",
+           source, depth, (long)count, (long)expected);
+    return false;
+  }
+  for (int64_t i = 0; i < count; i++) {
+    uint32_t v = ids[i];
+    if (v >= n || seen[v]) {
+      printf("Error: source %u, depth %u: vertex %u returned %s\n", source,
+             depth, v, v >= n ? "out of range" : "twice");
+      return false;
+    }
+    seen[v] = 1;
+    if (depths[i] != distances[v]) {
+      printf("Error: source %u, depth %u: vertex %u at depth %u, expected "
+             "%u\n",
+             source, depth, v, depths[i], distances[v]);
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  const char *spec = argc > 1 ? argv[1] : "kron:scale=16";
+  uint32_t num_sources = argc > 2 ? (uint32_t)atoi(argv[2]) : 16;
+
+  BfsGraph *graph = bfs_graph_generate(spec);
+  if (graph == NULL) {
+    return 1;
+  }
+  BfsEngine *engine = bfs_engine_prepare(graph, NULL);
+  if (engine == NULL) {
+    bfs_graph_free(graph);
+    return 1;
+  }
+  uint32_t n = bfs_engine_num_vertices(engine);
+  uint32_t *ids = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *depths = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint32_t *distances = (uint32_t *)malloc(n * sizeof(uint32_t));
+  uint8_t *seen = (uint8_t *)malloc(n);
+
+  srand(27491095);
+  int failed = 0, queries = 0;
+  for (uint32_t i = 0; i < num_sources; i++) {
+    uint32_t source = (uint32_t)rand() % n;
+    bfs_engine_distances(engine, source, distances);
+    for (size_t d = 0; d < NUM_DEPTHS; d++) {
+      int64_t count = bfs_engine_khop(engine, source, DEPTHS[d], ids, depths);
+      failed += !check_query(n, source, DEPTHS[d], count, ids, depths,
+                             distances, seen);
+      queries++;
+    }
+  }
+  printf("khop_test: %d of %d queries passed on %s\n", queries - failed,
+         queries, spec);
+
+  free(seen);
+  free(distances);
+  free(depths);
+  free(ids);
+  bfs_engine_destroy(engine);
+  bfs_graph_free(graph);
+  return failed > 0;
+}